@@ -17,6 +17,7 @@
 #include "document-undo.h"
 #include "inkscape-application.h"
 #include "inkscape-window.h"
+#include "preferences.h"
 #include "selection.h"            // Selection
 #include "selection-chemistry.h"  // SelectionHelper
 #include "path/path-offset.h"
@@ -220,6 +221,20 @@ shape_builder_mode(int value, InkscapeWindow* win)
     pref->setInt("/tools/booleans/mode", value);
 }
 
+void
+path_boolop_backend(Glib::ustring const &backend, InkscapeApplication *app)
+{
+    if (backend != "livarot" && backend != "2geom") {
+        std::cerr << "path_boolop_backend: invalid option: " << backend << std::endl;
+        return;
+    }
+
+    auto action = app->gio_app()->lookup_action("path-boolop-backend");
+    auto saction = Glib::RefPtr<Gio::SimpleAction>::cast_dynamic(action);
+    saction->change_state(backend);
+    Inkscape::Preferences::get()->setString("/options/booleans/backend", backend);
+}
+
 static const std::vector<std::vector<Glib::ustring>> raw_data_path =
 {
     // clang-format offs
@@ -236,6 +251,7 @@ static const std::vector<std::vector<Glib::ustring>> raw_data_path =
     {"app.path-flatten",             N_("Flatten"),              "Path",   N_("Flatten one or more overlapping objects into their visible parts")},
     {"app.path-fill-between-paths",  N_("Fill between paths"),   "Path",   N_("Create a fill object using the selected paths")},
     {"app.path-simplify",            N_("Simplify"),             "Path",   N_("Simplify selected paths (remove extra nodes)")},
+    {"app.path-boolop-backend",      N_("Boolean Backend"),      "Path",   N_("Set the implementation of boolean operations: 'livarot' or '2geom' (keeps curves)")},
 
     {"win.path-inset",               N_("Inset"),                "Path",   N_("Inset selected paths")},
     {"win.path-offset",              N_("Offset"),               "Path",   N_("Offset selected paths")},
@@ -254,6 +270,9 @@ void add_actions_path(InkscapeApplication *app)
 {
     auto *gapp = app->gio_app();
 
+    auto prefs = Inkscape::Preferences::get();
+    Glib::ustring backend = prefs->getString("/options/booleans/backend", "livarot");
+
     // clang-format off
     gapp->add_action(               "path-union",              sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&object_path_union),         app));
     gapp->add_action(               "path-difference",         sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&select_path_difference),    app));
@@ -268,6 +287,7 @@ void add_actions_path(InkscapeApplication *app)
     gapp->add_action(               "path-flatten",            sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&select_path_flatten) ,      app));
     gapp->add_action(               "path-fill-between-paths", sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&fill_between_paths),        app));
     gapp->add_action(               "path-simplify",           sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&select_path_simplify),      app));
+    gapp->add_action_radio_string(  "path-boolop-backend",     sigc::bind<InkscapeApplication*>(sigc::ptr_fun(&path_boolop_backend),       app), backend);
     // clang-format on
 
     app->get_action_extra_data().add_data(raw_data_path);
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <iostream>
+#include "scheduler.h"
+#include "util/statics.h"
+
+namespace Inkscape {
+namespace Async {
+namespace {
+
+// The scheduler and index of the worker running on this thread, if any.
+thread_local Scheduler const *tl_scheduler = nullptr;
+thread_local int tl_index = -1;
+
+// Priority of the work being done by this thread.
+thread_local Priority tl_priority = Priority::Interactive;
+
+int default_numthreads()
+{
+    int n = std::thread::hardware_concurrency();
+    return std::max(1, n - 1);
+}
+
+} // namespace
+
+Scheduler::Scheduler(int numthreads)
+{
+    if (numthreads <= 0) {
+        numthreads = default_numthreads();
+    }
+
+    for (int i = 0; i < numthreads; i++) {
+        _local.emplace_back(std::make_unique<Queue>());
+    }
+
+    _threads.reserve(numthreads);
+    for (int i = 0; i < numthreads; i++) {
+        _threads.emplace_back([this, i] { worker(i); });
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    {
+        auto lock = std::lock_guard(_sleep_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+
+    for (auto &t : _threads) {
+        t.join();
+    }
+}
+
+Scheduler &Scheduler::get()
+{
+    /*
+     * Using Static<Scheduler> to ensure the worker threads are joined before main() exits,
+     * since the tasks they run may access other statics.
+     */
+    static Util::Static<Scheduler> instance;
+    return instance.get();
+}
+
+void Scheduler::post(std::function<void()> func, Priority priority)
+{
+    auto &queue = tl_scheduler == this ? *_local[tl_index] : _injector;
+
+    {
+        auto lock = std::lock_guard(queue.mutex);
+        queue.tasks[(int)priority].push_back({ std::move(func), priority });
+    }
+
+    {
+        // Increment under the lock, so a worker about to sleep cannot miss it.
+        auto lock = std::lock_guard(_sleep_mutex);
+        _pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    _wake.notify_one();
+}
+
+Priority Scheduler::current_priority()
+{
+    return tl_priority;
+}
+
+Scheduler::PriorityScope::PriorityScope(Priority priority)
+    : _saved(tl_priority)
+{
+    tl_priority = priority;
+}
+
+Scheduler::PriorityScope::~PriorityScope()
+{
+    tl_priority = _saved;
+}
+
+bool Scheduler::pop(Queue &queue, int priority, bool back, Task &task)
+{
+    auto lock = std::lock_guard(queue.mutex);
+    auto &tasks = queue.tasks[priority];
+    if (tasks.empty()) {
+        return false;
+    }
+    if (back) {
+        task = std::move(tasks.back());
+        tasks.pop_back();
+    } else {
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    return true;
+}
+
+// Find the next task to run, in order of priority. Within a priority, prefer the newest task from the
+// worker's own queue (best cache locality), then the oldest external task, then steal the oldest task
+// of another worker.
+bool Scheduler::find_task(int index, Task &task)
+{
+    int const n = _local.size();
+
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        if (pop(*_local[index], p, true, task)) {
+            return true;
+        }
+        if (pop(_injector, p, false, task)) {
+            return true;
+        }
+        for (int k = 1; k < n; k++) {
+            if (pop(*_local[(index + k) % n], p, false, task)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void Scheduler::worker(int index)
+{
+    tl_scheduler = this;
+    tl_index = index;
+
+    while (true) {
+        Task task;
+        if (find_task(index, task)) {
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            tl_priority = task.priority;
+            try {
+                task.func();
+            } catch (...) {
+                std::cerr << "Scheduler: uncaught exception in task" << std::endl;
+            }
+            continue;
+        }
+
+        auto lock = std::unique_lock(_sleep_mutex);
+        _wake.wait(lock, [this] { return _stop || _pending.load(std::memory_order_relaxed) > 0; });
+        if (_stop && _pending.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+void Scheduler::Loop::work(int slot)
+{
+    while (true) {
+        int const first = next.fetch_add(grain, std::memory_order_relaxed);
+        if (first >= end) {
+            return;
+        }
+        int const last = std::min(first + grain, end);
+
+        std::exception_ptr chunk_error;
+        if (!failed.load(std::memory_order_relaxed)) {
+            try {
+                run_chunk(first, last, slot);
+            } catch (...) {
+                chunk_error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        // Count the chunk even if it failed, so that the caller stops waiting.
+        auto lock = std::lock_guard(mutex);
+        if (chunk_error && !error) {
+            error = std::move(chunk_error);
+        }
+        remaining -= last - first;
+        if (remaining == 0) {
+            cond.notify_all();
+        }
+    }
+}
+
+void Scheduler::Loop::wait()
+{
+    auto lock = std::unique_lock(mutex);
+    cond.wait(lock, [this] { return remaining == 0; });
+}
+
+} // namespace Async
+} // namespace Inkscape
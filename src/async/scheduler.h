@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** \file Scheduler
+ * Work-stealing thread pool shared by all rendering work.
+ *
+ * The canvas, exports and filters all submit their work to the same pool, so that running them
+ * at the same time does not oversubscribe the cores, and so that idle capacity of one is picked
+ * up by another. Each task carries a priority; workers always prefer runnable tasks of a higher
+ * priority, whether these are in their own queue, the shared injection queue, or stolen from
+ * another worker.
+ */
+#ifndef INKSCAPE_ASYNC_SCHEDULER_H
+#define INKSCAPE_ASYNC_SCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Inkscape {
+namespace Async {
+
+/// Priority of a task. Lower values are run first.
+enum class Priority : int
+{
+    Interactive, ///< Canvas tiles the user is waiting to see.
+    Export,      ///< Exports and other batch work requested by the user.
+    Background,  ///< Previews and other speculative work.
+};
+
+class Scheduler
+{
+public:
+    /**
+     * Create a pool with the given number of worker threads.
+     * If zero, use one fewer than the number of processors, but at least one.
+     */
+    explicit Scheduler(int numthreads = 0);
+    Scheduler(Scheduler const &) = delete;
+    Scheduler &operator=(Scheduler const &) = delete;
+
+    /// Run all remaining tasks, then join the worker threads.
+    ~Scheduler();
+
+    /// The process-wide scheduler. Must first be called from the main thread.
+    static Scheduler &get();
+
+    /// The number of worker threads.
+    int num_threads() const { return _threads.size(); }
+
+    /**
+     * Queue a task for execution on a worker thread. Tasks must not throw.
+     * Tasks posted from a worker are queued locally, to be run by that worker unless stolen.
+     */
+    void post(std::function<void()> task, Priority priority);
+
+    /// The priority of the task running on the current thread, or of the current PriorityScope.
+    static Priority current_priority();
+
+    /**
+     * Override the priority of work submitted from the current thread, for the lifetime of this object.
+     * Used by callers that run on threads not owned by the scheduler, such as exports.
+     */
+    class PriorityScope
+    {
+    public:
+        explicit PriorityScope(Priority priority);
+        ~PriorityScope();
+        PriorityScope(PriorityScope const &) = delete;
+        PriorityScope &operator=(PriorityScope const &) = delete;
+
+    private:
+        Priority _saved;
+    };
+
+    /// The number of tasks, including the calling thread, that a parallel loop may be split into.
+    int concurrency(int max_tasks = 0) const
+    {
+        int n = num_threads() + 1;
+        return max_tasks > 0 ? std::min(n, max_tasks) : n;
+    }
+
+    /**
+     * Run body(i, slot) for every i in [begin, end), spread across at most concurrency(max_tasks) tasks,
+     * and wait for completion. The slot is in [0, concurrency(max_tasks)) and is unique among concurrently
+     * running tasks, so it can be used to index per-task scratch buffers.
+     *
+     * The calling thread takes part, and only ever waits for iterations that are already running, so this
+     * may safely be called from within a task. Helper tasks inherit the priority of the calling thread.
+     *
+     * If the body throws, the iterations not yet started are skipped, and the first exception is rethrown
+     * on the calling thread once the running ones have finished.
+     */
+    template <typename F>
+    void parallel_for_slots(int begin, int end, F &&body, int max_tasks = 0)
+    {
+        int const n = end - begin;
+        if (n <= 0) {
+            return;
+        }
+
+        int const tasks = std::min(n, concurrency(max_tasks));
+        if (tasks == 1) {
+            for (int i = begin; i < end; ++i) {
+                body(i, 0);
+            }
+            return;
+        }
+
+        // Aim for a few chunks per task, so that uneven rows still balance.
+        int const grain = std::max(1, n / (tasks * 4));
+
+        auto loop = std::make_shared<Loop>(begin, end, grain);
+        loop->run_chunk = [&body] (int first, int last, int slot) {
+            for (int i = first; i < last; ++i) {
+                body(i, slot);
+            }
+        };
+
+        auto const priority = current_priority();
+        for (int slot = 1; slot < tasks; ++slot) {
+            post([loop, slot] { loop->work(slot); }, priority);
+        }
+
+        loop->work(0);
+        loop->wait();
+        if (loop->error) {
+            std::rethrow_exception(loop->error);
+        }
+    }
+
+    /// As parallel_for_slots(), for bodies which do not need per-task storage.
+    template <typename F>
+    void parallel_for(int begin, int end, F &&body, int max_tasks = 0)
+    {
+        parallel_for_slots(begin, end, [&body] (int i, int) { body(i); }, max_tasks);
+    }
+
+private:
+    static constexpr int NUM_PRIORITIES = 3;
+
+    struct Task
+    {
+        std::function<void()> func;
+        Priority priority;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NUM_PRIORITIES> tasks;
+    };
+
+    // Shared state of a parallel loop. Outlives the call if helper tasks are still queued.
+    struct Loop
+    {
+        Loop(int begin, int end, int grain) : next(begin), end(end), grain(grain), remaining(end - begin) {}
+
+        std::atomic<int> next;
+        int const end;
+        int const grain;
+        std::function<void(int, int, int)> run_chunk; // Only called for claimed chunks, hence while the caller waits.
+        std::atomic<bool> failed = false;             // Remaining chunks are counted but not run.
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        int remaining;
+        std::exception_ptr error; // The first exception thrown by run_chunk.
+
+        void work(int slot);
+        void wait();
+    };
+
+    std::vector<std::unique_ptr<Queue>> _local; // One per worker.
+    Queue _injector; // For tasks posted from outside the pool.
+    std::vector<std::thread> _threads;
+
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    std::atomic<int> _pending = 0; // Number of queued tasks.
+    bool _stop = false;
+
+    void worker(int index);
+    bool find_task(int index, Task &task);
+    static bool pop(Queue &queue, int priority, bool back, Task &task);
+};
+
+} // namespace Async
+} // namespace Inkscape
+
+#endif // INKSCAPE_ASYNC_SCHEDULER_H
@@ -65,13 +65,11 @@ CMSSystem::CMSSystem() {
     sRGBProf = cmsCreate_sRGBProfile();
 }
 
-// Common operation... we track last transform created so we can delete it later.
+// Common operation... we track last transform created so we can drop it later.
+// (Render threads may still hold a reference, in which case it is deleted once they finish.)
 void
 CMSSystem::clear_transform() {
-    if (current_transform) {
-        cmsDeleteTransform(current_transform);
-        current_transform = nullptr;
-    }
+    current_transform.reset();
 }
 
 // Search for system ICC profile files and add them to list.
@@ -236,7 +234,7 @@ cmsHPROFILE CMSSystem::get_proof_profile()
             if ( theOne ) {
                 cmsCloseProfile( theOne );
             }
-            clear_transform();
+            free_transforms(); // All transforms depend on the proof profile.
             theOne = cmsOpenProfileFromFile( uri.data(), "r" );
             if ( theOne ) {
                 // a display profile must have the proper stuff
@@ -266,7 +264,7 @@ cmsHPROFILE CMSSystem::get_proof_profile()
         cmsCloseProfile( theOne );
         theOne = nullptr;
         lastURI.clear();
-        clear_transform();
+        free_transforms(); // All transforms depend on the proof profile.
     }
 
     return theOne;
@@ -352,7 +350,7 @@ void Inkscape::CMSSystem::do_transform(cmsHTRANSFORM transform, void *inBuf, voi
 }
 
 // Only reason this is part of class is to access transform variable.
-cmsHTRANSFORM Inkscape::CMSSystem::get_display_transform_system()
+std::shared_ptr<CMSTransform const> Inkscape::CMSSystem::get_display_transform_system()
 {
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     bool fromDisplay = prefs->getBool( "/options/displayprofile/from_display");
@@ -365,16 +363,17 @@ cmsHTRANSFORM Inkscape::CMSSystem::get_display_transform_system()
     cmsHPROFILE system_profile = get_system_profile();
 
     if (!current_transform) {
-        current_transform = set_transform(system_profile, current_transform);
+        set_transform(system_profile, current_transform);
     }
 
     return current_transform;
 }
 
-// This function takes a profile and transform, returning a new transform based on preference settings.
+// This function takes a profile and transform, replacing the transform with a new one based on preference settings if necessary.
 // "transform" is either "current_transform" if called by get_diplay_profile_system() or a
 // transform attached to a monitor if called by get_display_profile_monitor().
-cmsHTRANSFORM Inkscape::CMSSystem::set_transform(cmsHPROFILE profile, cmsHTRANSFORM transform)
+// It is taken by reference so that it sees being freed as a side effect of a settings change.
+void Inkscape::CMSSystem::set_transform(cmsHPROFILE profile, std::shared_ptr<CMSTransform const> &transform)
 {
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     bool warn = prefs->getBool( "/options/softproof/gamutwarn");
@@ -402,8 +401,11 @@ cmsHTRANSFORM Inkscape::CMSSystem::set_transform(cmsHPROFILE profile, cmsHTRANSF
 
     if (!transform) { // May be nullptr if freed above or never set.
 
+        cmsHTRANSFORM handle = nullptr;
+
         if (profile && proof_profile) {
-            cmsUInt32Number dwFlags = cmsFLAGS_SOFTPROOFING;
+            // No cache, so that the transform can be shared between render threads.
+            cmsUInt32Number dwFlags = cmsFLAGS_SOFTPROOFING | cmsFLAGS_NOCACHE;
 
             if (gamutWarn) {
                 dwFlags |= cmsFLAGS_GAMUTCHECK;
@@ -424,15 +426,17 @@ cmsHTRANSFORM Inkscape::CMSSystem::set_transform(cmsHPROFILE profile, cmsHTRANSF
                 dwFlags |= cmsFLAGS_BLACKPOINTCOMPENSATION;
             }
 
-            transform = cmsCreateProofingTransform( get_sRGB_profile(), TYPE_BGRA_8, profile, TYPE_BGRA_8,
-                                                    proof_profile, intent, proofIntent, dwFlags );
+            handle = cmsCreateProofingTransform( get_sRGB_profile(), TYPE_BGRA_8, profile, TYPE_BGRA_8,
+                                                 proof_profile, intent, proofIntent, dwFlags );
 
         } else if (profile) {
-            transform = cmsCreateTransform( get_sRGB_profile(), TYPE_BGRA_8, profile, TYPE_BGRA_8, intent, 0 );
+            handle = cmsCreateTransform( get_sRGB_profile(), TYPE_BGRA_8, profile, TYPE_BGRA_8, intent, cmsFLAGS_NOCACHE );
         }
-    }
 
-    return transform;
+        if (handle) {
+            transform = std::make_shared<CMSTransform const>(handle);
+        }
+    }
 }
 
 // Free system profile transform and all monitor profile transforms
@@ -440,11 +444,8 @@ void Inkscape::CMSSystem::free_transforms()
 {
     clear_transform();
 
-    for (auto profile : monitor_profile_infos) {
-        if (profile.transform) {
-            cmsDeleteTransform(profile.transform);
-            profile.transform = nullptr;
-        }
+    for (auto &profile : monitor_profile_infos) {
+        profile.transform.reset();
     }
 }
 
@@ -488,7 +489,7 @@ Glib::ustring Inkscape::CMSSystem::set_display_transform_monitor(gpointer buf, g
     return id;
 }
 
-cmsHTRANSFORM CMSSystem::get_display_transform_monitor(std::string const &id)
+std::shared_ptr<CMSTransform const> CMSSystem::get_display_transform_monitor(std::string const &id)
 {
     if (id.empty()) {
         return nullptr;
@@ -498,7 +499,7 @@ cmsHTRANSFORM CMSSystem::get_display_transform_monitor(std::string const &id)
         if ( id == info.id ) {
 
             // Update transform if necessary based on preferences.
-            info.transform = set_transform(info.profile, info.transform);
+            set_transform(info.profile, info.transform);
             return info.transform;
         }
     }
@@ -16,6 +16,7 @@
  * Track which profile to use on which monitor.
  */
 
+#include <memory>
 #include <vector>
 
 #include <glibmm/ustring.h>
@@ -33,6 +34,27 @@ namespace Inkscape {
 
 class ColorProfile;
 
+/**
+ * An immutable lcms transform which may be applied from any thread.
+ *
+ * The transform is created without lcms's internal one-pixel cache, so concurrent calls to
+ * do_transform() on the same object are safe. It is handed out by shared pointer, so a render
+ * thread can keep using it even after CMSSystem has replaced it due to a preferences change.
+ */
+class CMSTransform {
+public:
+    explicit CMSTransform(cmsHTRANSFORM handle) : _handle(handle) {}
+    ~CMSTransform() { cmsDeleteTransform(_handle); }
+    CMSTransform(CMSTransform const &) = delete;
+    CMSTransform &operator=(CMSTransform const &) = delete;
+
+    cmsHTRANSFORM handle() const { return _handle; }
+    void do_transform(void const *inBuf, void *outBuf, unsigned int size) const { cmsDoTransform(_handle, inBuf, outBuf, size); }
+
+private:
+    cmsHTRANSFORM _handle;
+};
+
 class MonitorProfileInfo {
 public:
     MonitorProfileInfo() {};
@@ -40,7 +62,7 @@ public:
 
     std::string id;
     cmsHPROFILE profile = nullptr;
-    cmsHTRANSFORM transform = nullptr;
+    std::shared_ptr<CMSTransform const> transform;
 };
 
 
@@ -70,8 +92,9 @@ public:
     std::vector<Glib::ustring> get_display_names();
     std::vector<Glib::ustring> get_softproof_names();
     std::string get_path_for_profile(Glib::ustring const& name);
-    cmsHTRANSFORM get_display_transform_system();
-    cmsHTRANSFORM get_display_transform_monitor(std::string const &id);
+    // Must be called from the main thread; the returned transform may then be used from any thread.
+    std::shared_ptr<CMSTransform const> get_display_transform_system();
+    std::shared_ptr<CMSTransform const> get_display_transform_monitor(std::string const &id);
     cmsHPROFILE get_system_profile();
     cmsHPROFILE get_proof_profile();
     static cmsHPROFILE get_document_profile(SPDocument* document, guint* intent, gchar const* name);
@@ -89,7 +112,7 @@ private:
     void load_profiles(); // Should this be public (e.g., if a new ColorProfile is created).
     void clear_transform(); // Clears current_transform.
     void free_transforms(); // Clears current_transform and clears monitor profile transformss.
-    cmsHTRANSFORM set_transform(cmsHPROFILE profile, cmsHTRANSFORM transform); 
+    void set_transform(cmsHPROFILE profile, std::shared_ptr<CMSTransform const> &transform);
 
 
     static CMSSystem* _instance;
@@ -106,7 +129,7 @@ private:
     bool lastBPC = false;
     int lastIntent = INTENT_PERCEPTUAL;
     int lastProofIntent = INTENT_PERCEPTUAL;
-    cmsHTRANSFORM current_transform = nullptr;  // So we can delete it later.
+    std::shared_ptr<CMSTransform const> current_transform;
 
     // Genric sRGB profile, find it once on inititialization.
     cmsHPROFILE sRGBProf = nullptr;
@@ -33,6 +33,7 @@
 #include "document.h"
 #include "helper/pixbuf-ops.h"
 #include "preferences.h"
+#include "display/surface-pool.h"
 #include "ui/util.h"
 #include "util/scope_exit.h"
 #include "util/units.h"
@@ -1148,9 +1149,9 @@ ink_cairo_surface_create_same_size(cairo_surface_t *s, cairo_content_t c)
     assert (y_scale > 0);
 
     cairo_surface_t *ns =
-        cairo_surface_create_similar(s, c,
-                                     ink_cairo_surface_get_width(s)/x_scale,
-                                     ink_cairo_surface_get_height(s)/y_scale);
+        Inkscape::SurfacePool::get().create_similar(s, c,
+                                                    ink_cairo_surface_get_width(s)/x_scale,
+                                                    ink_cairo_surface_get_height(s)/y_scale);
     return ns;
 }
 
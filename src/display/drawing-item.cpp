@@ -565,6 +565,7 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
     }
 
     // update _bbox and call this function for children
+    auto const old_drawbox = _drawbox;
     _state = _updateItem(area, child_ctx, flags, reset);
 
     // update drawingitems contained in filter
@@ -669,7 +670,10 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
             _stroke_pattern->update(area, child_ctx, flags, reset);
         }
         if (!totally_invalidated) {
-            if (!is<DrawingGroup>(this) || (_filter && filters) || totally_invalidate) {
+            // A filtered group whose members alone changed was already damaged by them, through
+            // the filter; marking its whole drawbox again would throw away the rest of its cache.
+            bool const filter_output_changed = (reset & STATE_RENDER) || affine_changed || _drawbox != old_drawbox;
+            if (!is<DrawingGroup>(this) || (_filter && filters && filter_output_changed) || totally_invalidate) {
                 _markForRendering();
             }
         }
@@ -1114,22 +1118,33 @@ void DrawingItem::_markForRendering()
     DrawingItem *bkg_root = nullptr;
 
     for (auto i = this; i; i = i->_parent) {
-        if (i != this && i->_filter) {
-            i->_filter->area_enlarge(*dirty, i);
+        if (dirty && i != this && i->_filter) {
+            if (outline) {
+                // Outlines are drawn unfiltered, so only a conservative enlargement is possible.
+                i->_filter->area_enlarge(*dirty, i);
+            } else {
+                // Only the part of the filter output reached by the damage needs re-rendering;
+                // cached renderings of the rest of the filtered item stay valid.
+                dirty = i->_filter->damage_area(*dirty, i) & i->_drawbox;
+            }
         }
-        if (i->_cache && i->_cache->surface) {
+        if (dirty && i->_cache && i->_cache->surface) {
             i->_cache->surface->markDirty(*dirty);
         }
+        // Patterns render their content regardless of what is visible, so drop them all the way up.
         i->_dropPatternCache();
-        if (i->_background_accumulate) {
+        if (dirty && i->_background_accumulate) {
             bkg_root = i;
         }
     }
 
+    if (!dirty) return;
+
     if (bkg_root && bkg_root->_parent && bkg_root->_parent->_parent) {
         bkg_root->_invalidateFilterBackground(*dirty);
     }
 
+    _drawing.signal_redraw_area.emit(*dirty);
     if (auto canvasitem = drawing().getCanvasItemDrawing()) {
         canvasitem->get_canvas()->redraw_area(*dirty);
     }
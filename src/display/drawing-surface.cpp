@@ -13,6 +13,7 @@
 #include "display/drawing-surface.h"
 #include "display/drawing-context.h"
 #include "display/cairo-utils.h"
+#include "display/surface-pool.h"
 #include "ui/util.h"
 
 namespace Inkscape {
@@ -114,9 +115,9 @@ cairo_t *DrawingSurface::createRawContext()
 {
     // deferred allocation
     if (!_surface) {
-        _surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                                              _pixels.x() * _device_scale,
-                                              _pixels.y() * _device_scale);
+        _surface = SurfacePool::get().create(CAIRO_FORMAT_ARGB32,
+                                             _pixels.x() * _device_scale,
+                                             _pixels.y() * _device_scale);
         cairo_surface_set_device_scale(_surface, _device_scale, _device_scale);
     }
     cairo_t *ct = cairo_create(_surface);
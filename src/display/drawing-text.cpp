@@ -20,6 +20,7 @@
 #include "drawing-surface.h"
 #include "drawing-text.h"
 #include "drawing.h"
+#include "glyph-mask-cache.h"
 
 #include "helper/geom.h"
 
@@ -606,6 +607,13 @@ unsigned DrawingText::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::I
             dc.newPath(); // Clear text-decoration path
         }
 
+        // Small glyphs filled with an opaque colour, and nothing else, are drawn from cached
+        // masks; the other ones are filled as paths below.
+        bool const use_masks = _drawing.useGlyphMasks() && has_fill && !has_stroke && !decorate &&
+                               _nrstyle.data.fill.type == NRStyleData::PaintType::COLOR &&
+                               _nrstyle.data.fill.opacity >= 1.0 &&
+                               cairo_get_operator(dc.raw()) == CAIRO_OPERATOR_OVER;
+
         // Accumulate the path that represents the glyphs and/or draw SVG glyphs.
         for (auto &i : _children) {
             auto g = cast<DrawingGlyphs>(&i);
@@ -636,6 +644,12 @@ unsigned DrawingText::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::I
                         dc.paint(1);
                     }
                 } else {
+                    if (use_masks) {
+                        _nrstyle.applyFill(dc, has_fill);
+                        if (draw_glyph_mask(dc, *g->pathvec, g->_font_data)) {
+                            continue;
+                        }
+                    }
                     dc.path(*g->pathvec);
                 }
             }
@@ -188,6 +188,18 @@ void Drawing::setDithering(bool use_dithering)
     });
 }
 
+void Drawing::setGlyphMasks(bool use_glyph_masks)
+{
+    defer([=] {
+        if (use_glyph_masks == _use_glyph_masks) return;
+        _use_glyph_masks = use_glyph_masks;
+        if (_rendermode != RenderMode::OUTLINE) {
+            _root->_markForRendering();
+            _clearCache();
+        }
+    });
+}
+
 void Drawing::setCacheBudget(size_t bytes)
 {
     defer([=] {
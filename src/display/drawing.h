@@ -57,6 +57,7 @@ public:
     void setFilterQuality(int);
     void setBlurQuality(int);
     void setDithering(bool);
+    void setGlyphMasks(bool);
     void setCursorTolerance(double tol) { _cursor_tolerance = tol; }
     void setSelectZeroOpacity(bool select_zero_opacity) { _select_zero_opacity = select_zero_opacity; }
     void setCacheBudget(size_t bytes);
@@ -75,6 +76,7 @@ public:
     int filterQuality() const { return _filter_quality; }
     int blurQuality() const { return _blur_quality; }
     bool useDithering() const { return _use_dithering; }
+    bool useGlyphMasks() const { return _use_glyph_masks; }
     double cursorTolerance() const { return _cursor_tolerance; }
     bool selectZeroOpacity() const { return _select_zero_opacity; }
     Geom::OptIntRect const &cacheLimit() const { return _cache_limit; }
@@ -88,6 +90,9 @@ public:
     void unsnapshot();
     bool snapshotted() const { return _snapshotted; }
 
+    /// Emitted with every area marked for redrawing, whether or not the drawing is on a canvas.
+    sigc::signal<void (Geom::IntRect const &)> signal_redraw_area;
+
     // Convenience
     void averageColor(Geom::IntRect const &area, double &R, double &G, double &B, double &A) const;
     void setExact();
@@ -112,6 +117,7 @@ private:
     int _filter_quality;
     int _blur_quality;
     bool _use_dithering;
+    bool _use_glyph_masks = true; ///< Draw small plain text from cached glyph masks.
     double _cursor_tolerance;
     size_t _cache_budget; ///< Maximum allowed size of cache.
     Geom::OptIntRect _cache_limit;
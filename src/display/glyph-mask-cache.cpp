@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cached coverage masks of the glyphs of small text.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "glyph-mask-cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cairo-utils.h"
+#include "drawing-context.h"
+
+#include "helper/geom.h"
+
+namespace Inkscape {
+namespace {
+
+// Largest mask, in pixels along each side.
+constexpr int MAX_MASK_SIZE = 256;
+// Glyph positions are rounded to this fraction of a pixel.
+constexpr int SUBPIXEL_STEPS = 4;
+// Glyph transforms are rounded to this fraction of a pixel per em.
+constexpr double TRANSFORM_STEPS = 32;
+
+std::shared_ptr<GlyphMask const> render_glyph_mask(GlyphMaskKey const &key, Geom::PathVector const &pathvec,
+                                                   std::shared_ptr<void const> const &font_data)
+{
+    auto const tr = Geom::Affine(key.coeffs[0] / TRANSFORM_STEPS, key.coeffs[1] / TRANSFORM_STEPS,
+                                 key.coeffs[2] / TRANSFORM_STEPS, key.coeffs[3] / TRANSFORM_STEPS,
+                                 key.subpixel[0] / (double)SUBPIXEL_STEPS, key.subpixel[1] / (double)SUBPIXEL_STEPS);
+    auto const bounds = pathvec.boundsFast();
+    if (!bounds) {
+        return {};
+    }
+    auto const box = expandedBy((*bounds * tr).roundOutwards(), 1);
+    if (box.width() > MAX_MASK_SIZE || box.height() > MAX_MASK_SIZE) {
+        return {};
+    }
+
+    auto mask = std::make_shared<GlyphMask>();
+    mask->surface = cairo_image_surface_create(CAIRO_FORMAT_A8, box.width(), box.height());
+    if (cairo_surface_status(mask->surface) != CAIRO_STATUS_SUCCESS) {
+        return {};
+    }
+    mask->origin = box.min();
+    mask->font_data = font_data;
+
+    cairo_t *ct = cairo_create(mask->surface);
+    ink_cairo_transform(ct, tr * Geom::Translate(-Geom::Point(box.min())));
+    cairo_set_fill_rule(ct, key.fill_rule);
+    cairo_set_antialias(ct, key.antialias);
+    feed_pathvector_to_cairo(ct, pathvec);
+    cairo_fill(ct);
+    cairo_destroy(ct);
+    cairo_surface_flush(mask->surface);
+
+    return mask;
+}
+
+} // namespace
+
+bool GlyphMaskKey::operator==(GlyphMaskKey const &other) const
+{
+    return pathvec == other.pathvec && std::equal(coeffs, coeffs + 4, other.coeffs) &&
+           subpixel[0] == other.subpixel[0] && subpixel[1] == other.subpixel[1] &&
+           fill_rule == other.fill_rule && antialias == other.antialias;
+}
+
+std::size_t GlyphMaskKeyHash::operator()(GlyphMaskKey const &key) const
+{
+    auto h = std::hash<void const *>()(key.pathvec);
+    auto const mix = [&h] (long v) { h ^= std::hash<long>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2); };
+    for (auto c : key.coeffs) {
+        mix(c);
+    }
+    mix(key.subpixel[0] * SUBPIXEL_STEPS + key.subpixel[1]);
+    mix(key.fill_rule * 16 + key.antialias);
+    return h;
+}
+
+GlyphMask::~GlyphMask()
+{
+    if (surface) {
+        cairo_surface_destroy(surface);
+    }
+}
+
+std::size_t GlyphMask::bytes() const
+{
+    return cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+}
+
+GlyphMaskCache &GlyphMaskCache::get()
+{
+    static GlyphMaskCache instance;
+    return instance;
+}
+
+std::shared_ptr<GlyphMask const> GlyphMaskCache::lookup(GlyphMaskKey const &key)
+{
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return {};
+    }
+    if (it->second->second->font_data.expired()) {
+        // The glyph outline is gone, and its address may have been reused.
+        _erase(it);
+        return {};
+    }
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return it->second->second;
+}
+
+void GlyphMaskCache::insert(GlyphMaskKey const &key, std::shared_ptr<GlyphMask const> mask)
+{
+    auto lock = std::lock_guard(_mutex);
+    if (auto it = _index.find(key); it != _index.end()) {
+        _erase(it);
+    }
+    _bytes += mask->bytes();
+    _entries.emplace_front(key, std::move(mask));
+    _index.emplace(key, _entries.begin());
+
+    while (_bytes > MAX_MASK_BYTES && _entries.size() > 1) {
+        _erase(_index.find(_entries.back().first));
+    }
+}
+
+void GlyphMaskCache::clear()
+{
+    auto lock = std::lock_guard(_mutex);
+    _entries.clear();
+    _index.clear();
+    _bytes = 0;
+}
+
+std::size_t GlyphMaskCache::memory_usage()
+{
+    auto lock = std::lock_guard(_mutex);
+    return _bytes;
+}
+
+void GlyphMaskCache::_erase(Index::iterator it)
+{
+    _bytes -= it->second->second->bytes();
+    _entries.erase(it->second);
+    _index.erase(it);
+}
+
+bool draw_glyph_mask(DrawingContext &dc, Geom::PathVector const &pathvec, std::shared_ptr<void const> const &font_data)
+{
+    if (pathvec.empty()) {
+        return true;
+    }
+
+    auto ct = dc.raw();
+    auto target = cairo_get_group_target(ct);
+    double sx, sy, ox, oy;
+    cairo_surface_get_device_scale(target, &sx, &sy);
+    cairo_surface_get_device_offset(target, &ox, &oy);
+    cairo_matrix_t m;
+    cairo_get_matrix(ct, &m);
+    Geom::Affine to_pixels;
+    ink_matrix_to_2geom(to_pixels, m);
+    to_pixels *= Geom::Affine(sx, 0, 0, sy, ox, oy);
+
+    if (to_pixels.descrim() > MAX_MASKED_GLYPH_SIZE) {
+        return false;
+    }
+
+    GlyphMaskKey key;
+    key.pathvec = &pathvec;
+    for (int i = 0; i < 4; i++) {
+        key.coeffs[i] = std::lround(to_pixels[i] * TRANSFORM_STEPS);
+    }
+    Geom::IntPoint pixel;
+    for (auto d : {Geom::X, Geom::Y}) {
+        auto const steps = std::lround(to_pixels.translation()[d] * SUBPIXEL_STEPS);
+        pixel[d] = std::floor(steps / (double)SUBPIXEL_STEPS);
+        key.subpixel[d] = steps - (long)pixel[d] * SUBPIXEL_STEPS;
+    }
+    key.fill_rule = cairo_get_fill_rule(ct);
+    key.antialias = cairo_get_antialias(ct);
+
+    auto &cache = GlyphMaskCache::get();
+    auto mask = cache.lookup(key);
+    if (!mask) {
+        mask = render_glyph_mask(key, pathvec, font_data);
+        if (!mask) {
+            return false;
+        }
+        cache.insert(key, mask);
+    }
+
+    // Draw in device pixels.
+    cairo_matrix_t identity;
+    cairo_matrix_init(&identity, 1 / sx, 0, 0, 1 / sy, -ox / sx, -oy / sy);
+    cairo_set_matrix(ct, &identity);
+    auto const pos = pixel + mask->origin;
+    cairo_mask_surface(ct, mask->surface, pos.x(), pos.y());
+    return true;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cached coverage masks of the glyphs of small text.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_GLYPH_MASK_CACHE_H
+#define INKSCAPE_DISPLAY_GLYPH_MASK_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <cairo.h>
+#include <2geom/int-point.h>
+#include <2geom/pathvector.h>
+
+namespace Inkscape {
+
+class DrawingContext;
+
+// Largest glyphs drawn from masks, as the size of the em square in device pixels.
+constexpr double MAX_MASKED_GLYPH_SIZE = 48;
+// Memory kept for masks, in bytes.
+constexpr std::size_t MAX_MASK_BYTES = 32 << 20;
+
+struct GlyphMaskKey
+{
+    Geom::PathVector const *pathvec; // Identifies the font and glyph while the font data lives.
+    long coeffs[4];                  // Linear part of the transform, in units of 1 / TRANSFORM_STEPS.
+    int subpixel[2];                 // Position within the pixel, in units of 1 / SUBPIXEL_STEPS.
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+
+    bool operator==(GlyphMaskKey const &other) const;
+};
+
+struct GlyphMaskKeyHash
+{
+    std::size_t operator()(GlyphMaskKey const &key) const;
+};
+
+/// Alpha coverage of a glyph at one size, orientation and subpixel position.
+struct GlyphMask
+{
+    cairo_surface_t *surface = nullptr;
+    Geom::IntPoint origin; // Of the mask, relative to the pixel the glyph origin falls in.
+    std::weak_ptr<void const> font_data;
+
+    GlyphMask() = default;
+    GlyphMask(GlyphMask const &) = delete;
+    GlyphMask &operator=(GlyphMask const &) = delete;
+    ~GlyphMask();
+
+    std::size_t bytes() const;
+};
+
+/**
+ * Masks of the glyphs of small text, shared by all drawings and rendering threads, so that such
+ * text can be drawn by compositing them rather than by filling the glyph outlines on every tile.
+ * The least recently used masks are dropped once they take more than MAX_MASK_BYTES.
+ */
+class GlyphMaskCache
+{
+public:
+    static GlyphMaskCache &get();
+
+    /// Returns the mask stored under the key, or null.
+    std::shared_ptr<GlyphMask const> lookup(GlyphMaskKey const &key);
+    void insert(GlyphMaskKey const &key, std::shared_ptr<GlyphMask const> mask);
+
+    /// Forget all masks.
+    void clear();
+
+    std::size_t memory_usage();
+
+private:
+    using Entries = std::list<std::pair<GlyphMaskKey, std::shared_ptr<GlyphMask const>>>;
+    using Index = std::unordered_map<GlyphMaskKey, Entries::iterator, GlyphMaskKeyHash>;
+
+    void _erase(Index::iterator it);
+
+    std::mutex _mutex;
+    Entries _entries; // Most recently used first.
+    Index _index;
+    std::size_t _bytes = 0;
+};
+
+/**
+ * Composite the current source of dc through the mask of a glyph, with the transform of dc
+ * mapping glyph space to the device. Returns false without drawing if the glyph is too large to
+ * be drawn this way.
+ */
+bool draw_glyph_mask(DrawingContext &dc, Geom::PathVector const &pathvec, std::shared_ptr<void const> const &font_data);
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_GLYPH_MASK_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
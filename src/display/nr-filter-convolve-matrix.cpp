@@ -224,6 +224,14 @@ void FilterConvolveMatrix::area_enlarge(Geom::IntRect &area, Geom::Affine const
     area.setMax(area.max() + Geom::IntPoint(orderX - targetX - 1, orderY - targetY - 1));
 }
 
+Geom::IntRect FilterConvolveMatrix::damage_area(Geom::IntRect const &area, Geom::Affine const &/*trans*/) const
+{
+    // The kernel is anchored at the target, so a changed input pixel affects outputs in the
+    // mirror image of the area read by area_enlarge().
+    return Geom::IntRect(area.min() - Geom::IntPoint(orderX - targetX - 1, orderY - targetY - 1),
+                         area.max() + Geom::IntPoint(targetX, targetY));
+}
+
 double FilterConvolveMatrix::complexity(Geom::Affine const &) const
 {
     return kernelMatrix.size();
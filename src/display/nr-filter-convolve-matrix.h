@@ -37,6 +37,7 @@ public:
 
     void render_cairo(FilterSlot &slot) const override;
     void area_enlarge(Geom::IntRect &area, Geom::Affine const &trans) const override;
+    Geom::IntRect damage_area(Geom::IntRect const &area, Geom::Affine const &trans) const override;
     double complexity(Geom::Affine const &ctm) const override;
 
     void set_targetY(int coord);
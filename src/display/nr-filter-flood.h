@@ -28,6 +28,7 @@ public:
     ~FilterFlood() override;
 
     void render_cairo(FilterSlot &slot) const override;
+    std::vector<int> inputs() const override { return {}; }
     bool can_handle_affine(Geom::Affine const &) const override;
     double complexity(Geom::Affine const &ctm) const override;
     bool uses_background()  const override { return false; }
@@ -22,10 +22,8 @@
 #include <cstdlib>
 #include <glib.h>
 #include <limits>
-#if HAVE_OPENMP
-#include <omp.h>
-#endif //HAVE_OPENMP
 
+#include "async/scheduler.h"
 #include "display/cairo-utils.h"
 #include "display/nr-filter-primitive.h"
 #include "display/nr-filter-gaussian.h"
@@ -302,16 +300,8 @@ filter2D_IIR(PT *const dest, int const dstr1, int const dstr2,
     #define PREMUL_ALPHA_LOOP for(unsigned int c=1; c<PC; ++c)
 #endif
 
-INK_UNUSED(num_threads); // to suppress unused argument compiler warning
-#if HAVE_OPENMP
-#pragma omp parallel for num_threads(num_threads)
-#endif // HAVE_OPENMP
-    for ( int c2 = 0 ; c2 < n2 ; c2++ ) {
-#if HAVE_OPENMP
-        unsigned int tid = omp_get_thread_num();
-#else
-        unsigned int tid = 0;
-#endif // HAVE_OPENMP
+    // Each task uses its own slot of tmpdata.
+    Inkscape::Async::Scheduler::get().parallel_for_slots(0, n2, [&] (int c2, int tid) {
         // corresponding line in the source and output buffer
         PT const * srcimg = src  + c2*sstr2;
         PT       * dstimg = dest + c2*dstr2 + n1*dstr1;
@@ -357,7 +347,7 @@ INK_UNUSED(num_threads); // to suppress unused argument compiler warning
                 for(unsigned int c=0; c<PC; c++) dstimg[c] = clip_round_cast<PT>(v[0][c]);
             }
         }
-    }
+    }, num_threads);
 }
 
 // Filters over 1st dimension
@@ -371,14 +361,9 @@ filter2D_FIR(PT *const dst, int const dstr1, int const dstr2,
 {
     assert(src && dst);
 
-    // Past pixels seen (to enable in-place operation)
-    PT history[scr_len+1][PC];
-
-INK_UNUSED(num_threads); // suppresses unused argument compiler warning
-#if HAVE_OPENMP
-#pragma omp parallel for num_threads(num_threads) private(history)
-#endif // HAVE_OPENMP
-    for ( int c2 = 0 ; c2 < n2 ; c2++ ) {
+    Inkscape::Async::Scheduler::get().parallel_for(0, n2, [&] (int c2) {
+        // Past pixels seen (to enable in-place operation)
+        PT history[scr_len+1][PC];
 
         // corresponding line in the source buffer
         int const src_line = c2 * sstr2;
@@ -465,7 +450,7 @@ INK_UNUSED(num_threads); // suppresses unused argument compiler warning
                 }
             }
         }
-    }
+    }, num_threads);
 }
 
 static void
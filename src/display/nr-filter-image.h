@@ -32,6 +32,7 @@ class FilterImage : public FilterPrimitive
 public:
     void update() override;
     void render_cairo(FilterSlot &slot) const override;
+    std::vector<int> inputs() const override { return {}; }
     bool can_handle_affine(Geom::Affine const &) const override;
     double complexity(Geom::Affine const &ctm) const override;
 
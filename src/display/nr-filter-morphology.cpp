@@ -16,8 +16,12 @@
 
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <deque>
 #include <functional>
+#include <vector>
+#include "async/scheduler.h"
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
 #include "display/nr-filter-morphology.h"
@@ -31,12 +35,6 @@ FilterMorphology::FilterMorphology() = default;
 
 FilterMorphology::~FilterMorphology() = default;
 
-enum MorphologyOp
-{
-    ERODE,
-    DILATE
-};
-
 namespace {
 
 /* This performs one "half" of the morphology operation by calculating 
@@ -48,7 +46,7 @@ namespace {
  *       One problem with the 2D algorithm is that it is harder to parallelize.
  */
 template <typename Comparison, Geom::Dim2 axis, int BPP>
-void morphologicalFilter1D(cairo_surface_t * const input, cairo_surface_t * const out, double radius)
+void morphologicalFilter1DDeque(cairo_surface_t * const input, cairo_surface_t * const out, double radius)
 {
     Comparison comp;
 
@@ -65,11 +63,7 @@ void morphologicalFilter1D(cairo_surface_t * const input, cairo_surface_t * cons
     int ri = round(radius); // TODO: Support fractional radii?
     int wi = 2*ri+1;
 
-    #if HAVE_OPENMP
-    int limit = w * h;
-    #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(get_num_filter_threads())
-    #endif // HAVE_OPENMP
-    for (int i = 0; i < h; ++i) {
+    ink_cairo_parallel_for(0, h, w * h, [&] (int i) {
         // TODO: Store position and value in one 32 bit integer? 24 bits should be enough for a position, it would be quite strange to have an image with a width/height of more than 16 million(!).
         std::deque<std::pair<int, unsigned char>> vals[BPP]; // In my tests it was actually slightly faster to allocate it here than allocate it once for all threads and retrieving the correct set based on the thread id.
 
@@ -148,13 +142,176 @@ void morphologicalFilter1D(cairo_surface_t * const input, cairo_surface_t * cons
             }
             if (axis == Geom::Y) out_p += strideout - BPP;
         }
+    });
+
+    cairo_surface_mark_dirty(out);
+}
+
+/* Extreme operations on a single 8 bit channel. The identity is the value which
+ * never changes the result, it is used for samples before the start of a row. */
+struct Max8
+{
+    using value_type = std::uint8_t;
+    static constexpr value_type identity = 0;
+    static value_type apply(value_type a, value_type b) { return std::max(a, b); }
+};
+
+struct Min8
+{
+    using value_type = std::uint8_t;
+    static constexpr value_type identity = 0xff;
+    static value_type apply(value_type a, value_type b) { return std::min(a, b); }
+};
+
+/* Returns 0xff in every byte where a >= b, and 0x00 elsewhere (SIMD within a register).
+ * Each byte of (a | H) - (b & ~H) is at least 1, so no borrow crosses byte boundaries,
+ * and its top bit tells whether the low 7 bits of a are at least those of b. */
+inline std::uint32_t bytewise_ge_mask(std::uint32_t a, std::uint32_t b)
+{
+    constexpr std::uint32_t H = 0x80808080u;
+    std::uint32_t low_ge = (a | H) - (b & ~H);
+    std::uint32_t ge = ((a & ~b) | (~(a ^ b) & low_ge)) & H;
+    return (ge >> 7) * 0xffu;
+}
+
+/* Extreme operations on all four channels of an ARGB32 pixel at once. */
+struct Max32
+{
+    using value_type = std::uint32_t;
+    static constexpr value_type identity = 0;
+    static value_type apply(value_type a, value_type b)
+    {
+        std::uint32_t m = bytewise_ge_mask(a, b);
+        return (a & m) | (b & ~m);
     }
+};
+
+struct Min32
+{
+    using value_type = std::uint32_t;
+    static constexpr value_type identity = 0xffffffffu;
+    static value_type apply(value_type a, value_type b)
+    {
+        std::uint32_t m = bytewise_ge_mask(a, b);
+        return (b & m) | (a & ~m);
+    }
+};
+
+/* Same result as morphologicalFilter1DDeque, computed with the van Herk/Gil-Werman algorithm:
+ *   M. van Herk (1992), "A fast algorithm for local minimum and maximum filters on rectangular and octagonal kernels"
+ *   J. Gil, M. Werman (1993), "Computing 2-D min, median, and max filters"
+ * The padded row is split into blocks of the window size; the extreme over a window is then the
+ * extreme of a suffix of one block and a prefix of the next, so the cost per pixel is constant
+ * (three operations) regardless of the radius. All channels of a pixel are handled at once.
+ *
+ * To match the deque implementation, samples before the start of a row are ignored, while
+ * samples past its end count as transparent black.
+ */
+template <typename Op, Geom::Dim2 axis>
+void morphologicalFilter1DVanHerk(cairo_surface_t * const input, cairo_surface_t * const out, double radius)
+{
+    using T = typename Op::value_type;
+    constexpr int BPP = sizeof(T);
+
+    int w = cairo_image_surface_get_width(out);
+    int h = cairo_image_surface_get_height(out);
+    if (axis == Geom::Y) std::swap(w,h);
+
+    int stridein = cairo_image_surface_get_stride(input);
+    int strideout = cairo_image_surface_get_stride(out);
+
+    unsigned char const *in_data = cairo_image_surface_get_data(input);
+    unsigned char *out_data = cairo_image_surface_get_data(out);
+
+    // A window wider than twice the row behaves exactly like one of twice the row.
+    int ri = std::min<int>(round(radius), w); // TODO: Support fractional radii?
+    int wi = 2*ri+1;
+    int n = w + 2*ri; // Length of the padded row.
+
+    int step_in = axis == Geom::X ? BPP : stridein;
+    int step_out = axis == Geom::X ? BPP : strideout;
+
+    // Per-task scratch buffer holding the block prefix extremes of one padded row.
+    auto &scheduler = Inkscape::Async::Scheduler::get();
+    int max_tasks = w * h > PARALLEL_THRESHOLD ? get_num_filter_threads() : 1;
+    std::vector<std::vector<T>> scratch(scheduler.concurrency(max_tasks), std::vector<T>(n));
+
+    scheduler.parallel_for_slots(0, h, [&] (int i, int slot) {
+        T *prefix = scratch[slot].data();
+
+        unsigned char const *in_row = in_data + i * (axis == Geom::X ? stridein : BPP);
+        unsigned char *out_row = out_data + i * (axis == Geom::X ? strideout : BPP);
+
+        // Sample e of the padded row corresponds to input position e - ri.
+        auto sample = [&] (int e) -> T {
+            int j = e - ri;
+            if (j < 0) return Op::identity;
+            if (j >= w) return 0;
+            T v;
+            std::memcpy(&v, in_row + j * step_in, BPP);
+            return v;
+        };
+
+        // Forward pass: extremes from the start of each block.
+        for (int e = 0; e < n; ++e) {
+            T v = sample(e);
+            prefix[e] = e % wi == 0 ? v : Op::apply(prefix[e-1], v);
+        }
+
+        // Backward pass: extremes to the end of each block, combined with the prefix
+        // extreme at the other end of the window [o, o + 2*ri].
+        T suffix = Op::identity;
+        for (int e = n-1; e >= 0; --e) {
+            T v = sample(e);
+            suffix = (e == n-1 || (e+1) % wi == 0) ? v : Op::apply(suffix, v);
+            if (e < w) {
+                T r = Op::apply(suffix, prefix[e + 2*ri]);
+                std::memcpy(out_row + e * step_out, &r, BPP);
+            }
+        }
+    }, max_tasks);
 
     cairo_surface_mark_dirty(out);
 }
 
+template <typename Comparison, typename Op8, typename Op32>
+void morphologicalFilter1D(cairo_surface_t *input, cairo_surface_t *out, double radius, Geom::Dim2 axis,
+                           MorphologyAlgorithm algorithm)
+{
+    bool a8 = cairo_image_surface_get_format(input) == CAIRO_FORMAT_A8;
+
+    if (algorithm == MorphologyAlgorithm::DEQUE) {
+        if (axis == Geom::X) {
+            if (a8) morphologicalFilter1DDeque<Comparison, Geom::X, 1>(input, out, radius);
+            else    morphologicalFilter1DDeque<Comparison, Geom::X, 4>(input, out, radius);
+        } else {
+            if (a8) morphologicalFilter1DDeque<Comparison, Geom::Y, 1>(input, out, radius);
+            else    morphologicalFilter1DDeque<Comparison, Geom::Y, 4>(input, out, radius);
+        }
+    } else {
+        if (axis == Geom::X) {
+            if (a8) morphologicalFilter1DVanHerk<Op8, Geom::X>(input, out, radius);
+            else    morphologicalFilter1DVanHerk<Op32, Geom::X>(input, out, radius);
+        } else {
+            if (a8) morphologicalFilter1DVanHerk<Op8, Geom::Y>(input, out, radius);
+            else    morphologicalFilter1DVanHerk<Op32, Geom::Y>(input, out, radius);
+        }
+    }
+}
+
 } // namespace
 
+void morphology_pass(cairo_surface_t *input, cairo_surface_t *out, double radius, Geom::Dim2 axis,
+                     FilterMorphologyOperator op, MorphologyAlgorithm algorithm)
+{
+    cairo_surface_flush(input);
+    if (op == MORPHOLOGY_OPERATOR_DILATE) {
+        morphologicalFilter1D<std::greater<unsigned char>, Max8, Max32>(input, out, radius, axis, algorithm);
+    } else {
+        morphologicalFilter1D<std::less<unsigned char>, Min8, Min32>(input, out, radius, axis, algorithm);
+    }
+}
+
 void FilterMorphology::render_cairo(FilterSlot &slot) const
 {
     cairo_surface_t *input = slot.getcairo(_input);
@@ -172,42 +329,16 @@ void FilterMorphology::render_cairo(FilterSlot &slot) const
     Geom::Affine p2pb = slot.get_units().get_matrix_primitiveunits2pb();
     double xr = fabs(xradius * p2pb.expansionX()) * device_scale;
     double yr = fabs(yradius * p2pb.expansionY()) * device_scale;
-    int bpp = cairo_image_surface_get_format(input) == CAIRO_FORMAT_A8 ? 1 : 4;
 
     cairo_surface_t *interm = ink_cairo_surface_create_identical(input);
-
-    if (Operator == MORPHOLOGY_OPERATOR_DILATE) {
-        if (bpp == 1) {
-            morphologicalFilter1D< std::greater<unsigned char>, Geom::X, 1 >(input, interm, xr);
-        } else {
-            morphologicalFilter1D< std::greater<unsigned char>, Geom::X, 4 >(input, interm, xr);
-        }
-    } else {
-        if (bpp == 1) {
-            morphologicalFilter1D< std::less<unsigned char>, Geom::X, 1 >(input, interm, xr);
-        } else {
-            morphologicalFilter1D< std::less<unsigned char>, Geom::X, 4 >(input, interm, xr);
-        }
-    }
+    morphology_pass(input, interm, xr, Geom::X, Operator);
 
     cairo_surface_t *out = ink_cairo_surface_create_identical(interm);
 
     // color_interpolation_filters for out same as input. See spec (DisplacementMap).
     copy_cairo_surface_ci(input, out);
 
-    if (Operator == MORPHOLOGY_OPERATOR_DILATE) {
-        if (bpp == 1) {
-            morphologicalFilter1D< std::greater<unsigned char>, Geom::Y, 1 >(interm, out, yr);
-        } else {
-            morphologicalFilter1D< std::greater<unsigned char>, Geom::Y, 4 >(interm, out, yr);
-        }
-    } else {
-        if (bpp == 1) {
-            morphologicalFilter1D< std::less<unsigned char>, Geom::Y, 1 >(interm, out, yr);
-        } else {
-            morphologicalFilter1D< std::less<unsigned char>, Geom::Y, 4 >(interm, out, yr);
-        }
-    }
+    morphology_pass(interm, out, yr, Geom::Y, Operator);
 
     cairo_surface_destroy(interm);
 
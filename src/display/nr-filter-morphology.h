@@ -13,6 +13,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cairo.h>
 #include "display/nr-filter-primitive.h"
 
 namespace Inkscape {
@@ -27,6 +28,22 @@ enum FilterMorphologyOperator
     MORPHOLOGY_OPERATOR_END
 };
 
+/// Algorithm used for a single pass of the morphology operation.
+enum class MorphologyAlgorithm
+{
+    DEQUE,    ///< Monotone FIFO per channel (Dokládal & Dokládalová), kept as a reference.
+    VAN_HERK  ///< van Herk/Gil-Werman block extrema, all channels of a pixel at once.
+};
+
+/**
+ * Compute the componentwise extreme along one axis with the given radius,
+ * writing the result to \a out, which must be of the same size and format as \a input.
+ * Only exposed for testing and benchmarking; filters should use FilterMorphology.
+ */
+void morphology_pass(cairo_surface_t *input, cairo_surface_t *out, double radius, Geom::Dim2 axis,
+                     FilterMorphologyOperator op,
+                     MorphologyAlgorithm algorithm = MorphologyAlgorithm::VAN_HERK);
+
 class FilterMorphology : public FilterPrimitive
 {
 public:
@@ -92,6 +92,18 @@ void FilterOffset::area_enlarge(Geom::IntRect &area, Geom::Affine const &trans)
     area = Geom::IntRect(x0, y0, x1, y1);
 }
 
+Geom::IntRect FilterOffset::damage_area(Geom::IntRect const &area, Geom::Affine const &trans) const
+{
+    // Changed pixels move with the offset, rather than spreading.
+    Geom::Point offset(dx, dy);
+    offset *= trans;
+    offset[X] -= trans[4];
+    offset[Y] -= trans[5];
+
+    return Geom::IntRect(area.left() + std::floor(offset[X]), area.top() + std::floor(offset[Y]),
+                         area.right() + std::ceil(offset[X]), area.bottom() + std::ceil(offset[Y]));
+}
+
 double FilterOffset::complexity(Geom::Affine const &) const
 {
     return 1.02;
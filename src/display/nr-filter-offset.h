@@ -28,6 +28,7 @@ public:
 
     void render_cairo(FilterSlot &slot) const override;
     void area_enlarge(Geom::IntRect &area, Geom::Affine const &trans) const override;
+    Geom::IntRect damage_area(Geom::IntRect const &area, Geom::Affine const &trans) const override;
     bool can_handle_affine(Geom::Affine const &) const override;
     double complexity(Geom::Affine const &ctm) const override;
 
@@ -56,6 +56,13 @@ void FilterPrimitive::render_cairo(FilterSlot &slot) const
     slot.set(_output, in);
 }
 
+Geom::IntRect FilterPrimitive::damage_area(Geom::IntRect const &area, Geom::Affine const &m) const
+{
+    auto result = area;
+    area_enlarge(result, m);
+    return result;
+}
+
 void FilterPrimitive::set_input(int slot)
 {
     set_input(0, slot);
@@ -13,6 +13,7 @@
 #define SEEN_NR_FILTER_PRIMITIVE_H
 
 #include <memory>
+#include <vector>
 #include <2geom/forward.h>
 #include <2geom/rect.h>
 
@@ -40,6 +41,21 @@ public:
     virtual void render_cairo(FilterSlot &slot) const;
     virtual void area_enlarge(Geom::IntRect &area, Geom::Affine const &m) const {}
 
+    /**
+     * Returns the area of the output that may change when the inputs change within 'area'.
+     * This is the reverse of area_enlarge(), which gives the input needed to render an output
+     * area. The default assumes the primitive's kernel is symmetric, so that both are the same.
+     */
+    virtual Geom::IntRect damage_area(Geom::IntRect const &area, Geom::Affine const &m) const;
+
+    /**
+     * Returns the slots read by this primitive. NR_FILTER_SLOT_NOT_SET stands for the result
+     * of the previous primitive. Primitives which generate their output return none.
+     */
+    virtual std::vector<int> inputs() const { return {_input}; }
+
+    int output() const { return _output; }
+
     /**
      * Sets the input slot number 'slot' to be used as input in rendering
      * filter primitive 'primitive'
@@ -23,6 +23,7 @@
 #include "nr-filter-gaussian.h"
 #include "nr-filter-slot.h"
 #include "nr-filter-units.h"
+#include "surface-pool.h"
 
 namespace Inkscape {
 namespace Filters {
@@ -118,7 +119,7 @@ cairo_surface_t *FilterSlot::getcairo(int slot_nr)
 
     if (s == _slots.end()) {
         // create empty surface
-        cairo_surface_t *empty = cairo_surface_create_similar(
+        cairo_surface_t *empty = SurfacePool::get().create_similar(
             _source_graphic, cairo_surface_get_content(_source_graphic),
             _slot_w, _slot_h);
         _set_internal(slot_nr, empty);
@@ -143,7 +144,7 @@ cairo_surface_t *FilterSlot::_get_transformed_source_graphic() const
         return _source_graphic;
     }
 
-    cairo_surface_t *tsg = cairo_surface_create_similar(
+    cairo_surface_t *tsg = SurfacePool::get().create_similar(
         _source_graphic, cairo_surface_get_content(_source_graphic),
         _slot_w, _slot_h);
     cairo_t *tsg_ct = cairo_create(tsg);
@@ -167,7 +168,7 @@ cairo_surface_t *FilterSlot::_get_transformed_background() const
 
     if (_background_ct) {
         cairo_surface_t *bg = cairo_get_group_target(_background_ct);
-        tbg = cairo_surface_create_similar(
+        tbg = SurfacePool::get().create_similar(
             bg, cairo_surface_get_content(bg),
             _slot_w, _slot_h);
         cairo_t *tbg_ct = cairo_create(tbg);
@@ -180,7 +181,7 @@ cairo_surface_t *FilterSlot::_get_transformed_background() const
         cairo_paint(tbg_ct);
         cairo_destroy(tbg_ct);
     } else {
-        tbg = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, _slot_w * device_scale, _slot_h * device_scale);
+        tbg = SurfacePool::get().create(CAIRO_FORMAT_ARGB32, _slot_w * device_scale, _slot_h * device_scale);
     }
 
     return tbg;
@@ -196,7 +197,7 @@ cairo_surface_t *FilterSlot::get_result(int res)
         return result;
     }
 
-    cairo_surface_t *r = cairo_surface_create_similar(_source_graphic,
+    cairo_surface_t *r = SurfacePool::get().create_similar(_source_graphic,
         cairo_surface_get_content(_source_graphic),
         _source_graphic_area.width(),
         _source_graphic_area.height());
@@ -48,6 +48,7 @@ public:
     ~FilterTurbulence() override;
 
     void render_cairo(FilterSlot &slot) const override;
+    std::vector<int> inputs() const override { return {}; }
     double complexity(Geom::Affine const &ctm) const override;
     bool uses_background() const override { return false; }
 
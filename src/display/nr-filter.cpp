@@ -13,6 +13,7 @@
 #include <glib.h>
 #include <cmath>
 #include <cstring>
+#include <map>
 #include <string>
 #include <cairo.h>
 
@@ -223,6 +224,40 @@ void Filter::area_enlarge(Geom::IntRect &bbox, Inkscape::DrawingItem const *item
 */
 }
 
+Geom::OptIntRect Filter::damage_area(Geom::IntRect const &area, Inkscape::DrawingItem const *item) const
+{
+    if (primitives.empty()) {
+        // Nothing is drawn.
+        return {};
+    }
+
+    // Damaged area of each slot, following the same slot resolution as FilterSlot.
+    std::map<int, Geom::OptIntRect> damage;
+    damage[NR_FILTER_SOURCEGRAPHIC] = area;
+    damage[NR_FILTER_SOURCEALPHA] = area;
+    int last_out = NR_FILTER_SOURCEGRAPHIC;
+
+    auto get = [&] (int slot) -> Geom::OptIntRect {
+        auto it = damage.find(slot == NR_FILTER_SLOT_NOT_SET ? last_out : slot);
+        return it != damage.end() ? it->second : Geom::OptIntRect();
+    };
+
+    for (auto const &i : primitives) {
+        if (!i) continue;
+
+        Geom::OptIntRect in;
+        for (int slot : i->inputs()) {
+            in.unionWith(get(slot));
+        }
+
+        int out = i->output() == NR_FILTER_SLOT_NOT_SET ? NR_FILTER_UNNAMED_SLOT : i->output();
+        damage[out] = in ? i->damage_area(*in, item->ctm()) : Geom::OptIntRect();
+        last_out = out;
+    }
+
+    return get(_output_slot);
+}
+
 Geom::OptRect Filter::filter_effect_area(Geom::OptRect const &bbox) const
 {
     Geom::Point minp, maxp;
@@ -138,6 +138,14 @@ public:
      */
     void area_enlarge(Geom::IntRect &area, Inkscape::DrawingItem const *item) const;
 
+    /**
+     * Returns the area of the filter output that may change when the source graphic of
+     * the given item changes within 'area'. The damage is followed through the primitive
+     * graph, so that primitives which do not depend on the changed input, or only move
+     * it, do not enlarge the result. The result is not clipped to the filter region.
+     */
+    Geom::OptIntRect damage_area(Geom::IntRect const &area, Inkscape::DrawingItem const *item) const;
+
     /**
      * Returns the filter effects area in user coordinate system.
      * The given bounding box should be a bounding box as specified in
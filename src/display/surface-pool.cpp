@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Recycling allocator for the pixel buffers of intermediate image surfaces.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "display/surface-pool.h"
+
+namespace Inkscape {
+namespace {
+
+constexpr int MIN_CLASS_LOG2 = 14;
+static_assert(SurfacePool::MIN_POOLED_SIZE == std::size_t{1} << MIN_CLASS_LOG2);
+
+int format_index(cairo_format_t format)
+{
+    switch (format) {
+        case CAIRO_FORMAT_A8:     return 0;
+        case CAIRO_FORMAT_RGB24:  return 1;
+        case CAIRO_FORMAT_ARGB32: return 2;
+        default:                  return -1;
+    }
+}
+
+cairo_format_t content_format(cairo_content_t content)
+{
+    switch (content) {
+        case CAIRO_CONTENT_ALPHA: return CAIRO_FORMAT_A8;
+        case CAIRO_CONTENT_COLOR: return CAIRO_FORMAT_RGB24;
+        default:                  return CAIRO_FORMAT_ARGB32;
+    }
+}
+
+int floor_log2(std::size_t x)
+{
+    int r = -1;
+    while (x) {
+        x >>= 1;
+        r++;
+    }
+    return r;
+}
+
+// std::aligned_alloc() is not available on Windows, whose aligned allocations need their own free.
+unsigned char *alloc_buffer(std::size_t size)
+{
+#ifdef _WIN32
+    return static_cast<unsigned char *>(_aligned_malloc(size, 64));
+#else
+    return static_cast<unsigned char *>(std::aligned_alloc(64, size));
+#endif
+}
+
+void free_buffer(unsigned char *buffer)
+{
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    std::free(buffer);
+#endif
+}
+
+/// The smallest size class whose buffers hold at least @a size bytes. Requires size >= MIN_POOLED_SIZE.
+int size_class(std::size_t size)
+{
+    int const k = floor_log2(size - 1);
+    std::size_t const base = std::size_t{1} << k;
+    int const quarter = (4 * (size - base) + base - 1) / base;
+    return 4 * (k - MIN_CLASS_LOG2) + quarter;
+}
+
+std::size_t class_size(int cls)
+{
+    return (std::size_t{1} << (MIN_CLASS_LOG2 + cls / 4)) / 4 * (4 + cls % 4);
+}
+
+} // namespace
+
+// Attached to each pooled surface, to return its buffer to the pool when the surface is destroyed.
+struct SurfacePool::Release
+{
+    SurfacePool *pool;
+    unsigned char *buffer;
+    int bucket;
+    std::size_t size;
+
+    static void destroy(void *data)
+    {
+        auto r = static_cast<Release *>(data);
+        r->pool->release(r->buffer, r->bucket, r->size);
+        delete r;
+    }
+};
+
+cairo_user_data_key_t const SurfacePool::_key{};
+
+SurfacePool::SurfacePool(std::size_t budget)
+    : _budget(budget)
+{
+}
+
+SurfacePool::~SurfacePool()
+{
+    clear();
+}
+
+SurfacePool &SurfacePool::get()
+{
+    static auto const instance = new SurfacePool;
+    return *instance;
+}
+
+cairo_surface_t *SurfacePool::create(cairo_format_t format, int width, int height)
+{
+    int const fmt = format_index(format);
+    int const stride = cairo_format_stride_for_width(format, width);
+    std::size_t const size = static_cast<std::size_t>(stride) * height;
+
+    if (fmt == -1 || stride <= 0 || height <= 0 || size < MIN_POOLED_SIZE) {
+        return cairo_image_surface_create(format, width, height);
+    }
+
+    int const cls = size_class(size);
+    if (cls >= NUM_CLASSES) {
+        return cairo_image_surface_create(format, width, height);
+    }
+    int const bucket = fmt * NUM_CLASSES + cls;
+    std::size_t const bufsize = class_size(cls);
+
+    unsigned char *buffer = nullptr;
+    {
+        auto &b = _buckets[bucket];
+        auto lock = std::lock_guard(b.mutex);
+        if (!b.buffers.empty()) {
+            buffer = b.buffers.back();
+            b.buffers.pop_back();
+        }
+    }
+
+    if (buffer) {
+        _idle_bytes.fetch_sub(bufsize, std::memory_order_relaxed);
+        _hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        buffer = alloc_buffer(bufsize);
+        if (!buffer) {
+            return cairo_image_surface_create(format, width, height);
+        }
+    }
+
+    // Callers expect a cleared surface, as returned by cairo_image_surface_create().
+    std::memset(buffer, 0, size);
+
+    auto surface = cairo_image_surface_create_for_data(buffer, format, width, height, stride);
+    auto release = new Release{this, buffer, bucket, bufsize};
+    if (cairo_surface_set_user_data(surface, &_key, release, &Release::destroy) != CAIRO_STATUS_SUCCESS) {
+        // Only fails if out of memory, in which case the surface is an inert error object.
+        delete release;
+        free_buffer(buffer);
+    }
+
+    return surface;
+}
+
+cairo_surface_t *SurfacePool::create_similar(cairo_surface_t *other, cairo_content_t content, int width, int height)
+{
+    if (cairo_surface_get_type(other) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return cairo_surface_create_similar(other, content, width, height);
+    }
+
+    // As for cairo_surface_create_similar(), the size is in device units.
+    double x_scale = 1;
+    double y_scale = 1;
+    cairo_surface_get_device_scale(other, &x_scale, &y_scale);
+
+    auto surface = create(content_format(content), width * x_scale, height * y_scale);
+    cairo_surface_set_device_scale(surface, x_scale, y_scale);
+    return surface;
+}
+
+void SurfacePool::release(unsigned char *buffer, int bucket, std::size_t size)
+{
+    // Reserve room in the budget before publishing the buffer, so the budget is never exceeded.
+    auto const idle = _idle_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (idle + size > budget()) {
+        _idle_bytes.fetch_sub(size, std::memory_order_relaxed);
+        _discards.fetch_add(1, std::memory_order_relaxed);
+        free_buffer(buffer);
+        return;
+    }
+
+    auto &b = _buckets[bucket];
+    auto lock = std::lock_guard(b.mutex);
+    b.buffers.push_back(buffer);
+}
+
+void SurfacePool::set_budget(std::size_t budget)
+{
+    _budget.store(budget, std::memory_order_relaxed);
+    trim(budget);
+}
+
+void SurfacePool::clear()
+{
+    trim(0);
+}
+
+// Free idle buffers, largest first, until at most @a budget bytes are held.
+void SurfacePool::trim(std::size_t budget)
+{
+    for (int cls = NUM_CLASSES - 1; cls >= 0; cls--) {
+        for (int fmt = 0; fmt < NUM_FORMATS; fmt++) {
+            auto &b = _buckets[fmt * NUM_CLASSES + cls];
+            auto lock = std::lock_guard(b.mutex);
+            while (!b.buffers.empty() && _idle_bytes.load(std::memory_order_relaxed) > budget) {
+                free_buffer(b.buffers.back());
+                b.buffers.pop_back();
+                _idle_bytes.fetch_sub(class_size(cls), std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+SurfacePool::Stats SurfacePool::stats() const
+{
+    Stats s;
+    s.hits = _hits.load(std::memory_order_relaxed);
+    s.misses = _misses.load(std::memory_order_relaxed);
+    s.discards = _discards.load(std::memory_order_relaxed);
+    s.idle_bytes = _idle_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SurfacePool::reset_stats()
+{
+    _hits.store(0, std::memory_order_relaxed);
+    _misses.store(0, std::memory_order_relaxed);
+    _discards.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
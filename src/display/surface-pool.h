@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Recycling allocator for the pixel buffers of intermediate image surfaces.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_SURFACE_POOL_H
+#define INKSCAPE_DISPLAY_SURFACE_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <cairo.h>
+
+namespace Inkscape {
+
+/**
+ * Pool of pixel buffers for image surfaces.
+ *
+ * Rendering creates and destroys many large intermediate surfaces for every tile: filter slots,
+ * opacity groups, masks and clips. Allocating these afresh costs a malloc, a free and a page
+ * fault for every page touched. Instead, surfaces created by the pool are backed by recycled
+ * buffers, which are handed back to the pool when the surface is destroyed, from whichever
+ * thread that happens on. The surfaces are ordinary cairo image surfaces, and are released
+ * with cairo_surface_destroy() as usual.
+ *
+ * Buffers are grouped by pixel format and by size class, where each size class spans a quarter
+ * of a power of two, so a surface can reuse a buffer that is up to 25% larger than it needs.
+ * Each class has its own lock, so render threads working on different sizes do not contend.
+ * The total size of idle buffers is capped by a memory budget; buffers that would exceed it
+ * are freed instead of being kept.
+ */
+class SurfacePool
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits = 0;      ///< Surfaces created from a recycled buffer.
+        std::uint64_t misses = 0;    ///< Surfaces which needed a new buffer.
+        std::uint64_t discards = 0;  ///< Buffers freed because the pool was over budget.
+        std::size_t idle_bytes = 0;  ///< Memory currently held by idle buffers.
+    };
+
+    explicit SurfacePool(std::size_t budget = DEFAULT_BUDGET);
+    ~SurfacePool();
+    SurfacePool(SurfacePool const &) = delete;
+    SurfacePool &operator=(SurfacePool const &) = delete;
+
+    /// The pool used for rendering. Never destroyed, since surfaces may outlive any static.
+    static SurfacePool &get();
+
+    /**
+     * Create a cleared image surface of the given size in pixels.
+     * Small surfaces and formats which are never used for intermediates are not pooled.
+     */
+    cairo_surface_t *create(cairo_format_t format, int width, int height);
+
+    /**
+     * Drop-in replacement for cairo_surface_create_similar(). Image surfaces are created from
+     * the pool, with the same device scale as @a other. Other surface types fall back to cairo.
+     */
+    cairo_surface_t *create_similar(cairo_surface_t *other, cairo_content_t content, int width, int height);
+
+    /// Set the maximum memory held by idle buffers, freeing buffers if it is exceeded.
+    void set_budget(std::size_t budget);
+    std::size_t budget() const { return _budget.load(std::memory_order_relaxed); }
+
+    /// Free all idle buffers.
+    void clear();
+
+    Stats stats() const;
+    void reset_stats();
+
+    static constexpr std::size_t DEFAULT_BUDGET = 128 << 20;
+    static constexpr std::size_t MIN_POOLED_SIZE = 16 << 10;
+
+private:
+    static constexpr int NUM_FORMATS = 3; // A8, RGB24, ARGB32
+    static constexpr int NUM_CLASSES = 4 * 48;
+
+    struct Bucket
+    {
+        std::mutex mutex;
+        std::vector<unsigned char *> buffers;
+    };
+
+    std::array<Bucket, NUM_FORMATS * NUM_CLASSES> _buckets;
+    std::atomic<std::size_t> _budget;
+    std::atomic<std::size_t> _idle_bytes = 0;
+    std::atomic<std::uint64_t> _hits = 0;
+    std::atomic<std::uint64_t> _misses = 0;
+    std::atomic<std::uint64_t> _discards = 0;
+
+    struct Release;
+    static cairo_user_data_key_t const _key;
+
+    void release(unsigned char *buffer, int bucket, std::size_t size);
+    void trim(std::size_t budget);
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_SURFACE_POOL_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -37,6 +37,7 @@
 #define noSP_DOCUMENT_DEBUG_IDLE
 #define noSP_DOCUMENT_DEBUG_UNDO
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -77,9 +78,11 @@
 #include "object/persp3d.h"
 #include "object/sp-defs.h"
 #include "object/sp-factory.h"
+#include "object/sp-lpe-item.h"
 #include "object/sp-namedview.h"
 #include "object/sp-root.h"
 #include "object/sp-symbol.h"
+#include "object/sp-text.h"
 #include "object/sp-page.h"
 
 #include "widgets/desktop-widget.h"
@@ -186,6 +189,11 @@ SPDocument::~SPDocument() {
     DocumentUndo::clearRedo(this);
     DocumentUndo::clearUndo(this);
 
+    for (auto const &update : _path_effect_queue) {
+        sp_object_unref(update.item);
+    }
+    _path_effect_queue.clear();
+
     if (root) {
         root->releaseReferences();
         sp_object_unref(root);
@@ -1434,6 +1442,9 @@ SPDocument::_updateDocument(int update_flags)
 {
     /* Process updates */
     if (this->root->uflags || this->root->mflags) {
+        // Path effects requested while updating, as on loading, are computed together at the end.
+        // The updates they cause are processed by the next call.
+        beginPathEffectUpdates();
         if (this->root->uflags) {
             SPItemCtx ctx;
             setupViewport(&ctx);
@@ -1441,14 +1452,80 @@ SPDocument::_updateDocument(int update_flags)
             DocumentUndo::ScopedInsensitive _no_undo(this);
 
             this->root->updateDisplay((SPCtx *)&ctx, update_flags);
+
+            if (!_text_layout_queue.empty()) {
+                auto texts = std::move(_text_layout_queue);
+                _text_layout_queue.clear();
+                SPText::rebuildLayouts(texts);
+                for (auto text : texts) {
+                    sp_object_unref(text);
+                }
+            }
+            _updated = true;
         }
         this->_emitModified();
+        flushPathEffectUpdates();
     }
 
     return !(this->root->uflags || this->root->mflags);
 }
 
 
+bool SPDocument::queueTextLayout(SPText *text)
+{
+    if (_updated) {
+        return false;
+    }
+    sp_object_ref(text);
+    _text_layout_queue.push_back(text);
+    return true;
+}
+
+void SPDocument::beginPathEffectUpdates()
+{
+    _queue_path_effects = true;
+}
+
+bool SPDocument::queuePathEffectUpdate(SPLPEItem *item, bool write, bool with_satellites)
+{
+    if (!_queue_path_effects) {
+        return false;
+    }
+    auto it = std::find_if(_path_effect_queue.begin(), _path_effect_queue.end(),
+                           [=] (auto const &queued) { return queued.item == item; });
+    if (it != _path_effect_queue.end()) {
+        it->write |= write;
+        it->with_satellites |= with_satellites;
+    } else {
+        sp_object_ref(item);
+        _path_effect_queue.push_back({item, write, with_satellites});
+    }
+    return true;
+}
+
+void SPDocument::flushPathEffectUpdates()
+{
+    _queue_path_effects = false;
+    auto queued = std::move(_path_effect_queue);
+    _path_effect_queue.clear();
+
+    std::vector<SPItem *> items;
+    for (auto const &update : queued) {
+        // Skip items deleted since they were queued.
+        if (update.item->parent) {
+            items.push_back(update.item);
+        }
+    }
+    sp_lpe_item_precompute_patheffects(items);
+
+    for (auto const &update : queued) {
+        if (update.item->parent) {
+            sp_lpe_item_update_patheffect(update.item, false, update.write, update.with_satellites);
+        }
+        sp_object_unref(update.item);
+    }
+}
+
 /**
  * Repeatedly works on getting the document updated, since sometimes
  * it takes more than one pass to get the document updated.  But it
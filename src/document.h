@@ -75,6 +75,8 @@ class SPObject;
 class SPGroup;
 class SPRoot;
 class SPNamedView;
+class SPText;
+class SPLPEItem;
 
 namespace Inkscape {
     class Selection; 
@@ -163,6 +165,20 @@ public:
     bool _updateDocument(int flags); // Used by stand-alone sp_document_idle_handler
     int ensureUpToDate();
 
+    /// Called by a text to be laid out, during the first update of the document, together with
+    /// the others at the end of the update. Returns false if it should lay itself out now.
+    bool queueTextLayout(SPText *text);
+
+    /// Until flushPathEffectUpdates(), have the shapes whose path effect can be computed concurrently
+    /// queue their updates, so that they are computed together.
+    void beginPathEffectUpdates();
+    /// Called by a shape to have its path effect updated by flushPathEffectUpdates(). Returns false
+    /// if it should update now.
+    bool queuePathEffectUpdate(SPLPEItem *item, bool write, bool with_satellites);
+    /// Compute the queued path effects together, update their shapes in the order they were queued,
+    /// and stop queueing.
+    void flushPathEffectUpdates();
+
     bool addResource(char const *key, SPObject *object);
     bool removeResource(char const *key, SPObject *object);
     std::vector<SPObject *> const getResourceList(char const *key);
@@ -385,6 +401,16 @@ private:
     bool modified_since_autosave = false;
     sigc::connection modified_connection;
     sigc::connection rerouting_connection;
+    bool _updated = false; ///< Has the document been updated once?
+    std::vector<SPText *> _text_layout_queue; ///< See queueTextLayout().
+    struct PathEffectUpdate
+    {
+        SPLPEItem *item;
+        bool write;
+        bool with_satellites;
+    };
+    bool _queue_path_effects = false; ///< See beginPathEffectUpdates().
+    std::vector<PathEffectUpdate> _path_effect_queue;
 
     // Document structure --------------------
     Inkscape::XML::Document *rdoc; ///< Our Inkscape::XML::Document
@@ -15,6 +15,8 @@
  */
 
 
+#include <algorithm>
+
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 
@@ -26,6 +28,7 @@
 #include "preferences.h"
 #include "rdf.h"
 
+#include "async/scheduler.h"
 #include "display/cairo-utils.h"
 #include "display/drawing-context.h"
 #include "display/drawing.h"
@@ -346,17 +349,34 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
     unsigned char *px = g_new(guchar, num_rows * stride);
 
-    cairo_surface_t *s = cairo_image_surface_create_for_data(
-        px, CAIRO_FORMAT_ARGB32, ebp->width, num_rows, stride);
-    Inkscape::DrawingContext dc(s, bbox.min());
-    dc.setSource(ebp->background);
-    dc.setOperator(CAIRO_OPERATOR_SOURCE);
-    dc.paint();
-    dc.setOperator(CAIRO_OPERATOR_OVER);
-
     /* Render */
-    ebp->drawing->render(dc, bbox, 0);
-    cairo_surface_destroy(s);
+    // The strip is split into columns which are rendered concurrently on the shared scheduler, at a
+    // lower priority than the canvas so that the UI stays responsive during long exports.
+    auto &scheduler = Inkscape::Async::Scheduler::get();
+    auto scope = Inkscape::Async::Scheduler::PriorityScope(Inkscape::Async::Priority::Export);
+    int const min_column_width = 64;
+    int const columns = std::clamp(static_cast<int>(ebp->width) / min_column_width, 1, scheduler.concurrency());
+    int const column_width = (ebp->width + columns - 1) / columns;
+
+    ebp->drawing->snapshot();
+    scheduler.parallel_for(0, columns, [&] (int i) {
+        int const x0 = i * column_width;
+        int const x1 = std::min<int>(x0 + column_width, ebp->width);
+        if (x0 >= x1) return;
+        auto const area = Geom::IntRect(x0, row, x1, row + num_rows);
+
+        cairo_surface_t *s = cairo_image_surface_create_for_data(
+            px + x0 * 4, CAIRO_FORMAT_ARGB32, x1 - x0, num_rows, stride);
+        Inkscape::DrawingContext dc(s, area.min());
+        dc.setSource(ebp->background);
+        dc.setOperator(CAIRO_OPERATOR_SOURCE);
+        dc.paint();
+        dc.setOperator(CAIRO_OPERATOR_OVER);
+
+        ebp->drawing->render(dc, area, 0);
+        cairo_surface_destroy(s);
+    });
+    ebp->drawing->unsnapshot();
 
     // PNG stores data as unpremultiplied big-endian RGBA, which means
     // it's identical to the GdkPixbuf format.
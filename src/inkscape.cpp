@@ -49,6 +49,7 @@
 #include "io/sys.h"
 
 #include "libnrtype/font-factory.h"
+#include "libnrtype/glyph-outline-cache.h"
 
 #include "object/sp-item-group.h"
 #include "object/sp-root.h"
@@ -314,6 +315,7 @@ Application::Application(bool use_gui) :
     for (auto &fontdir : fontdirs) {
         factory.AddFontsDir(fontdir.c_str());
     }
+    Inkscape::Text::GlyphOutlineCache::setEnabled(prefs->getBool("/options/font/glyph_outline_cache", false));
 }
 
 Application::~Application()
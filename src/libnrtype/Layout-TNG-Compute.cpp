@@ -10,12 +10,14 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <functional>
 #include <iomanip>
 
 #include "Layout-TNG.h"
 #include "style.h"
 #include "font-instance.h"
 #include "font-factory.h"
+#include "shaping-cache.h"
 #include "svg/svg-length.h"
 #include "object/sp-object.h"
 #include "object/sp-flowdiv.h"
@@ -67,6 +69,8 @@ class Layout::Calculator
     ScanlineMaker *_scanline_maker;
     unsigned _current_shape_index;     /// index into Layout::_input_wrap_shapes
     PangoContext *_pango_context;
+    PangoGravity _base_gravity;        /// set on _pango_context for itemization
+    PangoGravityHint _gravity_hint;
     Direction _block_progression;
 
     /**
@@ -86,6 +90,9 @@ class Layout::Calculator
     PANGO_SCALE. See FontFactory::FontFactory(). */
     double _font_factory_size_multiplier;
 
+    /** Taken from Layout::_reflow while flowing into shapes, null otherwise. */
+    std::unique_ptr<Reflow> _reflow;
+
     /** Temporary storage associated with each item in Layout::_input_stream. */
     struct InputItemInfo {
         bool in_sub_flow;
@@ -177,6 +184,7 @@ class Layout::Calculator
         std::vector<PangoItemInfo> pango_items;
         std::vector<PangoLogAttr> char_attributes;    ///< For every character in the paragraph.
         std::vector<UnbrokenSpan> unbroken_spans;
+        std::shared_ptr<ShapingCache::Paragraph const> shaping; ///< Where to look up and keep shaped runs.
 
         template<typename T> static void free_sequence(T &seq)
         {
@@ -192,6 +200,7 @@ class Layout::Calculator
             free_sequence(input_items);
             free_sequence(pango_items);
             free_sequence(unbroken_spans);
+            shaping.reset();
         }
     };
 
@@ -244,9 +253,17 @@ class Layout::Calculator
 
     void _buildPangoItemizationForPara(ParagraphInfo *para) const;
     static double _computeFontLineHeight( SPStyle const *style ); // Returns line_height_multiplier
+    void _shapeRun(ParagraphInfo const &para, unsigned pango_item_index, unsigned offset, unsigned length,
+                   PangoGlyphString *glyph_string) const;
     unsigned _buildSpansForPara(ParagraphInfo *para) const;
     bool _goToNextWrapShape();
     void _createFirstScanlineMaker();
+    ShapeScanlineMaker::ScanRunCache *_scanRunCache() const;
+
+    std::string _flowKey() const;
+    static std::size_t _hashInputItem(InputStreamItem *item);
+    unsigned _resumeReflow(std::vector<std::size_t> const &input_hashes, FontMetrics *line_box_height);
+    void _keepForReflow(std::vector<std::size_t> input_hashes);
 
     bool _findChunksForLine(ParagraphInfo const &para,
                             UnbrokenSpanPosition *start_span_pos,
@@ -288,7 +305,9 @@ class Layout::Calculator
 
 public:
     Calculator(Layout *text_flow)
-        : _flow(*text_flow) {}
+        : _flow(*text_flow)
+        , _base_gravity(PANGO_GRAVITY_AUTO)
+        , _gravity_hint(PANGO_GRAVITY_HINT_NATURAL) {}
 
     bool calculate();
 };
@@ -904,7 +923,11 @@ void Layout::Calculator::_outputLine(ParagraphInfo const &para,
                         } else {
                             // Upright orientation
 
-                            auto hb_font = pango_font_get_hb_font(font->get_font());
+                            hb_font_t *hb_font;
+                            {
+                                auto lock = FontFactory::get().lock();
+                                hb_font = pango_font_get_hb_font(font->get_font());
+                            }
 
 #ifdef DEBUG_GLYPH
                             std::cerr << "        Upright"
@@ -932,6 +955,7 @@ void Layout::Calculator::_outputLine(ParagraphInfo const &para,
                                     // calculated by shaper. We must undo this!
                                     PangoRectangle ink_rect;
                                     PangoRectangle logical_rect;
+                                    auto lock = FontFactory::get().lock();
                                     pango_font_get_glyph_extents (font->get_font(),
                                                                   new_glyph.glyph,
                                                                   &ink_rect,
@@ -1196,7 +1220,7 @@ void Layout::Calculator::_createFirstScanlineMaker()
         TRACE(("  wrapping disabled\n"));
     }
     else {
-        _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression);
+        _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression, _scanRunCache());
         TRACE(("  begin wrap shape 0\n"));
 
         // 'inline-size' uses an infinitely high (wide) shape. We must set initial y. (We only need to do it here as there is only one shape.)
@@ -1320,8 +1344,10 @@ void Layout::Calculator::BrokenSpan::setZero()
  * paragraph and stitch it together so that pango_itemize() can be called on
  * the whole thing.
  *
+ * The result is looked up in the shaping cache first, under a key made of everything it depends on.
+ *
  * Input: para.first_input_index.
- * Output: para.direction, para.pango_items, para.char_attributes.
+ * Output: para.direction, para.pango_items, para.char_attributes, para.shaping.
  * Returns: the number of spans created by pango_itemize
  */
 void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) const
@@ -1331,6 +1357,13 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
 
     TRACE(("itemizing para, first input %d\n", para->first_input_index));
 
+    std::string key;
+    auto const add_to_key = [&] (std::string_view field) {
+        key += std::to_string(field.size());
+        key += ':';
+        key += field;
+    };
+
     PangoAttrList *attributes_list = pango_attr_list_new();
     for (unsigned input_index = para->first_input_index ; input_index < _flow._input_stream.size() ; input_index++) {
         if (_flow._input_stream[input_index]->Type() == CONTROL_CODE) {
@@ -1352,11 +1385,19 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
             PangoAttribute *attribute_font_description = pango_attr_font_desc_new(font->get_descr());
             attribute_font_description->start_index = para->text.bytes();
 
+            auto const font_features = text_source->style->getFontFeatureString();
             PangoAttribute *attribute_font_features =
-                pango_attr_font_features_new( text_source->style->getFontFeatureString().c_str());
+                pango_attr_font_features_new(font_features.c_str());
             attribute_font_features->start_index = para->text.bytes();
             para->text.append(&*text_source->text_begin.base(), text_source->text_length);     // build the combined text
 
+            char *font_description = pango_font_description_to_string(font->get_descr());
+            add_to_key(font_description);
+            g_free(font_description);
+            add_to_key(font_features);
+            add_to_key(std::string_view(para->text.data() + attribute_font_features->start_index,
+                                        para->text.bytes() - attribute_font_features->start_index));
+
             attribute_font_description->end_index = para->text.bytes();
             pango_attr_list_insert(attributes_list, attribute_font_description);
 
@@ -1370,6 +1411,7 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
                 PangoAttribute *attribute_language = pango_attr_language_new( language );
                 pango_attr_list_insert(attributes_list, attribute_language);
             }
+            add_to_key(object->lang.raw());
         }
     }
 
@@ -1379,11 +1421,38 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
     // Pango Itemize
     GList *pango_items_glist = nullptr;
     para->direction = LEFT_TO_RIGHT; // CSS default
-    if (_flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE) {
+    bool const base_dir = _flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE;
+    PangoDirection pango_direction = PANGO_DIRECTION_NEUTRAL;
+    if (base_dir) {
         Layout::InputStreamTextSource const *text_source = static_cast<Layout::InputStreamTextSource *>(_flow._input_stream[para->first_input_index]);
 
-        para->direction =                (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
-        PangoDirection pango_direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
+        para->direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
+        pango_direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
+    }
+
+    add_to_key(std::to_string(pango_direction) + ',' + std::to_string(_base_gravity) + ',' + std::to_string(_gravity_hint));
+    auto &cache = ShapingCache::get();
+    if (auto shaping = cache.lookup(key)) {
+        pango_attr_list_unref(attributes_list);
+        para->pango_items.reserve(shaping->items.size());
+        for (std::size_t i = 0; i < shaping->items.size(); i++) {
+            PangoItemInfo new_item;
+            new_item.item = pango_item_copy(shaping->items[i]);
+            new_item.font = shaping->fonts[i];
+            para->pango_items.push_back(new_item);
+        }
+        para->char_attributes = shaping->char_attributes;
+        para->shaping = std::move(shaping);
+        TRACE(("para itemization found in cache, %lu sections\n", para->pango_items.size()));
+        return;
+    }
+
+    // The context is shared by all layouts, which may be calculated concurrently.
+    auto lock = FontFactory::get().lock();
+    pango_context_set_base_gravity(_pango_context, _base_gravity);
+    pango_context_set_gravity_hint(_pango_context, _gravity_hint);
+
+    if (base_dir) {
         pango_items_glist = pango_itemize_with_base_dir(_pango_context, pango_direction, para->text.data(), 0, para->text.bytes(), attributes_list, nullptr);
     }
 
@@ -1406,6 +1475,7 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
         para->pango_items.push_back(new_item);
     }
     g_list_free(pango_items_glist);
+    lock.unlock();
 
     // and get the character attributes on everything
     para->char_attributes.resize(para->text.length() + 1);
@@ -1415,6 +1485,15 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
     // This breaks Inkscape's multiline text (i.e. sodipodi:role line).
     para->char_attributes[para->text.length()].is_mandatory_break = 0;
 
+    auto shaping = std::make_shared<ShapingCache::Paragraph>();
+    for (auto const &item : para->pango_items) {
+        shaping->items.push_back(pango_item_copy(item.item));
+        shaping->fonts.push_back(item.font);
+    }
+    shaping->char_attributes = para->char_attributes;
+    para->shaping = shaping;
+    cache.insert(std::move(key), std::move(shaping));
+
     TRACE(("end para itemize, direction = %d\n", para->direction));
 }
 
@@ -1449,6 +1528,74 @@ bool compareGlyphWidth(const PangoGlyphInfo &a, const PangoGlyphInfo &b)
 }
 
 
+/**
+ * Convert the characters of a run of the paragraph to glyphs, in logical order.
+ *
+ * Input: para.text, para.pango_items
+ * Output: glyph_string
+ */
+/* Notes as of 4/29/13.  Pango_shape is not generating English language ligatures, but it is generating
+them for Hebrew (and probably other similar languages).  In the case observed 3 unicode characters (a base
+and 2 Mark, nonspacings) are merged into two glyphs (the base + first Mn, the 2nd Mn).  All of these map
+from glyph to first character of the log_cluster range.  This destroys the 1:1 correspondence between
+characters and glyphs.  A big chunk of the conditional code which immediately follows this call
+is there to clean up the resulting mess.
+*/
+void Layout::Calculator::_shapeRun(ParagraphInfo const &para, unsigned pango_item_index, unsigned offset,
+                                   unsigned length, PangoGlyphString *glyph_string) const
+{
+    // Convert characters to glyphs
+    auto lock = FontFactory::get().lock();
+    pango_shape_full(para.text.data() + offset,
+                     length,
+                     para.text.data(),
+                     -1,
+                     &para.pango_items[pango_item_index].item->analysis,
+                     glyph_string);
+    lock.unlock();
+
+    if (para.pango_items[pango_item_index].item->analysis.level & 1) {
+        // Right to left text (Arabic, Hebrew, etc.)
+
+        // pango_shape() will reorder glyphs in rtl sections into visual order
+        // (start offsets in accending order) which messes us up because the svg
+        // spec requires us to draw glyphs in logical order so let's reverse the
+        // glyphstring.
+
+        const unsigned nglyphs = glyph_string->num_glyphs;
+        std::vector<PangoGlyphInfo> infos(nglyphs);
+        std::vector<gint>           clusters(nglyphs);
+
+        for (int i = 0; i < nglyphs; ++i) {
+            std::copy(&glyph_string->glyphs[i],       &glyph_string->glyphs[i+1],       infos.end() - i - 1);
+            std::copy(&glyph_string->log_clusters[i], &glyph_string->log_clusters[i+1], clusters.end() - i - 1);
+        }
+
+        std::copy(infos.begin(), infos.end(), glyph_string->glyphs);
+        std::copy(clusters.begin(), clusters.end(), glyph_string->log_clusters);
+
+        // We've messed up the flag that tells a glyph it is first in a cluster.
+        for (int i = 0; i < nglyphs; ++i) {
+
+            // Set flag for start of cluster, we skip all other glyphs in cluster below.
+            glyph_string->glyphs[i].attr.is_cluster_start = 1;
+
+            // Find index of first glyph in next cluster
+            int j = i + 1;
+            while( (j < nglyphs) &&
+                   (glyph_string->log_clusters[j] == glyph_string->log_clusters[i])
+                ) {
+                glyph_string->glyphs[j].attr.is_cluster_start = 0; // Zero
+                j++;
+            }
+
+            // Move on to next cluster.
+            i = j;
+        }
+
+    } // End right to left text.
+}
+
 /**
  * Split the paragraph into spans. Also call pango_shape() on them.
  *
@@ -1588,7 +1735,6 @@ unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
                 // now we know the length, do some final calculations and add the UnbrokenSpan to the list
                 new_span.font_size = text_source->style->font_size.computed * _flow.getTextLengthMultiplierDue();
                 if (new_span.text_bytes) {
-                    new_span.glyph_string = pango_glyph_string_new();
                     /* Some assertions intended to help diagnose bug #1277746. */
                     g_assert( 0 < new_span.text_bytes );
                     g_assert( span_start_byte_in_source < text_source->text->bytes() );
@@ -1596,67 +1742,23 @@ unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
                     g_assert( memchr(text_source->text->data() + span_start_byte_in_source, '\0', static_cast<size_t>(new_span.text_bytes))
                               == nullptr );
 
-                    /* Notes as of 4/29/13.  Pango_shape is not generating English language ligatures, but it is generating
-                    them for Hebrew (and probably other similar languages).  In the case observed 3 unicode characters (a base
-                    and 2 Mark, nonspacings) are merged into two glyphs (the base + first Mn, the 2nd Mn).  All of these map
-                    from glyph to first character of the log_cluster range.  This destroys the 1:1 correspondence between
-                    characters and glyphs.  A big chunk of the conditional code which immediately follows this call
-                    is there to clean up the resulting mess.
-                    */
-
                     // Assumption: old and new arguments are the same.
                     auto gold = std::string_view(text_source->text->data() + span_start_byte_in_source, new_span.text_bytes);
                     auto gnew = std::string_view(para->text.data()         + para_text_index,           new_span.text_bytes);
                     assert (gold == gnew);
 
-                    // Convert characters to glyphs
-                    pango_shape_full(para->text.data() + para_text_index,
-                                     new_span.text_bytes,
-                                     para->text.data(),
-                                     -1,
-                                     &para->pango_items[pango_item_index].item->analysis,
-                                     new_span.glyph_string);
-
-                    if (para->pango_items[pango_item_index].item->analysis.level & 1) {
-                        // Right to left text (Arabic, Hebrew, etc.)
-
-                        // pango_shape() will reorder glyphs in rtl sections into visual order
-                        // (start offsets in accending order) which messes us up because the svg
-                        // spec requires us to draw glyphs in logical order so let's reverse the
-                        // glyphstring.
-
-                        const unsigned nglyphs = new_span.glyph_string->num_glyphs;
-                        std::vector<PangoGlyphInfo> infos(nglyphs);
-                        std::vector<gint>           clusters(nglyphs);
-
-                        for (int i = 0; i < nglyphs; ++i) {
-                            std::copy(&new_span.glyph_string->glyphs[i],       &new_span.glyph_string->glyphs[i+1],       infos.end() - i - 1);
-                            std::copy(&new_span.glyph_string->log_clusters[i], &new_span.glyph_string->log_clusters[i+1], clusters.end() - i - 1);
-                        }
-
-                        std::copy(infos.begin(), infos.end(), new_span.glyph_string->glyphs);
-                        std::copy(clusters.begin(), clusters.end(), new_span.glyph_string->log_clusters);
-
-                        // We've messed up the flag that tells a glyph it is first in a cluster.
-                        for (int i = 0; i < nglyphs; ++i) {
-
-                            // Set flag for start of cluster, we skip all other glyphs in cluster below.
-                            new_span.glyph_string->glyphs[i].attr.is_cluster_start = 1;
-
-                            // Find index of first glyph in next cluster
-                            int j = i + 1;
-                            while( (j < nglyphs) &&
-                                   (new_span.glyph_string->log_clusters[j] == new_span.glyph_string->log_clusters[i])
-                                ) {
-                                new_span.glyph_string->glyphs[j].attr.is_cluster_start = 0; // Zero
-                                j++;
-                            }
-
-                            // Move on to next cluster.
-                            i = j;
+                    // Convert characters to glyphs, unless the same run of the same paragraph was shaped before.
+                    auto &cache = ShapingCache::get();
+                    if (para->shaping) {
+                        new_span.glyph_string = cache.lookupGlyphs(*para->shaping, para_text_index, new_span.text_bytes);
+                    }
+                    if (!new_span.glyph_string) {
+                        new_span.glyph_string = pango_glyph_string_new();
+                        _shapeRun(*para, pango_item_index, para_text_index, new_span.text_bytes, new_span.glyph_string);
+                        if (para->shaping) {
+                            cache.insertGlyphs(*para->shaping, para_text_index, new_span.text_bytes, new_span.glyph_string);
                         }
-
-                    } // End right to left text.
+                    }
 
                     //  The following sorting doesn't seem to be necessary, and causes
                     //  https://gitlab.com/inkscape/inkscape/-/issues/394 ...
@@ -1791,7 +1893,7 @@ bool Layout::Calculator::_goToNextWrapShape()
     _scanline_maker = nullptr;
 
     if (_current_shape_index < _flow._input_wrap_shapes.size()) {
-        _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression);
+        _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression, _scanRunCache());
         TRACE(("begin wrap shape %u\n", _current_shape_index));
         return true;
     } else {
@@ -1809,6 +1911,196 @@ bool Layout::Calculator::_goToNextWrapShape()
     // Shouldn't reach
 }
 
+/**
+ * The scan runs already found in the current wrap shape, or null if they are not kept.
+ */
+Layout::ShapeScanlineMaker::ScanRunCache *Layout::Calculator::_scanRunCache() const
+{
+    if (!_reflow || _current_shape_index >= _reflow->scan_runs.size())
+        return nullptr;
+    return &_reflow->scan_runs[_current_shape_index];
+}
+
+/**
+ * Everything the flow as a whole depends on, apart from the input stream:
+ * the wrap shapes, the strut, the gravity and so on. Nothing
+ * of the last calculation is reused if any of these changed.
+ */
+std::string Layout::Calculator::_flowKey() const
+{
+    std::string key;
+    auto const add = [&key] (auto const &value) {
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    };
+
+    for (auto const &wrap_shape : _flow._input_wrap_shapes) {
+        Shape const *shape = wrap_shape.shape;
+        add(wrap_shape.display_align);
+        add(shape->numberOfPoints());
+        for (int i = 0 ; i < shape->numberOfPoints() ; i++) {
+            add(shape->getPoint(i).x[Geom::X]);
+            add(shape->getPoint(i).x[Geom::Y]);
+        }
+        add(shape->numberOfEdges());
+        for (int i = 0 ; i < shape->numberOfEdges() ; i++) {
+            add(shape->getEdge(i).st);
+            add(shape->getEdge(i).en);
+        }
+    }
+
+    add(_flow.wrap_mode);
+    add(_block_progression);
+    add(_base_gravity);
+    add(_gravity_hint);
+    add(_font_factory_size_multiplier);
+    add(_flow.strut.ascent);
+    add(_flow.strut.descent);
+    add(_flow.strut.xheight);
+    add(_flow.strut.ascent_max);
+    add(_flow.strut.descent_max);
+    // Not textLength: text with a length target is always laid out from scratch.
+    return key;
+}
+
+/**
+ * A hash of everything the layout of an input item depends on: its text,
+ * its style and its attributes.
+ */
+std::size_t Layout::Calculator::_hashInputItem(InputStreamItem *item)
+{
+    std::string key;
+    auto const add = [&key] (auto const &value) {
+        key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    };
+
+    add(item->Type());
+    if (item->Type() == CONTROL_CODE) {
+        auto const control_code = static_cast<InputStreamControlCode const *>(item);
+        add(control_code->code);
+        add(control_code->ascent);
+        add(control_code->descent);
+        add(control_code->width);
+    } else {
+        auto const text_source = static_cast<InputStreamTextSource const *>(item);
+        add(text_source->text_length);
+        key.append(text_source->text_begin.base(), text_source->text_end.base());
+
+        // Inherited values are written out as 'inherit', so add the computed values used here.
+        SPStyle const *style = text_source->style;
+        key += style->write(SP_STYLE_FLAG_ALWAYS).raw();
+        add(style->font_size.computed);
+        add(style->line_height.computed);
+        add(style->letter_spacing.computed);
+        add(style->word_spacing.computed);
+        add(style->text_indent.computed);
+        add(style->baseline_shift.computed);
+
+        for (auto const *lengths : {&text_source->x, &text_source->y, &text_source->dx, &text_source->dy, &text_source->rotate}) {
+            add(lengths->size());
+            for (auto const &length : *lengths) {
+                add(length._set);
+                add(length.computed);
+            }
+        }
+        add(text_source->textLength._set);
+        add(text_source->textLength.computed);
+        add(text_source->lengthAdjust);
+        key += text_source->lang.raw();
+    }
+    return std::hash<std::string>()(key);
+}
+
+/**
+ * Copies to the output what the last calculation output for the leading
+ * paragraphs whose input items are all unchanged, and puts the scanline
+ * maker back where the paragraph after them started.
+ *
+ * Input: the hashes of the items of the input stream.
+ * Output: line_box_height as it was at the start of that paragraph.
+ * Returns: the index of the first input item of the paragraph to carry on from, or 0.
+ */
+unsigned Layout::Calculator::_resumeReflow(std::vector<std::size_t> const &input_hashes, FontMetrics *line_box_height)
+{
+    auto const &old_hashes = _reflow->input_hashes;
+    unsigned const unchanged = std::mismatch(old_hashes.begin(), old_hashes.end(),
+                                             input_hashes.begin(), input_hashes.end()).first - old_hashes.begin();
+
+    // Whether a paragraph is the last one changes its output, so there must be
+    // input left after the ones reused.
+    auto &checkpoints = _reflow->checkpoints;
+    auto it = std::find_if(checkpoints.rbegin(), checkpoints.rend(), [&] (Reflow::Checkpoint const &checkpoint) {
+        return checkpoint.first_input_index <= unchanged && checkpoint.first_input_index < input_hashes.size();
+    });
+    if (it == checkpoints.rend() || it->first_input_index == 0) {
+        checkpoints.clear();
+        return 0;
+    }
+    Reflow::Checkpoint const checkpoint = *it;
+    checkpoints.erase(std::prev(it.base()), checkpoints.end());   // added again as the paragraph is laid out
+    TRACE(("reusing %u paragraphs, carrying on from input %u\n", checkpoint.paragraphs, checkpoint.first_input_index));
+
+    _flow._paragraphs.assign(_reflow->paragraphs.begin(), _reflow->paragraphs.begin() + checkpoint.paragraphs);
+    _flow._lines.assign(_reflow->lines.begin(), _reflow->lines.begin() + checkpoint.lines);
+    _flow._chunks.assign(_reflow->chunks.begin(), _reflow->chunks.begin() + checkpoint.chunks);
+    _flow._spans.assign(_reflow->spans.begin(), _reflow->spans.begin() + checkpoint.spans);
+    _flow._characters.assign(_reflow->characters.begin(), _reflow->characters.begin() + checkpoint.characters);
+    _flow._glyphs.assign(_reflow->glyphs.begin(), _reflow->glyphs.begin() + checkpoint.glyphs);
+
+    for (unsigned span_index = 0 ; span_index < checkpoint.spans ; span_index++) {
+        auto const [input_index, offset] = _reflow->span_first_characters[span_index];
+        if (input_index < 0) {
+            _flow._spans[span_index].input_stream_first_character = Glib::ustring::const_iterator();
+        } else {
+            auto const text_source = static_cast<InputStreamTextSource const *>(_flow._input_stream[input_index]);
+            _flow._spans[span_index].input_stream_first_character = Glib::ustring::const_iterator(text_source->text_begin.base() + offset);
+        }
+    }
+
+    _current_shape_index = checkpoint.shape_index;
+    delete _scanline_maker;
+    _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression, _scanRunCache());
+    _scanline_maker->setNewYCoordinate(checkpoint.y);
+    _y_offset = checkpoint.y_offset;
+    *line_box_height = checkpoint.line_box_height;
+    return checkpoint.first_input_index;
+}
+
+/**
+ * Keeps the output up to the last paragraph that can be reused, and the
+ * hashes of the input items, for the next calculation. Hands #_reflow back
+ * to the layout.
+ */
+void Layout::Calculator::_keepForReflow(std::vector<std::size_t> input_hashes)
+{
+    _reflow->input_hashes = std::move(input_hashes);
+
+    Reflow::Checkpoint last = {};
+    if (!_reflow->checkpoints.empty())
+        last = _reflow->checkpoints.back();
+    _reflow->paragraphs.assign(_flow._paragraphs.begin(), _flow._paragraphs.begin() + last.paragraphs);
+    _reflow->lines.assign(_flow._lines.begin(), _flow._lines.begin() + last.lines);
+    _reflow->chunks.assign(_flow._chunks.begin(), _flow._chunks.begin() + last.chunks);
+    _reflow->spans.assign(_flow._spans.begin(), _flow._spans.begin() + last.spans);
+    _reflow->characters.assign(_flow._characters.begin(), _flow._characters.begin() + last.characters);
+    _reflow->glyphs.assign(_flow._glyphs.begin(), _flow._glyphs.begin() + last.glyphs);
+
+    // The span ending a paragraph is a copy of the one before it and points into its text.
+    _reflow->span_first_characters.clear();
+    _reflow->span_first_characters.reserve(last.spans);
+    std::pair<int, std::size_t> first_character(-1, 0);
+    for (unsigned span_index = 0 ; span_index < last.spans ; span_index++) {
+        Span const &span = _flow._spans[span_index];
+        if (_flow._input_stream[span.in_input_stream_item]->Type() == TEXT_SOURCE) {
+            auto const text_source = static_cast<InputStreamTextSource const *>(_flow._input_stream[span.in_input_stream_item]);
+            first_character = std::make_pair(static_cast<int>(span.in_input_stream_item),
+                                             static_cast<std::size_t>(span.input_stream_first_character.base() - text_source->text_begin.base()));
+        }
+        _reflow->span_first_characters.push_back(first_character);
+    }
+
+    _flow._reflow = std::move(_reflow);
+}
+
 /**
  * Given \a para filled in and \a start_span_pos set, keeps trying to
  * find somewhere it can fit the next line of text. The process of finding
@@ -2127,35 +2419,58 @@ bool Layout::Calculator::calculate()
         // Vertical text, CJK
         switch (_flow._blockTextOrientation()) {
             case SP_CSS_TEXT_ORIENTATION_MIXED:
-                pango_context_set_base_gravity(_pango_context, PANGO_GRAVITY_EAST);
-                pango_context_set_gravity_hint(_pango_context, PANGO_GRAVITY_HINT_NATURAL);
+                _base_gravity = PANGO_GRAVITY_EAST;
+                _gravity_hint = PANGO_GRAVITY_HINT_NATURAL;
                 break;
             case SP_CSS_TEXT_ORIENTATION_UPRIGHT:
-                pango_context_set_base_gravity(_pango_context, PANGO_GRAVITY_EAST);
-                pango_context_set_gravity_hint(_pango_context, PANGO_GRAVITY_HINT_STRONG);
+                _base_gravity = PANGO_GRAVITY_EAST;
+                _gravity_hint = PANGO_GRAVITY_HINT_STRONG;
                 break;
             case SP_CSS_TEXT_ORIENTATION_SIDEWAYS:
-                pango_context_set_base_gravity(_pango_context, PANGO_GRAVITY_SOUTH);
-                pango_context_set_gravity_hint(_pango_context, PANGO_GRAVITY_HINT_STRONG);
+                _base_gravity = PANGO_GRAVITY_SOUTH;
+                _gravity_hint = PANGO_GRAVITY_HINT_STRONG;
                 break;
             default:
                 std::cerr << "Layout::Calculator: Unhandled text orientation!" << std::endl;
         }
     } else {
         // Horizontal text
-        pango_context_set_base_gravity(_pango_context, PANGO_GRAVITY_AUTO);
-        pango_context_set_gravity_hint(_pango_context, PANGO_GRAVITY_HINT_NATURAL);
+        _base_gravity = PANGO_GRAVITY_AUTO;
+        _gravity_hint = PANGO_GRAVITY_HINT_NATURAL;
     }
 
     // Minimum line box height determined by block container.
     FontMetrics strut_height = _flow.strut;
     _y_offset = 0.0;
+
+    // Text flowed into shapes is laid out again from the first paragraph whose input changed.
+    std::vector<std::size_t> input_hashes;
+    _reflow = std::move(_flow._reflow);
+    if (_flow._input_wrap_shapes.empty() || _flow.textLength._set) {
+        // The adjustment for textLength depends on the length of the whole text, so with it no
+        // paragraph can be kept from the previous calculation, nor from the first of the two
+        // passes calculateFlow() makes.
+        _reflow.reset();
+    } else {
+        std::string flow_key = _flowKey();
+        if (!_reflow || _reflow->flow_key != flow_key) {
+            _reflow = std::make_unique<Reflow>();
+            _reflow->flow_key = std::move(flow_key);
+            _reflow->scan_runs.resize(_flow._input_wrap_shapes.size());
+        }
+        input_hashes.reserve(_flow._input_stream.size());
+        for (auto const &item : _flow._input_stream) {
+            input_hashes.push_back(_hashInputItem(item));
+        }
+    }
+
     _createFirstScanlineMaker();
 
     ParagraphInfo para;
     FontMetrics line_box_height; // Current value of line box height for line.
     bool keep_going = true; // Set false if we ran out of space and had to stash overflow.
-    for(para.first_input_index = 0 ; para.first_input_index < _flow._input_stream.size() ; ) {
+    para.first_input_index = _reflow ? _resumeReflow(input_hashes, &line_box_height) : 0;
+    for( ; para.first_input_index < _flow._input_stream.size() ; ) {
 
         // jump to the next wrap shape if this is a SHAPE_BREAK control code
         if (_flow._input_stream[para.first_input_index]->Type() == CONTROL_CODE) {
@@ -2169,6 +2484,22 @@ bool Layout::Calculator::calculate()
             }
         }
 
+        if (_reflow && keep_going) {
+            Reflow::Checkpoint checkpoint;
+            checkpoint.first_input_index = para.first_input_index;
+            checkpoint.shape_index = _current_shape_index;
+            checkpoint.y = _scanline_maker->yCoordinate();
+            checkpoint.y_offset = _y_offset;
+            checkpoint.line_box_height = line_box_height;
+            checkpoint.paragraphs = _flow._paragraphs.size();
+            checkpoint.lines = _flow._lines.size();
+            checkpoint.chunks = _flow._chunks.size();
+            checkpoint.spans = _flow._spans.size();
+            checkpoint.characters = _flow._characters.size();
+            checkpoint.glyphs = _flow._glyphs.size();
+            _reflow->checkpoints.push_back(checkpoint);
+        }
+
         // Break things up into little pango units with unique direction, gravity, etc.
         _buildPangoItemizationForPara(&para);
 
@@ -2320,6 +2651,10 @@ bool Layout::Calculator::calculate()
         _flow.textLengthIncrement = difference / (_flow._characters.size() == 1? 1 : _flow._characters.size() - 1);
     }
 
+    if (_reflow) {
+        _keepForReflow(std::move(input_hashes));
+    }
+
     return true;
 }
 
@@ -14,6 +14,9 @@
 
 #include <vector>
 #include <cmath>
+#include <map>
+#include <string>
+#include <utility>
 #include "libnrtype/Layout-TNG.h"
 
 class Shape;
@@ -125,12 +128,16 @@ private:
 
 This is the 'perfect', and hence slowest, implementation of a
 Layout::ScanlineMaker, which will return exact bounds for any given
-input shape.
+input shape. Given a \a cache, the runs found for each line top and
+height are kept in it and looked up there first.
 */
 class Layout::ShapeScanlineMaker : public Layout::ScanlineMaker
 {
 public:
-    ShapeScanlineMaker(Shape const *shape, Layout::Direction block_progression);
+    /// Scan runs by top of the line (in rotated coordinates) and line height.
+    typedef std::map<std::pair<float, float>, std::vector<ScanRun>> ScanRunCache;
+
+    ShapeScanlineMaker(Shape const *shape, Layout::Direction block_progression, ScanRunCache *cache = nullptr);
     ~ShapeScanlineMaker() override;
 
     std::vector<ScanRun> makeScanline(Layout::FontMetrics const &line_height) override;
@@ -150,6 +157,9 @@ public:
     void setLineHeight(Layout::FontMetrics const &line_height) override;
 
 private:
+    /** Rasterizes the shape for a line of the given height at the current y. */
+    std::vector<ScanRun> _scan(float line_text_height);
+
     /** To generate scanlines for top-to-bottom text it is easiest if we
     simply rotate the given shape by a multiple of 90 degrees. This stores
     that. If no rotation was needed we can simply store the pointer we were
@@ -167,6 +177,55 @@ private:
     float _current_line_height;
 
     bool _negative_block_progression;     /// if true, indicates that completeLine() should decrement rather than increment, ie block-progression is either rl or bt
+
+    ScanRunCache *_cache;
+};
+
+/** \brief private to Layout. What is kept of the last flow into shapes.
+
+Typing in flowed text makes the whole flow be calculated again on every
+keystroke. This keeps, from one calculation to the next, the scan runs
+found in each wrap shape, the output and a hash of each input item, and
+the state of the calculator at the start of each paragraph. The next
+calculation copies the output of the leading paragraphs whose input is
+unchanged and carries on from the first one that changed. Everything is
+dropped when the shapes, or anything else the whole flow depends on,
+change. See Layout::Calculator::calculate().
+*/
+struct Layout::Reflow
+{
+    /// The wrap shapes, strut, text length adjustment etc. of the flow this was kept from.
+    std::string flow_key;
+
+    /// One cache per wrap shape.
+    std::vector<ShapeScanlineMaker::ScanRunCache> scan_runs;
+
+    /// The state of the calculator before laying out a paragraph.
+    struct Checkpoint
+    {
+        unsigned first_input_index;
+        unsigned shape_index;
+        double y;                      /// as returned by ScanlineMaker::yCoordinate()
+        double y_offset;
+        FontMetrics line_box_height;
+        /// Sizes of the output vectors.
+        unsigned paragraphs, lines, chunks, spans, characters, glyphs;
+    };
+    std::vector<Checkpoint> checkpoints;
+
+    std::vector<std::size_t> input_hashes;
+
+    std::vector<Paragraph> paragraphs;
+    std::vector<Line> lines;
+    std::vector<Chunk> chunks;
+    std::vector<Span> spans;
+    std::vector<Character> characters;
+    std::vector<Glyph> glyphs;
+
+    /** Where Span::input_stream_first_character of each span pointed: the input item
+    whose text it is in (or -1 if it pointed nowhere) and the byte offset from the
+    item's text_begin, since the input stream is rebuilt between calculations. */
+    std::vector<std::pair<int, std::size_t>> span_first_characters;
 };
 
 } // namespace Text
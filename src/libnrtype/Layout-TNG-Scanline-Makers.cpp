@@ -77,7 +77,8 @@ void Layout::InfiniteScanlineMaker::setLineHeight(Layout::FontMetrics const &lin
 
 // *********************** real shapes version
 
-Layout::ShapeScanlineMaker::ShapeScanlineMaker(Shape const *shape, Layout::Direction block_progression)
+Layout::ShapeScanlineMaker::ShapeScanlineMaker(Shape const *shape, Layout::Direction block_progression, ScanRunCache *cache)
+    : _cache(cache)
 {
     if (block_progression == TOP_TO_BOTTOM) {
         _rotated_shape = const_cast<Shape*>(shape);
@@ -121,14 +122,31 @@ std::vector<Layout::ScanlineMaker::ScanRun> Layout::ShapeScanlineMaker::makeScan
     if (_y < _bounding_box_top)
         _y = _bounding_box_top;
 
-    FloatLigne line_rasterization;
-    FloatLigne line_decent_length_runs;
     float line_text_height = (float)(line_height.emSize());
     if (line_text_height < 0.001)
         line_text_height = 0.001;     // Scan() doesn't work for zero height so this will have to do
 
     _current_line_height = (float)line_height.emSize();
 
+    if (!_cache)
+        return _scan(line_text_height);
+
+    // the runs only depend on where the line is, not on how the rasterizer got there
+    auto const key = std::make_pair(_y, line_text_height);
+    auto it = _cache->find(key);
+    if (it == _cache->end()) {
+        if (_cache->size() >= 4096)
+            _cache->clear();   // lines at every height and position tried since the shape last changed
+        it = _cache->emplace(key, _scan(line_text_height)).first;
+    }
+    return it->second;
+}
+
+std::vector<Layout::ScanlineMaker::ScanRun> Layout::ShapeScanlineMaker::_scan(float line_text_height)
+{
+    FloatLigne line_rasterization;
+    FloatLigne line_decent_length_runs;
+
     // I think what's going on here is that we're moving the top of the scanline to the given position...
     _rotated_shape->Scan(_rasterizer_y, _current_rasterization_point, _y, line_text_height);
     // ...then actually retrieving the scanline (which alters the first two parameters)
@@ -10,6 +10,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 #include "Layout-TNG.h"
+#include "Layout-TNG-Scanline-Maker.h"
 
 namespace Inkscape {
 namespace Text {
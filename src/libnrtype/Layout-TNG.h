@@ -795,6 +795,11 @@ private:
     };
     std::vector<InputWrapShape> _input_wrap_shapes;
 
+    /** Kept between calculations of flowed text so that the next one can
+    reuse what has not changed. See Layout::Reflow. */
+    struct Reflow;
+    std::unique_ptr<Reflow> _reflow;
+
     // ******************* output
 
     /** as passed to fitToPathAlign() */
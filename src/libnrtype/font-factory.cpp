@@ -33,7 +33,9 @@
 
 #include "libnrtype/font-factory.h"
 #include "libnrtype/font-instance.h"
+#include "libnrtype/font-metadata-cache.h"
 #include "libnrtype/OpenTypeUtil.h"
+#include "libnrtype/shaping-cache.h"
 
 #include "util/statics.h"
 
@@ -214,6 +216,9 @@ FontFactory::FontFactory()
 #else
     pango_ft2_font_map_set_default_substitute(PANGO_FT2_FONT_MAP(fontServer), FactorySubstituteFunc, this, nullptr);
 #endif
+
+    // Font instances use it from any thread, so it must exist beforehand. This also makes it outlive us.
+    Inkscape::Text::FontMetadataCache::get();
 }
 
 FontFactory::~FontFactory()
@@ -427,6 +432,13 @@ GList *FontFactory::GetUIStyles(PangoFontFamily *in)
         return ret;
     }
 
+    // Listed by an earlier session, or earlier in this one.
+    auto &metadata = Inkscape::Text::FontMetadataCache::get();
+    std::string const family = pango_font_family_get_name(in);
+    if (auto styles = metadata.lookupStyles(family)) {
+        return styles;
+    }
+
     pango_font_family_list_faces(in, &faces, &numFaces);
 
     for (int currentFace = 0; currentFace < numFaces; currentFace++) {
@@ -509,6 +521,7 @@ GList *FontFactory::GetUIStyles(PangoFontFamily *in)
 
     // Sort the style lists
     ret = g_list_sort( ret, StyleNameCompareInternalGlib );
+    metadata.insertStyles(family, ret);
     return ret;
 }
 
@@ -590,6 +603,8 @@ std::shared_ptr<FontInstance> FontFactory::FaceFromFontSpecification(char const
 
 std::shared_ptr<FontInstance> FontFactory::Face(PangoFontDescription *descr, bool canFail)
 {
+    auto lock = std::lock_guard(mutex);
+
     // Mandatory huge size (hinting workaround).
     pango_font_description_set_size(descr, fontSize * PANGO_SCALE);
 
@@ -686,6 +701,8 @@ void FontFactory::AddFontsDir(char const *utf8dir)
     if (res == FcTrue) {
         g_info("Fonts dir '%s' added successfully.", utf8dir);
         pango_fc_font_map_config_changed(PANGO_FC_FONT_MAP(fontServer));
+        Inkscape::Text::ShapingCache::get().clear();
+        Inkscape::Text::FontMetadataCache::get().configChanged();
     } else {
         g_warning("Could not add fonts dir '%s'.", utf8dir);
     }
@@ -713,6 +730,8 @@ void FontFactory::AddFontFile(char const *utf8file)
     if (res == FcTrue) {
         g_info("Font file '%s' added successfully.", utf8file);
         pango_fc_font_map_config_changed(PANGO_FC_FONT_MAP(fontServer));
+        Inkscape::Text::ShapingCache::get().clear();
+        Inkscape::Text::FontMetadataCache::get().configChanged();
     } else {
         g_warning("Could not add font file '%s'.", utf8file);
     }
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <mutex>
 
 #include <pango/pango.h>
 #include "style.h"
@@ -96,10 +97,15 @@ public:
 
     PangoContext *get_font_context() const { return fontContext; }
 
+    /// Hold while using the font context, or Pango fonts and glyph strings, from a thread that
+    /// may run concurrently with others doing the same. The Face() functions take it themselves.
+    std::unique_lock<std::recursive_mutex> lock() { return std::unique_lock(mutex); }
+
 private:
     // Pango data. Backend-specific structures are cast to these opaque types.
     PangoFontMap *fontServer;
     PangoContext *fontContext;
+    std::recursive_mutex mutex;
 
     // A hashmap of all the loaded font instances, indexed by their PangoFontDescription.
     // Note: Since pango already does that, using the PangoFont could work too.
@@ -36,9 +36,26 @@
 #include <2geom/path-sink.h>
 #include "libnrtype/font-glyph.h"
 #include "libnrtype/font-instance.h"
+#include "libnrtype/font-metadata-cache.h"
+#include "libnrtype/glyph-outline-cache.h"
 
 #include "display/cairo-utils.h"  // Inkscape::Pixbuf
 
+// The file and face index the font was loaded from, if known to fontconfig.
+static std::pair<char const *, int> get_font_file(PangoFont *p_font)
+{
+#if PANGO_VERSION_CHECK(1,48,0)
+    auto pattern = pango_fc_font_get_pattern(PANGO_FC_FONT(p_font));
+#else
+    auto pattern = PANGO_FC_FONT(p_font)->font_pattern;
+#endif
+    FcChar8 *file = nullptr;
+    int index = 0;
+    FcPatternGetString(pattern, FC_FILE, 0, &file);
+    FcPatternGetInteger(pattern, FC_INDEX, 0, &index);
+    return {reinterpret_cast<char const *>(file), index};
+}
+
 /*
  * Outline extraction
  */
@@ -261,6 +278,11 @@ void FontInstance::init_face()
     }
 
 #endif // FreeType
+
+    // Opened once the variation coordinates are set, as the outlines depend on them.
+    if (auto const [file, index] = get_font_file(p_font); file) {
+        data->outlines = Inkscape::Text::GlyphOutlineCache::open(file, index, pango_font_description_get_variations(descr));
+    }
 }
 
 // Internal function to find baselines
@@ -390,6 +412,8 @@ FontGlyph const *FontInstance::LoadGlyph(int glyph_id)
         return nullptr; // bitmap font
     }
 
+    auto lock = std::lock_guard(mutex);
+
     if (auto it = data->glyphs.find(glyph_id); it != data->glyphs.end()) {
         return it->second.get(); // already loaded
     }
@@ -397,6 +421,10 @@ FontGlyph const *FontInstance::LoadGlyph(int glyph_id)
     Geom::PathBuilder path_builder;
 
     auto n_g = std::make_unique<FontGlyph>();
+    if (data->outlines && data->outlines->lookup(glyph_id, *n_g)) {
+        return data->glyphs.emplace(glyph_id, std::move(n_g)).first->second.get();
+    }
+
     n_g->bbox[0] = n_g->bbox[1] = n_g->bbox[2] = n_g->bbox[3] = 0.0;
     n_g->h_advance = 0.0;
     n_g->v_advance = 0.0;
@@ -458,6 +486,10 @@ FontGlyph const *FontInstance::LoadGlyph(int glyph_id)
         }
     }
 
+    if (data->outlines) {
+        data->outlines->insert(glyph_id, *n_g);
+    }
+
     auto ret = data->glyphs.emplace(glyph_id, std::move(n_g));
 
     return ret.first->second.get();
@@ -528,6 +560,8 @@ Geom::PathVector const *FontInstance::PathVector(int glyph_id)
 
 Inkscape::Pixbuf const *FontInstance::PixBuf(int glyph_id)
 {
+    auto lock = std::lock_guard(mutex);
+
     auto glyph_iter = data->openTypeSVGGlyphs.find(glyph_id);
     if (glyph_iter == data->openTypeSVGGlyphs.end()) {
         return nullptr; // out of range
@@ -650,12 +684,27 @@ double FontInstance::Advance(int glyph_id, bool vertical)
 
 std::map<Glib::ustring, OTSubstitution> const &FontInstance::get_opentype_tables()
 {
+    auto lock = std::lock_guard(mutex);
+
     if (!data->openTypeTables) {
-        auto hb_font = pango_font_get_hb_font(p_font);
-        assert(hb_font);
+        // Reading the tables is slow, so they are kept across sessions by font file.
+        auto const [file, index] = get_font_file(p_font);
+        auto &metadata = Inkscape::Text::FontMetadataCache::get();
+        if (file) {
+            data->openTypeTables = metadata.lookupTables(file, index);
+        }
 
-        data->openTypeTables.emplace();
-        readOpenTypeGsubTable(hb_font, *data->openTypeTables);
+        if (!data->openTypeTables) {
+            auto hb_font = pango_font_get_hb_font(p_font);
+            assert(hb_font);
+
+            data->openTypeTables.emplace();
+            readOpenTypeGsubTable(hb_font, *data->openTypeTables);
+
+            if (file) {
+                metadata.insertTables(file, index, *data->openTypeTables);
+            }
+        }
     }
 
     return *data->openTypeTables;
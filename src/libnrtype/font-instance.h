@@ -11,6 +11,7 @@
 #define LIBNRTYPE_FONT_INSTANCE_H
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include <optional>
 #include <unordered_map>
@@ -25,6 +26,9 @@
 
 namespace Inkscape {
 class Pixbuf;
+namespace Text {
+class GlyphOutlineCache;
+} // namespace Text
 } // namespace Inkscape
 
 /**
@@ -57,6 +61,7 @@ public:
 
     // Loads the given glyph's info. Glyphs are lazy-loaded, but never unloaded or modified
     // as long as the FontInstance still exists. Pointers to FontGlyphs also remain valid.
+    // Like the other lazy loading functions, it may be called from several threads at once.
     FontGlyph const *LoadGlyph(int glyph_id);
 
     // nota: all coordinates returned by these functions are on a [0..1] scale; you need to multiply
@@ -129,6 +134,9 @@ private:
     // as long as p_font is valid, face is too
     FT_Face face;
 
+    // Guards the face and the lazy-loaded data.
+    std::mutex mutex;
+
     /*
      * Metrics
      */
@@ -165,6 +173,9 @@ private:
 
         // Lookup table mapping pango glyph ids to glyphs.
         std::unordered_map<int, std::unique_ptr<FontGlyph const>> glyphs;
+
+        // Glyphs decomposed by earlier processes, if enabled.
+        std::unique_ptr<Inkscape::Text::GlyphOutlineCache> outlines;
     };
 
     std::shared_ptr<Data> data;
@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Font metadata kept on disk from one session to the next.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "font-metadata-cache.h"
+
+#include <cstdlib>
+#include <set>
+#include <sstream>
+
+#include <fontconfig/fontconfig.h>
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <pango/pango.h>
+
+#include "font-factory.h"
+#include "io/resource.h"
+#include "util/statics.h"
+
+namespace Inkscape {
+namespace Text {
+namespace {
+
+constexpr char const *FILE_NAME = "font-metadata.cache";
+constexpr char const *MAGIC = "inkscape-font-metadata";
+constexpr char const *VERSION = "1";
+
+std::string file_stamp(char const *path)
+{
+    GStatBuf st;
+    if (g_stat(path, &st) != 0) {
+        return {};
+    }
+    return std::to_string(st.st_mtime) + ':' + std::to_string(st.st_size);
+}
+
+/// Checksum of what the styles of the fonts depend on.
+std::string fontconfig_stamp()
+{
+    auto checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    auto const add = [&] (std::string const &s) {
+        // Including the terminating null, to separate the strings.
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>(s.c_str()), s.size() + 1);
+    };
+    auto const add_file = [&] (char const *path) {
+        add(path);
+        add(file_stamp(path));
+    };
+
+    add(std::to_string(FcGetVersion()));
+    add(pango_version_string());
+
+    if (auto list = FcConfigGetConfigFiles(nullptr)) {
+        while (auto path = FcStrListNext(list)) {
+            add_file(reinterpret_cast<char const *>(path));
+        }
+        FcStrListDone(list);
+    }
+
+    // The same file may hold several faces.
+    std::set<std::string> files;
+    for (auto set : {FcSetSystem, FcSetApplication}) {
+        if (auto fonts = FcConfigGetFonts(nullptr, set)) {
+            for (int i = 0; i < fonts->nfont; i++) {
+                FcChar8 *file = nullptr;
+                if (FcPatternGetString(fonts->fonts[i], FC_FILE, 0, &file) == FcResultMatch) {
+                    files.emplace(reinterpret_cast<char const *>(file));
+                }
+            }
+        }
+    }
+    for (auto const &file : files) {
+        add_file(file.c_str());
+    }
+
+    std::string stamp = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return stamp;
+}
+
+// The file has one record per line, made of tab separated fields escaped with g_strescape().
+
+void append_field(std::string &line, std::string const &field)
+{
+    auto escaped = g_strescape(field.c_str(), nullptr);
+    if (!line.empty()) {
+        line += '\t';
+    }
+    line += escaped;
+    g_free(escaped);
+}
+
+std::vector<std::string> split_fields(std::string const &line)
+{
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    while (true) {
+        auto const end = line.find('\t', start);
+        auto compressed = g_strcompress(line.substr(start, end - start).c_str());
+        fields.emplace_back(compressed);
+        g_free(compressed);
+        if (end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+std::string cache_path()
+{
+    using namespace IO::Resource;
+    return get_path_string(CACHE, NONE, FILE_NAME);
+}
+
+} // namespace
+
+FontMetadataCache &FontMetadataCache::get()
+{
+    struct DefaultFontMetadataCache : FontMetadataCache
+    {
+        DefaultFontMetadataCache() : FontMetadataCache(cache_path()) {}
+    };
+    static auto instance = Util::Static<DefaultFontMetadataCache>();
+    return instance.get();
+}
+
+FontMetadataCache::FontMetadataCache(std::string path)
+    : _path(std::move(path))
+{}
+
+FontMetadataCache::~FontMetadataCache()
+{
+    _save();
+}
+
+GList *FontMetadataCache::lookupStyles(std::string const &family)
+{
+    auto lock = std::lock_guard(_mutex);
+    _load();
+    auto it = _styles.find(family);
+    if (it == _styles.end()) {
+        return nullptr;
+    }
+
+    GList *styles = nullptr;
+    for (auto const &[css_name, display_name] : it->second) {
+        styles = g_list_prepend(styles, new StyleNames(css_name, display_name));
+    }
+    return g_list_reverse(styles);
+}
+
+void FontMetadataCache::insertStyles(std::string const &family, GList const *styles)
+{
+    if (!styles) {
+        return;
+    }
+
+    auto lock = std::lock_guard(_mutex);
+    _load();
+    auto &names = _styles[family];
+    names.clear();
+    for (auto l = styles; l; l = l->next) {
+        auto style = static_cast<StyleNames const *>(l->data);
+        names.emplace_back(style->CssName, style->DisplayName);
+    }
+    _dirty = true;
+}
+
+std::optional<std::map<Glib::ustring, OTSubstitution>> FontMetadataCache::lookupTables(char const *file, int index)
+{
+    auto lock = std::lock_guard(_mutex);
+    _load();
+    auto it = _tables.find({file, index});
+    if (it == _tables.end()) {
+        return {};
+    }
+    return it->second.tables;
+}
+
+void FontMetadataCache::insertTables(char const *file, int index,
+                                     std::map<Glib::ustring, OTSubstitution> const &tables)
+{
+    auto stamp = file_stamp(file);
+    if (stamp.empty()) {
+        return;
+    }
+
+    auto lock = std::lock_guard(_mutex);
+    _load();
+    _tables[{file, index}] = {std::move(stamp), tables};
+    _dirty = true;
+}
+
+void FontMetadataCache::configChanged()
+{
+    auto lock = std::lock_guard(_mutex);
+    if (!_loaded) {
+        // The stamp is taken when loading.
+        return;
+    }
+
+    auto stamp = fontconfig_stamp();
+    if (stamp != _stamp) {
+        _stamp = std::move(stamp);
+        _styles.clear();
+        _dirty = true;
+    }
+}
+
+void FontMetadataCache::save()
+{
+    auto lock = std::lock_guard(_mutex);
+    _save();
+}
+
+void FontMetadataCache::_load()
+{
+    if (_loaded) {
+        return;
+    }
+    _loaded = true;
+    _stamp = fontconfig_stamp();
+
+    std::string contents;
+    try {
+        contents = Glib::file_get_contents(_path);
+    } catch (Glib::FileError const &) {
+        return;
+    }
+
+    std::istringstream in(contents);
+    std::string line;
+    if (!std::getline(in, line) || split_fields(line) != std::vector<std::string>{MAGIC, VERSION}) {
+        return;
+    }
+
+    bool valid = false; // Whether the styles were listed from the current fonts.
+    while (std::getline(in, line)) {
+        auto fields = split_fields(line);
+        auto const &tag = fields[0];
+
+        if (tag == "stamp" && fields.size() == 2) {
+            valid = fields[1] == _stamp;
+        } else if (tag == "styles" && fields.size() % 2 == 0) {
+            if (!valid) {
+                continue;
+            }
+            auto &names = _styles[fields[1]];
+            for (std::size_t i = 2; i < fields.size(); i += 2) {
+                names.emplace_back(fields[i], fields[i + 1]);
+            }
+        } else if (tag == "tables" && fields.size() >= 4 && (fields.size() - 4) % 5 == 0) {
+            auto const &file = fields[1];
+            if (file_stamp(file.c_str()) != fields[3]) {
+                // Changed or removed since.
+                _dirty = true;
+                continue;
+            }
+
+            auto &entry = _tables[{file, std::atoi(fields[2].c_str())}];
+            entry.file_stamp = fields[3];
+            for (std::size_t i = 4; i < fields.size(); i += 5) {
+                auto &table = entry.tables[fields[i]];
+                table.before = fields[i + 1];
+                table.input = fields[i + 2];
+                table.after = fields[i + 3];
+                table.output = fields[i + 4];
+            }
+        }
+    }
+}
+
+void FontMetadataCache::_save()
+{
+    if (!_dirty) {
+        return;
+    }
+    _dirty = false;
+
+    std::string contents;
+    auto const add_line = [&] (std::vector<std::string> const &fields) {
+        std::string line;
+        for (auto const &field : fields) {
+            append_field(line, field);
+        }
+        contents += line;
+        contents += '\n';
+    };
+
+    add_line({MAGIC, VERSION});
+    add_line({"stamp", _stamp});
+    for (auto const &[family, names] : _styles) {
+        std::vector<std::string> fields{"styles", family};
+        for (auto const &[css_name, display_name] : names) {
+            fields.emplace_back(css_name);
+            fields.emplace_back(display_name);
+        }
+        add_line(fields);
+    }
+    for (auto const &[face, entry] : _tables) {
+        std::vector<std::string> fields{"tables", face.first, std::to_string(face.second), entry.file_stamp};
+        for (auto const &[name, table] : entry.tables) {
+            fields.emplace_back(name);
+            fields.emplace_back(table.before);
+            fields.emplace_back(table.input);
+            fields.emplace_back(table.after);
+            fields.emplace_back(table.output);
+        }
+        add_line(fields);
+    }
+
+    g_mkdir_with_parents(Glib::path_get_dirname(_path).c_str(), 0755);
+    try {
+        Glib::file_set_contents(_path, contents);
+    } catch (Glib::FileError const &e) {
+        g_info("Could not save the font metadata cache to '%s': %s", _path.c_str(), e.what().c_str());
+    }
+}
+
+} // namespace Text
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Font metadata kept on disk from one session to the next.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef LIBNRTYPE_FONT_METADATA_CACHE_H
+#define LIBNRTYPE_FONT_METADATA_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/ustring.h>
+
+#include "OpenTypeUtil.h"
+
+namespace Inkscape {
+namespace Text {
+
+/**
+ * Remembers what is slow to find out about the installed fonts, so that the next session does not
+ * have to enumerate it again: the styles of each family as listed by FontFactory::GetUIStyles(),
+ * and the OpenType substitution tables of each font file.
+ *
+ * The cache is a file in the user cache directory. The styles are only valid for the set of fonts
+ * they were listed from, so they are saved along with a checksum of the fontconfig configuration
+ * files and of the font files with their modification times, and are dropped when it no longer
+ * matches. The tables are checked against the modification time of their file instead.
+ *
+ * The file is read on first use, and written back when the cache is destroyed or save() is called.
+ */
+class FontMetadataCache
+{
+public:
+    static FontMetadataCache &get();
+
+    /// A cache kept in the given file rather than the one in the user cache directory.
+    explicit FontMetadataCache(std::string path);
+    ~FontMetadataCache();
+
+    /// Returns a newly allocated list of StyleNames, as FontFactory::GetUIStyles(), or null if unknown.
+    GList *lookupStyles(std::string const &family);
+    void insertStyles(std::string const &family, GList const *styles);
+
+    /// Returns the GSUB tables of a face in a font file, if they were read since the file last changed.
+    std::optional<std::map<Glib::ustring, OTSubstitution>> lookupTables(char const *file, int index);
+    void insertTables(char const *file, int index, std::map<Glib::ustring, OTSubstitution> const &tables);
+
+    /// Drop the styles if the fonts available through fontconfig changed.
+    void configChanged();
+
+    /// Write the cache to disk, if anything changed since it was read.
+    void save();
+
+private:
+    void _load();
+    void _save();
+
+    struct Tables
+    {
+        std::string file_stamp;
+        std::map<Glib::ustring, OTSubstitution> tables;
+    };
+
+    std::string const _path;
+    std::mutex _mutex;
+    bool _loaded = false;
+    bool _dirty = false;
+    std::string _stamp; // Of the fontconfig configuration the styles are valid for.
+    std::map<std::string, std::vector<std::pair<Glib::ustring, Glib::ustring>>> _styles; // CSS and display names.
+    std::map<std::pair<std::string, int>, Tables> _tables; // By file and face index.
+};
+
+} // namespace Text
+} // namespace Inkscape
+
+#endif // LIBNRTYPE_FONT_METADATA_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Glyph outlines kept on disk, shared between processes.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "glyph-outline-cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include <glib/gstdio.h>
+#include <glibmm/miscutils.h>
+
+#include <2geom/bezier-curve.h>
+#include <2geom/path.h>
+
+#include "font-glyph.h"
+#include "io/resource.h"
+
+namespace Inkscape {
+namespace Text {
+namespace {
+
+std::atomic<bool> enabled{false};
+
+// Files start with these, so that a file written by a different version or on a machine of
+// different byte order is not misread.
+constexpr char MAGIC[8] = {'I', 'N', 'K', 'G', 'L', 'Y', 'F', '1'};
+constexpr std::uint32_t BYTE_ORDER = 0x01020304;
+constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(BYTE_ORDER);
+
+/*
+ * Each glyph is a record made of its id and the size of its data, as 32 bit integers, followed by
+ * the data: the advances, widths and bounding box, the number of paths, and for each path its
+ * number of curves, its initial point, and for each curve its order and its control points but
+ * the first. Points are pairs of doubles.
+ */
+
+class Writer
+{
+public:
+    template <typename T>
+    void put(T const &value)
+    {
+        bytes.append(reinterpret_cast<char const *>(&value), sizeof(T));
+    }
+    void put(Geom::Point const &p)
+    {
+        put(p.x());
+        put(p.y());
+    }
+
+    std::string bytes;
+};
+
+class Reader
+{
+public:
+    Reader(char const *data, std::size_t size) : _pos(data), _end(data + size) {}
+
+    template <typename T>
+    bool get(T &value)
+    {
+        if (_end - _pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+            return false;
+        }
+        std::memcpy(&value, _pos, sizeof(T));
+        _pos += sizeof(T);
+        return true;
+    }
+    bool get(Geom::Point &p)
+    {
+        return get(p[Geom::X]) && get(p[Geom::Y]);
+    }
+
+    bool done() const { return _pos == _end; }
+
+private:
+    char const *_pos;
+    char const *_end;
+};
+
+} // namespace
+
+void GlyphOutlineCache::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+std::unique_ptr<GlyphOutlineCache> GlyphOutlineCache::open(char const *font_file, int index, char const *variations)
+{
+    if (!enabled) {
+        return {};
+    }
+
+    GStatBuf st;
+    if (g_stat(font_file, &st) != 0) {
+        return {};
+    }
+
+    auto const key = std::string(MAGIC, sizeof(MAGIC)) + '\n' + font_file + '\n' + std::to_string(st.st_size) + '\n'
+                   + std::to_string(st.st_mtime) + '\n' + std::to_string(index) + '\n' + (variations ? variations : "");
+    auto checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), key.size());
+    auto const dir = IO::Resource::get_path_string(IO::Resource::CACHE, IO::Resource::NONE, "glyph-outlines");
+    auto path = Glib::build_filename(dir, std::string(checksum) + ".glyphs");
+    g_free(checksum);
+
+    // Create the file with its header, unless it exists. Another process creating it at the same
+    // time may leave it without a header for a moment, in which case the cache is not used.
+    g_mkdir_with_parents(dir.c_str(), 0755);
+    if (auto file = g_fopen(path.c_str(), "wbx")) {
+        std::fwrite(MAGIC, 1, sizeof(MAGIC), file);
+        std::fwrite(&BYTE_ORDER, 1, sizeof(BYTE_ORDER), file);
+        std::fclose(file);
+    }
+
+    auto cache = std::unique_ptr<GlyphOutlineCache>(new GlyphOutlineCache(std::move(path)));
+    if (!cache->_map()) {
+        return {};
+    }
+    return cache;
+}
+
+GlyphOutlineCache::~GlyphOutlineCache()
+{
+    if (_mapped) {
+        g_mapped_file_unref(_mapped);
+    }
+    if (_file) {
+        std::fclose(_file);
+    }
+}
+
+bool GlyphOutlineCache::_map()
+{
+    _mapped = g_mapped_file_new(_path.c_str(), false, nullptr);
+    if (!_mapped) {
+        return false;
+    }
+
+    auto const data = g_mapped_file_get_contents(_mapped);
+    auto const size = g_mapped_file_get_length(_mapped);
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0
+        || std::memcmp(data + sizeof(MAGIC), &BYTE_ORDER, sizeof(BYTE_ORDER)) != 0) {
+        return false;
+    }
+
+    // Index the records. A record still being written by another process ends the file for us.
+    std::size_t offset = HEADER_SIZE;
+    while (true) {
+        Reader reader(data + offset, size - offset);
+        std::uint32_t glyph_id, length;
+        if (!reader.get(glyph_id) || !reader.get(length)) {
+            break;
+        }
+        offset += sizeof(glyph_id) + sizeof(length);
+        if (size - offset < length) {
+            break;
+        }
+        _records.emplace(glyph_id, std::pair{offset, std::size_t{length}});
+        offset += length;
+    }
+
+    return true;
+}
+
+bool GlyphOutlineCache::lookup(int glyph_id, FontGlyph &glyph) const
+{
+    auto it = _records.find(glyph_id);
+    if (it == _records.end()) {
+        return false;
+    }
+
+    auto const [offset, length] = it->second;
+    Reader reader(g_mapped_file_get_contents(_mapped) + offset, length);
+
+    FontGlyph result;
+    std::uint32_t num_paths;
+    if (!reader.get(result.h_advance) || !reader.get(result.h_width) ||
+        !reader.get(result.v_advance) || !reader.get(result.v_width) ||
+        !reader.get(result.bbox) || !reader.get(num_paths))
+    {
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < num_paths; i++) {
+        std::uint32_t num_curves;
+        Geom::Point initial;
+        if (!reader.get(num_curves) || !reader.get(initial)) {
+            return false;
+        }
+
+        Geom::Path path(initial);
+        for (std::uint32_t j = 0; j < num_curves; j++) {
+            std::uint32_t order;
+            Geom::Point p[3];
+            if (!reader.get(order) || order < 1 || order > 3) {
+                return false;
+            }
+            for (std::uint32_t k = 0; k < order; k++) {
+                if (!reader.get(p[k])) {
+                    return false;
+                }
+            }
+            switch (order) {
+                case 1: path.appendNew<Geom::LineSegment>(p[0]); break;
+                case 2: path.appendNew<Geom::QuadraticBezier>(p[0], p[1]); break;
+                case 3: path.appendNew<Geom::CubicBezier>(p[0], p[1], p[2]); break;
+            }
+        }
+        path.close();
+        result.pathvector.push_back(std::move(path));
+    }
+
+    if (!reader.done()) {
+        return false;
+    }
+
+    glyph = std::move(result);
+    return true;
+}
+
+void GlyphOutlineCache::insert(int glyph_id, FontGlyph const &glyph)
+{
+    if (_failed || _records.count(glyph_id)) {
+        return;
+    }
+
+    Writer data;
+    data.put(glyph.h_advance);
+    data.put(glyph.h_width);
+    data.put(glyph.v_advance);
+    data.put(glyph.v_width);
+    data.put(glyph.bbox);
+    data.put(static_cast<std::uint32_t>(glyph.pathvector.size()));
+    for (auto const &path : glyph.pathvector) {
+        data.put(static_cast<std::uint32_t>(path.size_open()));
+        data.put(path.initialPoint());
+        for (std::size_t i = 0; i < path.size_open(); i++) {
+            auto bezier = dynamic_cast<Geom::BezierCurve const *>(&path[i]);
+            if (!bezier || bezier->order() < 1 || bezier->order() > 3) {
+                return; // Not made by FreeType.
+            }
+            data.put(static_cast<std::uint32_t>(bezier->order()));
+            for (unsigned k = 1; k <= bezier->order(); k++) {
+                data.put(bezier->controlPoint(k));
+            }
+        }
+    }
+
+    Writer record;
+    record.put(static_cast<std::uint32_t>(glyph_id));
+    record.put(static_cast<std::uint32_t>(data.bytes.size()));
+    record.bytes += data.bytes;
+
+    if (!_file) {
+        _file = g_fopen(_path.c_str(), "ab");
+        if (!_file) {
+            _failed = true;
+            return;
+        }
+        // One write per record, appended atomically.
+        std::setvbuf(_file, nullptr, _IONBF, 0);
+    }
+    if (std::fwrite(record.bytes.data(), 1, record.bytes.size(), _file) != record.bytes.size()) {
+        _failed = true;
+    }
+}
+
+} // namespace Text
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Glyph outlines kept on disk, shared between processes.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef LIBNRTYPE_GLYPH_OUTLINE_CACHE_H
+#define LIBNRTYPE_GLYPH_OUTLINE_CACHE_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <glib.h>
+
+struct FontGlyph;
+
+namespace Inkscape {
+namespace Text {
+
+/**
+ * The metrics and outlines of the glyphs of one font face at one set of variation coordinates,
+ * saved in the user cache directory so that other processes do not have to decompose them from
+ * the font file again. This is meant for batch jobs that convert the same fonts to paths over and
+ * over, as when exporting text to PDF or PostScript.
+ *
+ * Each face has a file named after a checksum of the font file's path, size and modification time,
+ * the face index and the variation coordinates. Glyphs are appended to it as they are loaded, each
+ * in a single write, so that concurrent processes can share it. The file is memory mapped and
+ * indexed when the face is opened; glyphs added later by other processes are seen by the faces
+ * they open afterwards.
+ *
+ * Not thread-safe: FontInstance only uses it with its mutex held.
+ */
+class GlyphOutlineCache
+{
+public:
+    /// The cache is disabled unless turned on by the "/options/font/glyph_outline_cache" preference.
+    static void setEnabled(bool enabled);
+
+    /// Returns the cache of a face, or null if the cache is disabled or the file is not usable.
+    static std::unique_ptr<GlyphOutlineCache> open(char const *font_file, int index, char const *variations);
+
+    GlyphOutlineCache(GlyphOutlineCache const &) = delete;
+    GlyphOutlineCache &operator=(GlyphOutlineCache const &) = delete;
+    ~GlyphOutlineCache();
+
+    /// Fill in the glyph if it was in the file when the face was opened, and return whether it was.
+    bool lookup(int glyph_id, FontGlyph &glyph) const;
+    /// Append the glyph to the file.
+    void insert(int glyph_id, FontGlyph const &glyph);
+
+private:
+    explicit GlyphOutlineCache(std::string path) : _path(std::move(path)) {}
+
+    bool _map();
+
+    std::string _path;
+    GMappedFile *_mapped = nullptr;
+    std::unordered_map<int, std::pair<std::size_t, std::size_t>> _records; // Offset and size of each glyph's data.
+    std::FILE *_file = nullptr; // Opened for appending on first insertion.
+    bool _failed = false;
+};
+
+} // namespace Text
+} // namespace Inkscape
+
+#endif // LIBNRTYPE_GLYPH_OUTLINE_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
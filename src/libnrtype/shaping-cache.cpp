@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Process-wide cache of Pango itemization and shaping results.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "shaping-cache.h"
+
+#include <iterator>
+
+#include "font-instance.h"
+#include "util/statics.h"
+
+namespace Inkscape {
+namespace Text {
+namespace {
+
+// Rough limit on the memory taken by the cache.
+constexpr std::size_t MAX_CACHE_BYTES = 16 << 20;
+
+std::size_t glyphs_bytes(PangoGlyphString const *glyphs)
+{
+    return sizeof(PangoGlyphString) + glyphs->num_glyphs * (sizeof(PangoGlyphInfo) + sizeof(int));
+}
+
+} // namespace
+
+ShapingCache::Paragraph::~Paragraph()
+{
+    for (auto item : items) {
+        pango_item_free(item);
+    }
+    for (auto const &[range, glyphs] : _glyphs) {
+        pango_glyph_string_free(glyphs);
+    }
+}
+
+ShapingCache &ShapingCache::get()
+{
+    // Destroyed before main() exits like the font factory, and before it, as the items hold fonts.
+    struct ConstructibleShapingCache : ShapingCache {};
+    static auto instance = Util::Static<ConstructibleShapingCache>();
+    return instance.get();
+}
+
+std::shared_ptr<ShapingCache::Paragraph const> ShapingCache::lookup(std::string const &key)
+{
+    auto lock = std::lock_guard(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return {};
+    }
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return it->second->second;
+}
+
+void ShapingCache::insert(std::string key, std::shared_ptr<Paragraph> paragraph)
+{
+    auto lock = std::lock_guard(_mutex);
+    if (auto it = _index.find(key); it != _index.end()) {
+        _erase(it->second);
+    }
+
+    paragraph->_cached = true;
+    paragraph->_bytes = sizeof(Paragraph) + key.size()
+                      + paragraph->items.size() * (sizeof(PangoItem) + sizeof(FontInstance *))
+                      + paragraph->char_attributes.size() * sizeof(PangoLogAttr);
+    for (auto const &[range, glyphs] : paragraph->_glyphs) {
+        paragraph->_bytes += glyphs_bytes(glyphs);
+    }
+    _bytes += paragraph->_bytes;
+
+    _entries.emplace_front(std::move(key), std::move(paragraph));
+    _index.emplace(_entries.front().first, _entries.begin());
+    _trim();
+}
+
+PangoGlyphString *ShapingCache::lookupGlyphs(Paragraph const &paragraph, unsigned offset, unsigned length)
+{
+    auto lock = std::lock_guard(_mutex);
+    auto it = paragraph._glyphs.find({offset, length});
+    if (it == paragraph._glyphs.end()) {
+        return nullptr;
+    }
+    return pango_glyph_string_copy(it->second);
+}
+
+void ShapingCache::insertGlyphs(Paragraph const &paragraph, unsigned offset, unsigned length,
+                                PangoGlyphString const *glyphs)
+{
+    auto lock = std::lock_guard(_mutex);
+    if (!paragraph._cached) {
+        // Dropped in the meantime; nobody will find it again.
+        return;
+    }
+    auto [it, inserted] = paragraph._glyphs.emplace(std::pair{offset, length}, nullptr);
+    if (!inserted) {
+        return;
+    }
+    it->second = pango_glyph_string_copy(const_cast<PangoGlyphString *>(glyphs));
+
+    auto const bytes = glyphs_bytes(glyphs);
+    paragraph._bytes += bytes;
+    _bytes += bytes;
+    _trim();
+}
+
+void ShapingCache::clear()
+{
+    auto lock = std::lock_guard(_mutex);
+    while (!_entries.empty()) {
+        _erase(_entries.begin());
+    }
+}
+
+void ShapingCache::_erase(Entries::iterator it)
+{
+    auto &paragraph = *it->second;
+    paragraph._cached = false;
+    _bytes -= paragraph._bytes;
+    _index.erase(it->first);
+    _entries.erase(it);
+}
+
+void ShapingCache::_trim()
+{
+    while (_bytes > MAX_CACHE_BYTES && _entries.size() > 1) {
+        _erase(std::prev(_entries.end()));
+    }
+}
+
+} // namespace Text
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
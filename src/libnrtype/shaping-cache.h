@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Process-wide cache of Pango itemization and shaping results.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef LIBNRTYPE_SHAPING_CACHE_H
+#define LIBNRTYPE_SHAPING_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pango/pango.h>
+
+class FontInstance;
+
+namespace Inkscape {
+namespace Text {
+
+/**
+ * Keeps the result of pango_itemize() and pango_shape() for recently laid out paragraphs, so that
+ * relaying out a text whose characters and shaping attributes did not change, or laying out
+ * another text with the same ones, only redoes line breaking and positioning.
+ *
+ * A paragraph is identified by a key built by the layout from everything itemization depends on:
+ * the text, and the font description, font features and language of each of its ranges, the base
+ * direction and the gravity. Its shaped runs are identified by their byte range in the paragraph,
+ * as the tspan attributes decide where runs are split.
+ *
+ * Least recently used paragraphs are dropped once the cache grows over a fixed size.
+ */
+class ShapingCache
+{
+public:
+    /// Itemization of a paragraph, and the glyphs of the runs shaped from it so far.
+    class Paragraph
+    {
+    public:
+        Paragraph() = default;
+        Paragraph(Paragraph const &) = delete;
+        Paragraph &operator=(Paragraph const &) = delete;
+        ~Paragraph();
+
+        std::vector<PangoItem *> items; // Owned.
+        std::vector<std::shared_ptr<FontInstance>> fonts; // Of each item.
+        std::vector<PangoLogAttr> char_attributes;
+
+    private:
+        friend class ShapingCache;
+
+        // Guarded by the mutex of the cache.
+        mutable bool _cached = false;
+        mutable std::size_t _bytes = 0;
+        mutable std::map<std::pair<unsigned, unsigned>, PangoGlyphString *> _glyphs; // Owned, by byte range.
+    };
+
+    static ShapingCache &get();
+
+    /// Returns the paragraph stored under the key, or null.
+    std::shared_ptr<Paragraph const> lookup(std::string const &key);
+    /// Store a paragraph, which must not be changed afterwards.
+    void insert(std::string key, std::shared_ptr<Paragraph> paragraph);
+
+    /// Returns a copy of the glyphs shaped from the given byte range of the paragraph, or null.
+    PangoGlyphString *lookupGlyphs(Paragraph const &paragraph, unsigned offset, unsigned length);
+    /// Store a copy of the glyphs shaped from the given byte range of the paragraph.
+    void insertGlyphs(Paragraph const &paragraph, unsigned offset, unsigned length, PangoGlyphString const *glyphs);
+
+    /// Forget everything, e.g. because the available fonts changed.
+    void clear();
+
+private:
+    ShapingCache() = default;
+
+    using Entries = std::list<std::pair<std::string, std::shared_ptr<Paragraph>>>;
+    void _erase(Entries::iterator it);
+    void _trim();
+
+    std::mutex _mutex;
+    Entries _entries; // Most recently used first.
+    std::unordered_map<std::string_view, Entries::iterator> _index; // Viewing the keys in _entries.
+    std::size_t _bytes = 0;
+};
+
+} // namespace Text
+} // namespace Inkscape
+
+#endif // LIBNRTYPE_SHAPING_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
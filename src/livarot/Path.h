@@ -799,11 +799,18 @@ public:
   };
 
   typedef void (outlineCallback) (outline_callback_data * data, double tol,  double width);
+  /// What OutlineJoin() remembers from one join to the next, for one outline.
+  struct outline_join_state
+  {
+    bool turnInside = true;
+    Geom::Point prevPos = Geom::Point(0, 0);
+  };
   struct outline_callbacks
   {
     outlineCallback *cubicto;
     outlineCallback *bezierto;
     outlineCallback *arcto;
+    outline_join_state joins;
   };
 
   void SubContractOutline (int off, int num_pd,
@@ -825,7 +832,8 @@ public:
 			      PathDescrBezierTo & fin, bool before,
 			      Geom::Point & pos, Geom::Point & tgt, double &len, double &rad);
   static void OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point enNor,
-			   double width, JoinType join, double miter, int nType);
+			   double width, JoinType join, double miter, int nType,
+			   outline_join_state &state);
 
   static bool IsNulCurve (std::vector<PathDescr*> const &cmd, int curD, Geom::Point const &curX);
 
@@ -391,7 +391,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				if (closeIfNeeded) {
 					if ( Geom::LInfty (curX- firstP) < 0.0001 ) {
 						OutlineJoin (dest, firstP, curT, firstT, width, join,
-									 miter, nType);
+									 miter, nType, calls.joins);
 						dest->Close ();
 					}  else {
                                             PathDescrLineTo temp(firstP);
@@ -408,7 +408,7 @@ void Path::SubContractOutline(int off, int num_pd,
 							Geom::Point pos;
 							pos = curX;
 							OutlineJoin (dest, pos, curT, stNor, width, join,
-										 miter, nType);
+										 miter, nType, calls.joins);
 						}
 						dest->LineTo (enPos+width*enNor);
 
@@ -417,7 +417,7 @@ void Path::SubContractOutline(int off, int num_pd,
 							Geom::Point pos;
 							pos = firstP;
 							OutlineJoin (dest, enPos, enNor, firstT, width, join,
-										 miter, nType);
+										 miter, nType, calls.joins);
 							dest->Close ();
 						}
 					}
@@ -433,7 +433,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				if (Geom::LInfty (curX - firstP) < 0.0001)
 				{
 					OutlineJoin (dest, firstP, curT, firstT, width, join,
-								 miter, nType);
+								 miter, nType, calls.joins);
 					dest->Close ();
 				}
 				else
@@ -449,7 +449,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					{
 						OutlineJoin (dest, stPos, curT, stNor, width, join,
-									 miter, nType);
+									 miter, nType, calls.joins);
 					}
 
 					dest->LineTo (enPos+width*enNor);
@@ -457,7 +457,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					{
 						OutlineJoin (dest, enPos, enNor, firstT, width, join,
-									 miter, nType);
+									 miter, nType, calls.joins);
 						dest->Close ();
 					}
 				}
@@ -506,7 +506,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls.joins);
 			}
 
 			int n_d = dest->LineTo (nextX+width*enNor);
@@ -556,7 +556,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls.joins);
 			}
 
 			callsData.piece = curP;
@@ -612,7 +612,7 @@ void Path::SubContractOutline(int off, int num_pd,
 				// jointure
 				Geom::Point pos;
 				pos = curX;
-				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+				OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls.joins);
 			}
 
 			callsData.piece = curP;
@@ -670,7 +670,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					Geom::Point pos;
 					pos = curX;
-					if (stTle > 0) OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+					if (stTle > 0) OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls.joins);
 				}
 				int n_d = dest->LineTo (nextX+width*enNor);
 				if (n_d >= 0) {
@@ -701,7 +701,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					// jointure
 					Geom::Point pos;
 					pos = curX;
-					OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType);
+					OutlineJoin (dest, pos, curT, stNor, width, join, miter, nType, calls.joins);
 				}
 
 				callsData.piece = curP;
@@ -737,7 +737,7 @@ void Path::SubContractOutline(int off, int num_pd,
 					} else {
 						// jointure
 						Geom::Point pos=curX;
-						OutlineJoin (dest, pos, stTgt, stNor, width, join,  miter, nType);
+						OutlineJoin (dest, pos, stTgt, stNor, width, join,  miter, nType, calls.joins);
 						//                                              dest->LineTo(curX+width*stNor.x,curY+width*stNor.y);
 					}
 				}
@@ -1174,7 +1174,7 @@ Path::TangentOnBezAt (double at, Geom::Point const &iS,
 
 void
 Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point enNor, double width,
-                   JoinType join, double miter, int nType)
+                   JoinType join, double miter, int nType, outline_join_state &state)
 {
     /* 
         Arbitrarily decide if we're on the inside or outside of a half turn.
@@ -1185,11 +1185,11 @@ Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point
         ideally work because both should fall together, but it seems that this causes many
         extra nodes (due to rounding errors). Solution: for the 'half turn'-case toggle 
         inside/outside each time the same node is processed 2 consecutive times.
+        The toggle is kept in \a state, which lives as long as one outline, so that outlines
+        made at the same time on other threads do not interfere.
     */
-    static bool TurnInside = true;
-    static Geom::Point PrevPos(0, 0);
-    TurnInside ^= PrevPos == pos;
-    PrevPos = pos;
+    state.turnInside ^= state.prevPos == pos;
+    state.prevPos = pos;
 
 	const double angSi = cross (stNor, enNor);
 	const double angCo = dot (stNor, enNor);
@@ -1212,7 +1212,7 @@ Path::OutlineJoin (Path * dest, Geom::Point pos, Geom::Point stNor, Geom::Point
 //                dest->LineTo (pos);	// redundant
                 dest->LineTo (pos + width*enNor);
             }
-        } else if (angSi == 0 && TurnInside) { // Half turn (180 degrees) ... inside (see above).
+        } else if (angSi == 0 && state.turnInside) { // Half turn (180 degrees) ... inside (see above).
             dest->LineTo (pos + width*enNor);
         } else { // This is an outside join -> chosen JoinType should be applied.
             if (join == join_round) {
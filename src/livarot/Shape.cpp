@@ -57,6 +57,7 @@ Shape::~Shape ()
   maxPt = 0;
   maxAr = 0;
   free(qrsData);
+  g_free(iData);
 }
 
 void Shape::Affiche()
@@ -2199,9 +2200,8 @@ void Shape::initialiseEdgeData()
 
 void Shape::clearIncidenceData()
 {
-    g_free(iData);
-    iData = nullptr;
-    nbInc = maxInc = 0;
+    // Keep the array for the next sweep; it is freed with the shape.
+    nbInc = 0;
 }
 
 
@@ -770,6 +770,17 @@ private:
      */
     void CleanupSweep();        // deallocates them
 
+    /**
+     * Set up the sweepline tree sTree and the event queue sEvts for a sweep over n edges, reusing
+     * the ones of an earlier sweep on this thread if there are any.
+     */
+    void acquireSweepStructures(int n);
+
+    /**
+     * Hand sTree and sEvts over to the next sweep on this thread.
+     */
+    void releaseSweepStructures();
+
     // edge sorting function    
 
     /**
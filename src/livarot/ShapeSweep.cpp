@@ -13,6 +13,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <glib.h>
 #include <2geom/affine.h>
 #include "Shape.h"
@@ -62,6 +63,58 @@ Shape::CleanupSweep ()
   MakeSweepSrcData (false);
 }
 
+namespace {
+
+// ConvertToShape() and Booleen() are called many times in a row by booleans, offsets, stroke to
+// path and flowed text, and only need the sweep structures while they run. Keep the last ones of
+// each thread around rather than allocating and freeing them every time.
+thread_local std::unique_ptr<SweepTreeList> spare_tree;
+thread_local std::unique_ptr<SweepEventQueue> spare_events;
+
+} // namespace
+
+void
+Shape::acquireSweepStructures (int n)
+{
+  if (sTree == nullptr) {
+    if (spare_tree) {
+      sTree = spare_tree.release();
+      sTree->reset(n);
+    } else {
+      sTree = new SweepTreeList(n);
+    }
+  }
+  if (sEvts == nullptr) {
+    if (spare_events) {
+      sEvts = spare_events.release();
+      sEvts->reset(n);
+    } else {
+      sEvts = new SweepEventQueue(n);
+    }
+  }
+}
+
+void
+Shape::releaseSweepStructures ()
+{
+  if (sTree) {
+    if (spare_tree) {
+      delete sTree;
+    } else {
+      spare_tree.reset(sTree);
+    }
+    sTree = nullptr;
+  }
+  if (sEvts) {
+    if (spare_events) {
+      delete sEvts;
+    } else {
+      spare_events.reset(sEvts);
+    }
+    sEvts = nullptr;
+  }
+}
+
 void
 Shape::ForceToPolygon ()
 {
@@ -189,12 +242,7 @@ Shape::ConvertToShape (Shape * a, FillRule directed, bool invert)
   a->ResetSweep();
 
   // allocating the sweepline data structures
-  if (sTree == nullptr) {
-    sTree = new SweepTreeList(a->numberOfEdges());
-  }
-  if (sEvts == nullptr) {
-    sEvts = new SweepEventQueue(a->numberOfEdges());
-  }
+  acquireSweepStructures(a->numberOfEdges());
 
   // make room for stuff and set flags
   MakePointData(true);
@@ -908,10 +956,7 @@ Shape::ConvertToShape (Shape * a, FillRule directed, bool invert)
 
   //      Plot(200.0,200.0,2.0,400.0,400.0,true,true,true,true);
 
-  delete sTree;
-  sTree = nullptr;
-  delete sEvts;
-  sEvts = nullptr;
+  releaseSweepStructures();
 
   MakePointData (false);
   MakeEdgeData (false);
@@ -947,12 +992,7 @@ Shape::Booleen (Shape * a, Shape * b, BooleanOp mod,int cutPathID)
   a->ResetSweep ();
   b->ResetSweep ();
 
-  if (sTree == nullptr) {
-      sTree = new SweepTreeList(a->numberOfEdges() + b->numberOfEdges());
-  }
-  if (sEvts == nullptr) {
-      sEvts = new SweepEventQueue(a->numberOfEdges() + b->numberOfEdges());
-  }
+  acquireSweepStructures(a->numberOfEdges() + b->numberOfEdges());
   
   MakePointData (true);
   MakeEdgeData (true);
@@ -1714,10 +1754,7 @@ Shape::Booleen (Shape * a, Shape * b, BooleanOp mod,int cutPathID)
     }
   }
   
-  delete sTree;
-  sTree = nullptr;
-  delete sEvts;
-  sEvts = nullptr;
+  releaseSweepStructures();
   
   if ( mod == bool_op_cut ) {
     // on garde le askForWinding
@@ -27,6 +27,14 @@ public:
     SweepEventQueue(int s);
     virtual ~SweepEventQueue();
 
+    /**
+     * Remove all events, and make room for at least s of them, so that the queue can be used for
+     * another sweep without allocating it again.
+     *
+     * @param s The number of events it should be able to hold.
+     */
+    void reset(int s);
+
     /**
      * Number of events currently stored.
      *
@@ -28,6 +28,18 @@ SweepEventQueue::~SweepEventQueue()
     delete []inds;
 }
 
+void SweepEventQueue::reset(int s)
+{
+    if (s > maxEvt) {
+        g_free(events);
+        delete []inds;
+        maxEvt = s;
+        events = (SweepEvent *) g_malloc(maxEvt * sizeof(SweepEvent));
+        inds = new int[maxEvt];
+    }
+    nbEvt = 0;
+}
+
 SweepEvent *SweepEventQueue::add(SweepTree *iLeft, SweepTree *iRight, Geom::Point &px, double itl, double itr)
 {
     if (nbEvt > maxEvt) {
@@ -30,6 +30,17 @@ SweepTreeList::~SweepTreeList()
     trees = nullptr;
 }
 
+void SweepTreeList::reset(int s)
+{
+    if (s > maxTree) {
+        g_free(trees);
+        trees = (SweepTree *) g_malloc(s * sizeof(SweepTree));
+        maxTree = s;
+    }
+    nbTree = 0;
+    racine = nullptr;
+}
+
 
 SweepTree *SweepTreeList::add(Shape *iSrc, int iBord, int iWeight, int iStartPoint, Shape */*iDst*/)
 {
@@ -33,7 +33,7 @@ class SweepTree;
 class SweepTreeList {
 public:
     int nbTree;          /*!< Number of nodes in the tree. */
-    int const maxTree;   /*!< Max number of nodes in the tree. */
+    int maxTree;         /*!< Max number of nodes in the tree. */
     SweepTree *trees;    /*!< The array of nodes. */
     SweepTree *racine;   /*!< Root of the tree. */
 
@@ -49,6 +49,14 @@ public:
      */
     virtual ~SweepTreeList();
 
+    /**
+     * Remove all nodes, and make room for at least s of them, so that the list can be used for
+     * another sweep without allocating it again.
+     *
+     * @param s The number of maximum nodes it should be able to hold.
+     */
+    void reset(int s);
+
     /**
      * Create a new node and add it. This doesn't do any insertion in tree though. It just
      * creates the node and puts it in the list of nodes. The actual insertion would need
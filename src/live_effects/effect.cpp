@@ -79,6 +79,7 @@
 #include "live_effects/lpe-transform_2pts.h"
 #include "live_effects/lpe-vonkoch.h"
 #include "live_effects/lpeobject.h"
+#include "live_effects/parameter/path.h"
 #include "message-stack.h"
 #include "object/sp-defs.h"
 #include "object/sp-root.h"
@@ -1648,6 +1649,139 @@ Effect::acceptParamPath (SPPath const*/*param_path*/) {
     setReady();
 }
 
+bool Effect::hasOnlyOwnParams(std::vector<Parameter const *> const &covered) const
+{
+    for (auto param : param_vector) {
+        if (std::find(covered.begin(), covered.end(), param) != covered.end()) {
+            continue;
+        }
+        switch (param->paramType()) {
+            case ParamType::ORIGINAL_PATH:
+            case ParamType::ORIGINAL_SATELLITE:
+            case ParamType::SATELLITE:
+            case ParamType::SATELLITE_ARRAY:
+            case ParamType::PATH_ARRAY:
+                return false;
+            case ParamType::PATH:
+                // An inline path is part of the serialized value, but a linked one is not.
+                if (static_cast<PathParam const *>(param)->getObject()) {
+                    return false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool Effect::ResultKey::operator==(ResultKey const &other) const
+{
+    return shape == other.shape && transform == other.transform && visual_bbox == other.visual_bbox &&
+           geometric_bbox == other.geometric_bbox && params == other.params &&
+           dependencies == other.dependencies && input == other.input && original == other.original;
+}
+
+std::optional<Effect::ResultKey> Effect::makeResultKey(SPCurve const &curve) const
+{
+    if (!current_shape || !isCacheable()) {
+        return {};
+    }
+
+    ResultKey key;
+    key.shape = current_shape;
+    key.transform = current_shape->i2doc_affine();
+    // Effects measure the item they are applied to in doBeforeEffect(), which may be a group.
+    SPItem const *item = sp_lpe_item ? static_cast<SPItem const *>(sp_lpe_item) : current_shape;
+    key.visual_bbox = item->visualBounds();
+    key.geometric_bbox = item->geometricBounds();
+    if (auto original = current_shape->curveBeforeLPE()) {
+        // Also needed beyond the first effect of a stack, as effects may measure the original path.
+        key.original = original->get_pathvector();
+    }
+    key.input = curve.get_pathvector();
+    key.params.reserve(param_vector.size());
+    for (auto param : param_vector) {
+        key.params.emplace_back(param->param_getSVGValue());
+    }
+    addCacheDependencies(key.dependencies);
+    return key;
+}
+
+/**
+ * Run doEffect(), unless nothing it depends on has changed since the last call, in which case its
+ * previous output is reused. Speeds up document loading and updates that do not affect this effect.
+ */
+void Effect::doEffect_memoized(SPCurve *curve)
+{
+    _pending_key.reset();
+    _prepared_before_effect.reset();
+
+    auto key = curve ? makeResultKey(*curve) : std::nullopt;
+    if (!key) {
+        _last_result.reset();
+        doEffect(curve);
+        return;
+    }
+
+    if (_last_result && _last_result->key == *key) {
+        curve->set_pathvector(_last_result->output);
+        return;
+    }
+
+    _last_result.reset();
+    doEffect(curve);
+    _last_result = Result{ std::move(*key), curve->get_pathvector() };
+}
+
+bool Effect::prepareConcurrentEffect(SPCurve const &curve)
+{
+    _prepared_before_effect.emplace(current_shape, curve.get_pathvector());
+    _pending_key.reset();
+    if (!isConcurrencySafe()) {
+        return false;
+    }
+    _pending_key = makeResultKey(curve);
+    if (!_pending_key) {
+        return false;
+    }
+    if (_last_result && _last_result->key == *_pending_key) {
+        // Already up to date; nothing to compute.
+        _pending_key.reset();
+    }
+    return true;
+}
+
+void Effect::runConcurrentEffect()
+{
+    if (!_pending_key) {
+        return;
+    }
+
+    auto key = std::move(*_pending_key);
+    _pending_key.reset();
+    _last_result.reset();
+
+    SPCurve curve(key.input);
+    try {
+        doEffect(&curve);
+    } catch (std::exception const &) {
+        // Left to the serial update, which reports the error.
+        return;
+    }
+    _last_result = Result{ std::move(key), curve.get_pathvector() };
+}
+
+bool Effect::takePreparedBeforeEffect(SPShape const *shape, SPCurve const &curve)
+{
+    if (!_prepared_before_effect) {
+        return false;
+    }
+    bool const prepared = _prepared_before_effect->first == shape && _prepared_before_effect->second == curve.get_pathvector();
+    _prepared_before_effect.reset();
+    return prepared;
+}
+
 /*
  *  Here be the doEffect function chain:
  */
@@ -12,7 +12,13 @@
 #include "parameter/bool.h"
 #include "parameter/hidden.h"
 #include "ui/widget/registry.h"
+#include <optional>
+#include <utility>
+#include <vector>
+#include <2geom/affine.h>
 #include <2geom/forward.h>
+#include <2geom/pathvector.h>
+#include <2geom/rect.h>
 #include <glibmm/ustring.h>
 #include <gtkmm/eventbox.h>
 #include <gtkmm/expander.h>
@@ -105,6 +111,37 @@ public:
     inline void setReady(bool ready = true) { is_ready = ready; }
 
     virtual void doEffect (SPCurve * curve);
+    void doEffect_memoized(SPCurve *curve);
+    /**
+     * Whether the output of doEffect() is determined by the input path, the current shape and its
+     * transform and bounding boxes, the serialized parameters and whatever addCacheDependencies()
+     * reports, so that it can be reused while none of these change. Effects opt in.
+     */
+    virtual bool isCacheable() const { return false; }
+    /**
+     * Append the values doEffect() reads from outside the path and the parameters, such as
+     * preferences or style properties, to the key of the memoized result.
+     */
+    virtual void addCacheDependencies(std::vector<Glib::ustring> & /*dependencies*/) const {}
+    /**
+     * Whether doEffect() only reads the input curve and the effect's own state, and never the
+     * document, the preferences or other shared state, so that the effects of independent items
+     * can be computed concurrently on worker threads. Effects opt in, and must be cacheable too.
+     */
+    virtual bool isConcurrencySafe() const { return false; }
+    /**
+     * Two-phase evaluation for concurrent updates. prepareConcurrentEffect() is called on the main
+     * thread once doBeforeEffect_impl() has run, and returns whether the effect can be evaluated
+     * for the curve. runConcurrentEffect() may then be called from any thread to compute the
+     * output, which the next doEffect_memoized() call with the same inputs picks up.
+     */
+    bool prepareConcurrentEffect(SPCurve const &curve);
+    void runConcurrentEffect();
+    /**
+     * Whether doBeforeEffect_impl() already ran for this shape and curve ahead of a concurrent
+     * evaluation, so that the serial update need not run it again. Only answers true once.
+     */
+    bool takePreparedBeforeEffect(SPShape const *shape, SPCurve const &curve);
 
     virtual Gtk::Widget * newWidget();
     /**
@@ -184,6 +221,10 @@ protected:
     virtual void addKnotHolderEntities(KnotHolder * /*knotholder*/, SPItem * /*item*/) {};
 
     virtual void addCanvasIndicators(SPLPEItem const* lpeitem, std::vector<Geom::PathVector> &hp_vec);
+    // Whether no parameter refers to other objects, whose changes would not show in the serialized value.
+    // The parameters in 'covered' are skipped, as the effect reports what it reads of their objects
+    // through addCacheDependencies().
+    bool hasOnlyOwnParams(std::vector<Parameter const *> const &covered = {}) const;
 
     bool _provides_knotholder_entities;
     LPEAction _lpe_action = LPE_NONE;
@@ -209,6 +250,30 @@ private:
     void setDefaultParam(Glib::ustring pref_path, Parameter *param);
     void unsetDefaultParam(Glib::ustring pref_path, Parameter *param);
     bool provides_own_flash_paths; // if true, the standard flash path is suppressed
+
+    // Everything the last memoized run of doEffect() depended on, and its output.
+    struct ResultKey
+    {
+        SPShape const *shape;
+        Geom::Affine transform;
+        Geom::OptRect visual_bbox;
+        Geom::OptRect geometric_bbox;
+        Geom::PathVector original;
+        Geom::PathVector input;
+        std::vector<Glib::ustring> params;
+        std::vector<Glib::ustring> dependencies;
+        bool operator==(ResultKey const &other) const;
+    };
+    struct Result
+    {
+        ResultKey key;
+        Geom::PathVector output;
+    };
+    std::optional<Result> _last_result;
+    std::optional<ResultKey> _pending_key; // Prepared but not yet run concurrent evaluation.
+    // Shape and curve prepareConcurrentEffect() was called for, until the serial update takes them.
+    std::optional<std::pair<SPShape const *, Geom::PathVector>> _prepared_before_effect;
+    std::optional<ResultKey> makeResultKey(SPCurve const &curve) const;
     sigc::connection _before_commit_connection;
     bool destroying = false;
     bool is_ready;
@@ -20,6 +20,8 @@ class LPEDashedStroke : public Effect {
     ~LPEDashedStroke() override;
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
     Geom::PathVector doEffect_path (Geom::PathVector const & path_in) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
     double timeAtLength(double const A, Geom::Path const &segment);
     double timeAtLength(double const A, Geom::Piecewise<Geom::D2<Geom::SBasis> > pwd2);
 private:
@@ -9,6 +9,8 @@
 
 #include "live_effects/lpe-embrodery-stitch-ordering.h"
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace Inkscape {
@@ -163,6 +165,139 @@ bool triangleit_test(std::vector<Iterator> &iterators, Iterator const &end)
     }
 }
 
+// ==================== Spatial Grid ====================
+
+// A uniform grid of points with ids for nearest neighbor searches, so that searches do not need to
+// look at all points. Points can be removed once they no longer take part in the search.
+
+class PointGrid {
+public:
+    explicit PointGrid(const std::vector<std::pair<Point, int>> &points);
+
+    // Remove a point which was added with the given id
+    void Remove(const Point &point, int id);
+
+    // Append the ids of the up to n nearest points for which accept(id) is true to result, nearest first
+    template<class Accept>
+    void FindNearest(const Point &point, size_t n, Accept &&accept, std::vector<int> &result) const;
+
+private:
+    struct Entry {
+        Point point;
+        int id;
+    };
+
+    std::vector<Entry> &CellAt(const Point &point);
+    int CellX(Coord x) const;
+    int CellY(Coord y) const;
+
+    Rect bounds;
+    Coord cellSize = 1.0;
+    int nx = 1;
+    int ny = 1;
+    std::vector<std::vector<Entry>> cells;
+};
+
+PointGrid::PointGrid(const std::vector<std::pair<Point, int>> &points)
+{
+    OptRect r;
+    for (auto const &point : points) {
+        r.unionWith(Rect(point.first, point.first));
+    }
+    if (r) {
+        bounds = *r;
+        // Aim for about two points per cell
+        Coord const n = std::max<Coord>(points.size(), 1);
+        cellSize = std::max(std::sqrt(2.0 * bounds.area() / n), 2.0 * std::max(bounds.width(), bounds.height()) / n);
+        if (!(cellSize > 0.0)) {
+            cellSize = 1.0;
+        }
+        nx = static_cast<int>(bounds.width() / cellSize) + 1;
+        ny = static_cast<int>(bounds.height() / cellSize) + 1;
+    }
+
+    cells.resize(nx * ny);
+    for (auto const &point : points) {
+        CellAt(point.first).push_back({point.first, point.second});
+    }
+}
+
+int PointGrid::CellX(Coord x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - bounds.left()) / cellSize)), 0, nx - 1);
+}
+
+int PointGrid::CellY(Coord y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - bounds.top()) / cellSize)), 0, ny - 1);
+}
+
+std::vector<PointGrid::Entry> &PointGrid::CellAt(const Point &point)
+{
+    return cells[CellY(point.y()) * nx + CellX(point.x())];
+}
+
+void PointGrid::Remove(const Point &point, int id)
+{
+    auto &cell = CellAt(point);
+    auto it = std::find_if(cell.begin(), cell.end(), [id](Entry const &entry) { return entry.id == id; });
+    if (it != cell.end()) {
+        *it = cell.back();
+        cell.pop_back();
+    }
+}
+
+template<class Accept>
+void PointGrid::FindNearest(const Point &point, size_t n, Accept &&accept, std::vector<int> &result) const
+{
+    // Best candidates so far, sorted by distance
+    std::vector<std::pair<Coord, int>> best;
+    if (n == 0) {
+        return;
+    }
+
+    auto visit = [&](int x, int y) {
+        for (auto const &entry : cells[y * nx + x]) {
+            Coord const dist = distance(point, entry.point);
+            if ((best.size() < n || dist < best.back().first) && accept(entry.id)) {
+                best.insert(std::upper_bound(best.begin(), best.end(), std::make_pair(dist, entry.id)), {dist, entry.id});
+                if (best.size() > n) {
+                    best.pop_back();
+                }
+            }
+        }
+    };
+
+    int const cx = CellX(point.x());
+    int const cy = CellY(point.y());
+
+    // Visit rings of cells around the cell of the point.
+    // All points in ring r are at least (r-1) cells away from the point.
+    for (int r = 0; r <= std::max(nx, ny); r++) {
+        if (best.size() == n && best.back().first <= (r - 1) * cellSize) {
+            break;
+        }
+        for (int y = std::max(cy - r, 0); y <= std::min(cy + r, ny - 1); y++) {
+            if (y == cy - r || y == cy + r) {
+                for (int x = std::max(cx - r, 0); x <= std::min(cx + r, nx - 1); x++) {
+                    visit(x, y);
+                }
+            } else {
+                if (cx - r >= 0) {
+                    visit(cx - r, y);
+                }
+                if (cx + r < nx) {
+                    visit(cx + r, y);
+                }
+            }
+        }
+    }
+
+    for (auto const &candidate : best) {
+        result.push_back(candidate.second);
+    }
+}
+
 // ==================== Trivial Ordering Functions ====================
 
 // Sub-path reordering: do nothing - keep original order
@@ -184,6 +319,10 @@ void OrderingZigZag(std::vector<OrderingInfo> &infos, bool revfirst)
 
 void OrderingClosest(std::vector<OrderingInfo> &infos, bool revfirst)
 {
+    if (infos.empty()) {
+        return;
+    }
+
     std::vector<OrderingInfo> result;
     result.reserve(infos.size());
 
@@ -193,38 +332,30 @@ void OrderingClosest(std::vector<OrderingInfo> &infos, bool revfirst)
 
     infos[0].used = true;
 
+    // Grid of the begin (id 2*i) and end (id 2*i+1) points of the yet unused sub paths
+    std::vector<std::pair<Point, int>> points;
+    points.reserve(2 * infos.size());
+    for (unsigned int i = 1; i < infos.size(); i++) {
+        points.emplace_back(infos[i].GetBegOrig(), 2 * i);
+        points.emplace_back(infos[i].GetEndOrig(), 2 * i + 1);
+    }
+    PointGrid grid(points);
+    std::vector<int> nearest;
 
     for (unsigned int iRnd = 1; iRnd < infos.size(); iRnd++) {
         // find closest point to p
-        unsigned iBest = 0;
-        bool revBest = false;
-        Coord distBest = Geom::infinity();
-
-        for (std::vector<OrderingInfo>::iterator it = infos.begin(); it != infos.end(); ++it) {
-            it->index = it - infos.begin();
-            it->reverse = (it->index & 1) != 0;
-
-            if (!it->used) {
-                Coord dist = distance(p, it->GetBegOrig());
-                if (dist < distBest) {
-                    distBest = dist;
-                    iBest = it - infos.begin();
-                    revBest = false;
-                }
-
-                dist = distance(p, it->GetEndOrig());
-                if (dist < distBest) {
-                    distBest = dist;
-                    iBest = it - infos.begin();
-                    revBest = true;
-                }
-            }
-        }
+        nearest.clear();
+        grid.FindNearest(p, 1, [](int) { return true; }, nearest);
+        assert(nearest.size() == 1);
+        unsigned iBest = nearest.front() / 2;
+        bool revBest = nearest.front() & 1;
 
         result.push_back(infos[iBest]);
         result.back().reverse = revBest;
         p = result.back().GetEndRev();
         infos[iBest].used = true;
+        grid.Remove(infos[iBest].GetBegOrig(), 2 * iBest);
+        grid.Remove(infos[iBest].GetEndOrig(), 2 * iBest + 1);
     }
 
     infos = result;
@@ -250,46 +381,17 @@ void OrderingClosest(std::vector<OrderingInfo> &infos, bool revfirst)
 
 // Find 2 nearest points to given point
 
-void OrderingPoint::FindNearest2(const std::vector<OrderingInfoEx *> &infos)
+void OrderingPoint::FindNearest2(const std::vector<OrderingInfoEx *> &infos, const PointGrid &grid)
 {
-    // This implementation is not terribly elegant (unSTLish).
-    // But for the first 2 elements using e.g. partial_sort is not simpler.
+    // The grid has the begin point of infos[i] as id 2*i and the end point as id 2*i+1
+    std::vector<int> ids;
+    grid.FindNearest(point, 2, [this](int id) { return id / 2 != infoex->idx; }, ids);
 
-    Coord dist0 = Geom::infinity();
-    Coord dist1 = Geom::infinity();
     nearest[0] = nullptr;
     nearest[1] = nullptr;
-
-    for (auto info : infos) {
-        Coord dist = distance(point, info->beg.point);
-        if (dist < dist1) {
-            if (&info->beg != this && &info->end != this) {
-                if (dist < dist0) {
-                    nearest[1] = nearest[0];
-                    nearest[0] = &info->beg;
-                    dist1 = dist0;
-                    dist0 = dist;
-                } else {
-                    nearest[1] = &info->beg;
-                    dist1 = dist;
-                }
-            }
-        }
-
-        dist = distance(point, info->end.point);
-        if (dist < dist1) {
-            if (&info->beg != this && &info->end != this) {
-                if (dist < dist0) {
-                    nearest[1] = nearest[0];
-                    nearest[0] = &info->end;
-                    dist1 = dist0;
-                    dist0 = dist;
-                } else {
-                    nearest[1] = &info->end;
-                    dist1 = dist;
-                }
-            }
-        }
+    for (size_t i = 0; i < ids.size(); i++) {
+        OrderingInfoEx *info = infos[ids[i] / 2];
+        nearest[i] = ids[i] & 1 ? &info->end : &info->beg;
     }
 }
 
@@ -415,8 +517,6 @@ OrderingGroupNeighbor *OrderingGroupPoint::FindNearestUnused()
         }
     }
 
-    // it shouldn't happen that we can't find any point at all
-    assert(0);
     return nullptr;
 }
 
@@ -862,10 +962,69 @@ void LinearizeTour(std::vector<OrderingGroupConnection *> &connections)
     }
 }
 
+// Keeps track of the trial budget, progress reporting and cancellation of an optimization.
+// The budget is counted in trials rather than time, so that the same input gives the same ordering on any machine.
+
+class OrderingBudget {
+public:
+    explicit OrderingBudget(const OrderingControl &control) :
+        control(control)
+    {
+    }
+
+    // Called before the optimization and after each trial with the fraction of the work done;
+    // returns true if the optimization shall stop.
+    // Only every few calls report progress, so this is cheap.
+    bool Expired(double fraction)
+    {
+        if (!expired) {
+            expired = (control.maxTrials > 0 && trials >= control.maxTrials) ||
+                      (trials % 64 == 0 && control.progress && !control.progress(fraction));
+            trials++;
+        }
+        return expired;
+    }
+
+private:
+    const OrderingControl &control;
+    size_t trials = 0;
+    bool expired = false;
+};
+
+// Number of neighbor points kept per group end point
+static constexpr size_t N_NEIGHBORS = 16;
+// Number of nearby connections considered for reconnection with each connection
+static constexpr size_t N_NEAR_CONNECTIONS = 5;
+// Up to this number of connection combinations, all combinations are tried
+static constexpr double MAX_EXHAUSTIVE_TRIALS = 1e5;
+
+// Collect the connections at the neighbors of the end points of a connection
+
+void FindNearConnections(OrderingGroupConnection *connection, std::vector<OrderingGroupConnection *> &near)
+{
+    near.clear();
+    for (auto point : connection->points) {
+        for (auto &nghb : point->nearest) {
+            OrderingGroupPoint *other = nghb.point;
+            if (!other->connection && other->group->nEndPoints == 4) {
+                // Not on the tour, but the group could be swapped to use it; take the connection of its counterpart
+                other = other->group->endpoints[other->indexInGroup ^ 2];
+            }
+            OrderingGroupConnection *nearConnection = other->connection;
+            if (nearConnection && nearConnection != connection && !contains(near, nearConnection)) {
+                near.push_back(nearConnection);
+                if (near.size() == N_NEAR_CONNECTIONS) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
 // Use some Traveling Salesman Problem (TSP) like heuristics to bring several groups into a
 // order with as short as possible interconnection paths
 
-void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
+void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims, OrderingBudget &budget)
 {
     // There is no point in ordering just one group
     if (groups->size() <= 1) {
@@ -877,22 +1036,29 @@ void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
         group->SetEndpoints();
     }
 
-    // Find the neighboring points for all end points of all groups and sort by distance
-    for (std::vector<OrderingGroup *>::iterator itThis = groups->begin(); itThis != groups->end(); ++itThis) {
-        for (int i = 0; i < (*itThis)->nEndPoints; i++) {
-            // This can be up to 2x too large, but still better than incrementing the size
-            (*itThis)->endpoints[i]->nearest.reserve(4 * groups->size());
+    // Grid of all end points, end point i of group g has id 4*g+i
+    std::vector<std::pair<Point, int>> points;
+    points.reserve(4 * groups->size());
+    for (auto group : *groups) {
+        for (int i = 0; i < group->nEndPoints; i++) {
+            points.emplace_back(group->endpoints[i]->point, 4 * group->index + i);
         }
-
-        for (std::vector<OrderingGroup *>::iterator itNghb = groups->begin(); itNghb != groups->end(); ++itNghb) {
-            if (itThis != itNghb) {
-                (*itThis)->AddNeighbors(*itNghb);
+    }
+    PointGrid grid(points);
+    auto pointById = [groups](int id) { return (*groups)[id / 4]->endpoints[id % 4]; };
+
+    // Find the nearest neighboring points of other groups for all end points of all groups, sorted by distance
+    std::vector<int> ids;
+    for (auto group : *groups) {
+        for (int i = 0; i < group->nEndPoints; i++) {
+            OrderingGroupPoint *point = group->endpoints[i];
+            ids.clear();
+            grid.FindNearest(point->point, N_NEIGHBORS, [group](int id) { return id / 4 != group->index; }, ids);
+            point->nearest.reserve(ids.size());
+            for (int id : ids) {
+                point->nearest.emplace_back(point, pointById(id));
             }
         }
-
-        for (int i = 0; i < (*itThis)->nEndPoints; i++) {
-            std::sort((*itThis)->endpoints[i]->nearest.begin(), (*itThis)->endpoints[i]->nearest.end(), OrderingGroupNeighbor::Compare);
-        }
     }
 
     // =========== Step 1: Create a simple nearest neighbor chain ===========
@@ -915,6 +1081,14 @@ void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
         crnt = crnt->GetOtherEndGroup();
         crnt->UsePoint();
 
+        // Used points are never searched for again, except the start point of the first segment
+        for (int i = 0; i < crnt->group->nEndPoints; i++) {
+            OrderingGroupPoint *point = crnt->group->endpoints[i];
+            if (point->used && point != groups->front()->endpoints[0]) {
+                grid.Remove(point->point, 4 * crnt->group->index + i);
+            }
+        }
+
         // if this is the last segment, Mark start point of first segment as unused,
         // so that the end can connect to it
         if (nConnected == groups->size() - 1) {
@@ -923,6 +1097,14 @@ void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
 
         // connect to next segment
         OrderingGroupNeighbor *nghb = crnt->FindNearestUnused();
+        if (!nghb) {
+            // All of the nearest neighbors are used, so search further away
+            ids.clear();
+            grid.FindNearest(crnt->point, 1, [&pointById](int id) { return !pointById(id)->used; }, ids);
+            assert(ids.size() == 1);
+            crnt->nearest.emplace_back(crnt, pointById(ids.front()));
+            nghb = &crnt->nearest.back();
+        }
         connections.push_back(new OrderingGroupConnection(crnt, nghb->point, connections.size()));
         total += nghb->distance;
         crnt = nghb->point;
@@ -939,52 +1121,106 @@ void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
 
     // =========== Step 2: Choose nDims segments to clear and reconnect ===========
 
-    bool improvement;
     int nRuns = 0;
     int nTrials = 0;
     int nImprovements = 0;
 
-    do {
-        improvement = false;
-        nRuns ++;
-        std::vector< std::vector<OrderingGroupConnection *>::iterator > iterators;
+    // Clear and reconnect the given connections, which must be in tour order
+    auto reconnect = [&](std::vector<OrderingGroupConnection *> &changedconnections) {
+        nTrials ++;
 
-        for (
-            triangleit_begin(iterators, connections.begin(), connections.end(), nDims);
-            triangleit_test(iterators, connections.end());
-            triangleit_incr(iterators, connections.end())
-        ) {
-            nTrials ++;
+        Coord dist = 0;
 
-            Coord dist = 0;
+        std::vector<OrderingSegment> segments(changedconnections.size());
+        OrderingGroupConnection *prev = changedconnections.back();
 
-            std::vector<OrderingSegment> segments(iterators.size());
-            std::vector<OrderingGroupConnection *> changedconnections;
-            changedconnections.reserve(3);
-            OrderingGroupConnection *prev = *iterators.back();
+        for (size_t i = 0; i < changedconnections.size(); i++) {
+            dist += changedconnections[i]->Distance();
+            segments[i].AddPoint(prev->points[1]);
+            segments[i].AddPoint(changedconnections[i]->points[0]);
+            prev = changedconnections[i];
+        }
 
+        if (FindShortestReconnect(segments, changedconnections, connections, &longestConnect, &total, dist)) {
+            nImprovements ++;
 
-            for (size_t i = 0; i < iterators.size(); i++) {
-                dist += (*iterators[i])->Distance();
-                segments[i].AddPoint(prev->points[1]);
-                segments[i].AddPoint((*iterators[i])->points[0]);
-                prev = *iterators[i];
-                changedconnections.push_back(*iterators[i]);
-            }
+            AssertIsTour(*groups, connections, longestConnect);
+            LinearizeTour(connections);
+            AssertIsTour(*groups, connections, longestConnect);
+            return true;
+        }
+        return false;
+    };
 
-            if (FindShortestReconnect(segments, changedconnections, connections, &longestConnect, &total, dist)) {
-                nImprovements ++;
+    // Try all combinations of nDims connections if there are not too many,
+    // otherwise only combinations of connections which are near to each other
+    double nCombinations = 1.0;
+    for (int i = 0; i < nDims; i++) {
+        nCombinations *= double(connections.size() - i) / (i + 1);
+    }
+    bool const exhaustive = nCombinations <= MAX_EXHAUSTIVE_TRIALS;
 
-                AssertIsTour(*groups, connections, longestConnect);
-                LinearizeTour(connections);
-                AssertIsTour(*groups, connections, longestConnect);
-                improvement = true;
+    constexpr int maxRuns = 10;
+    bool improvement;
+    bool stop = budget.Expired(0.2);
+    std::vector<OrderingGroupConnection *> changedconnections;
+    changedconnections.reserve(nDims);
+
+    do {
+        improvement = false;
+        nRuns ++;
+
+        if (exhaustive) {
+            std::vector< std::vector<OrderingGroupConnection *>::iterator > iterators;
+
+            for (
+                triangleit_begin(iterators, connections.begin(), connections.end(), nDims);
+                triangleit_test(iterators, connections.end()) && !stop;
+                triangleit_incr(iterators, connections.end())
+            ) {
+                changedconnections.clear();
+                for (auto &it : iterators) {
+                    changedconnections.push_back(*it);
+                }
+                improvement |= reconnect(changedconnections);
+                stop = budget.Expired(0.2 + 0.8 * (nRuns - 1 + double(iterators.front() - connections.begin()) / connections.size()) / maxRuns);
+            }
+        } else {
+            std::vector<OrderingGroupConnection *> near;
+            std::vector< std::vector<OrderingGroupConnection *>::iterator > iterators;
+
+            // Note: the tour is linearized after each improvement, so connections may move around
+            for (size_t iConnection = 0; iConnection < connections.size() && !stop; iConnection++) {
+                OrderingGroupConnection *connection = connections[iConnection];
+                FindNearConnections(connection, near);
+
+                for (
+                    triangleit_begin(iterators, near.begin(), near.end(), nDims - 1);
+                    triangleit_test(iterators, near.end()) && !stop;
+                    triangleit_incr(iterators, near.end())
+                ) {
+                    changedconnections.clear();
+                    changedconnections.push_back(connection);
+                    for (auto &it : iterators) {
+                        changedconnections.push_back(*it);
+                    }
+                    std::sort(changedconnections.begin(), changedconnections.end(),
+                              [](OrderingGroupConnection *a, OrderingGroupConnection *b) { return a->index < b->index; });
+                    bool const improved = reconnect(changedconnections);
+                    stop = budget.Expired(0.2 + 0.8 * (nRuns - 1 + double(iConnection) / connections.size()) / maxRuns);
+                    if (improved) {
+                        improvement = true;
+                        // The near connections are no longer in tour order
+                        break;
+                    }
+                }
             }
         }
-    } while (improvement && nRuns < 10);
+    } while (improvement && !stop && nRuns < maxRuns);
 
     DebugTrace1TSP(("Finished after %d rounds, %d trials, %d improvements", nRuns, nTrials, nImprovements));
 
+
     // =========== Step N: Create vector of groups from vector of connection points ===========
 
     std::vector<OrderingGroup *> result;
@@ -1012,12 +1248,14 @@ void OrderGroups(std::vector<OrderingGroup *> *groups, const int nDims)
 
 // Global optimization of path length
 
-void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims)
+void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims, const OrderingControl &control)
 {
     if (infos.size() < 3) {
         return;
     }
 
+    OrderingBudget budget(control);
+
     // Create extended ordering info vector and copy data from normal ordering info
     std::vector<OrderingInfoEx *> infoex;
     infoex.reserve(infos.size());
@@ -1035,9 +1273,16 @@ void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims)
 
     // Find closest 2 points for each point and enforce that 2nd nearest is not further away than 1.8xthe nearest
     // If this is not the case, clear nearest and 2nd nearest point
+    std::vector<std::pair<Point, int>> points;
+    points.reserve(2 * infoex.size());
+    for (auto info : infoex) {
+        points.emplace_back(info->beg.point, 2 * info->idx);
+        points.emplace_back(info->end.point, 2 * info->idx + 1);
+    }
+    PointGrid grid(points);
     for (std::vector<OrderingInfoEx *>::iterator it = infoex.begin(); it != infoex.end(); ++it) {
-        (*it)->beg.FindNearest2(infoex);
-        (*it)->end.FindNearest2(infoex);
+        (*it)->beg.FindNearest2(infoex, grid);
+        (*it)->end.FindNearest2(infoex, grid);
     }
 
     DebugTraceGrouping(
@@ -1103,7 +1348,7 @@ void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims)
     )
 
     // Order groups, so that the connection path gets shortest
-    OrderGroups(&groups, nDims);
+    OrderGroups(&groups, nDims, budget);
 
     // Copy grouped lines to output
     for (auto & group : groups) {
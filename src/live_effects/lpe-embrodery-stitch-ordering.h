@@ -10,6 +10,8 @@
 #ifndef INKSCAPE_LPE_EMBRODERY_STITCH_ORDERING_H
 #define INKSCAPE_LPE_EMBRODERY_STITCH_ORDERING_H
 
+#include <functional>
+
 #include "live_effects/effect.h"
 
 namespace Inkscape {
@@ -49,6 +51,7 @@ struct OrderingInfo {
 // This keeps information about the two nearest neighbor points.
 
 struct OrderingInfoEx;
+class PointGrid;
 
 struct OrderingPoint {
     OrderingPoint(const Geom::Point &pointIn, OrderingInfoEx *infoexIn, bool beginIn) :
@@ -69,8 +72,8 @@ struct OrderingPoint {
     {
         return nearest[0] || nearest[1];
     }
-    // Find 2 nearest points to given point
-    void FindNearest2(const std::vector<OrderingInfoEx *> &infos);
+    // Find 2 nearest points to given point, using a grid of all begin and end points of infos
+    void FindNearest2(const std::vector<OrderingInfoEx *> &infos, const PointGrid &grid);
     // Check if "this" is among the nearest of its nearest
     void EnforceMutual();
     // Check if the subpath indices of this and other are the same, otherwise zero both nearest
@@ -146,7 +149,7 @@ struct OrderingGroupPoint {
     {
     }
 
-    // Find the nearest unused neighbor point
+    // Find the nearest unused neighbor point, 0 if all neighbors are used
     OrderingGroupNeighbor *FindNearestUnused();
     // Return the other end in the group of the point
     OrderingGroupPoint *GetOtherEndGroup();
@@ -179,7 +182,8 @@ struct OrderingGroupPoint {
     bool front;
     // True if the point is used/connected to another point
     bool used;
-    // The nearest neighbors, to which this group end point may connect
+    // The nearest neighbors, to which this group end point may connect, sorted by distance.
+    // For large inputs only the nearest few neighbors are kept.
     std::vector<OrderingGroupNeighbor> nearest;
 };
 
@@ -295,6 +299,17 @@ struct OrderingSegment {
 };
 
 
+// Limits and feedback for the global optimization, which can take long on large inputs
+
+struct OrderingControl {
+    // Number of reconnections tried after which the optimization stops with the best ordering found so far,
+    // 0 for no limit. Unlike a time limit, this gives the same ordering on any machine.
+    size_t maxTrials = 0;
+    // Called from time to time with the fraction of the work done (0..1).
+    // If it returns false, the optimization stops with the best ordering found so far.
+    std::function<bool(double)> progress;
+};
+
 // Sub-path reordering: do nothing - keep original order
 void OrderingOriginal(std::vector<OrderingInfo> &infos);
 
@@ -305,7 +320,7 @@ void OrderingZigZag(std::vector<OrderingInfo> &infos, bool revfirst);
 void OrderingClosest(std::vector<OrderingInfo> &infos, bool revfirst);
 
 // Global optimization of path length
-void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims);
+void OrderingAdvanced(std::vector<OrderingInfo> &infos, int nDims, const OrderingControl &control = OrderingControl());
 
 } //LPEEmbroderyStitchOrdering
 } //namespace LivePathEffect
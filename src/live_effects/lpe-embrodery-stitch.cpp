@@ -62,9 +62,11 @@ LPEEmbroderyStitch::LPEEmbroderyStitch(LivePathEffectObject *lpeobject) :
     stitch_pattern(_("Stitch pattern"), _("Select between different stitch patterns"), "stitch_pattern", &wr, this, 0),
     show_stitches(_("Show stitches"), _("Creates gaps between stitches (use only for preview, deactivate for use with embroidery machines)"), "show-stitches", &wr, this, false),
     show_stitch_gap(_("Show stitch gap"), _("Length of the gap between stitches when showing stitches"), "show-stitch-gap", &wr, this, 0.5),
-    jump_if_longer(_("Jump if longer"), _("Jump connection if longer than"), "jump-if-longer", &wr, this, 100)
+    jump_if_longer(_("Jump if longer"), _("Jump connection if longer than"), "jump-if-longer", &wr, this, 100),
+    ordering_trial_limit(_("Ordering trial limit"), _("Number of reconnections tried to improve a traveling salesman ordering (0 for no limit)"), "ordering-trial-limit", &wr, this, 0)
 {
     registerParameter(dynamic_cast<Parameter *>(&ordering));
+    registerParameter(dynamic_cast<Parameter *>(&ordering_trial_limit));
     registerParameter(dynamic_cast<Parameter *>(&connection));
     registerParameter(dynamic_cast<Parameter *>(&stitch_length));
     registerParameter(dynamic_cast<Parameter *>(&stitch_min_length));
@@ -81,6 +83,8 @@ LPEEmbroderyStitch::LPEEmbroderyStitch(LivePathEffectObject *lpeobject) :
     stitch_pattern.param_set_range(0, 2);
     show_stitch_gap.param_set_range(0.001, 10);
     jump_if_longer.param_set_range(0.0, 1000000);
+    ordering_trial_limit.param_make_integer();
+    ordering_trial_limit.param_set_range(0, 1e9);
 }
 
 LPEEmbroderyStitch::~LPEEmbroderyStitch() = default;
@@ -216,7 +220,10 @@ PathVector LPEEmbroderyStitch::doEffect_path(PathVector const &path_in)
             info.endOrig = it->back().finalPoint();
         }
 
-        // Compute sub-path ordering
+        // Compute sub-path ordering. The path is ordered again on every update, so the global
+        // optimization can be limited to a number of trials, which keeps the result reproducible.
+        OrderingControl control;
+        control.maxTrials = static_cast<size_t>(ordering_trial_limit);
         switch (ordering.get_value()) {
         case order_method_no_reorder:
             OrderingOriginal(orderinginfos);
@@ -239,19 +246,19 @@ PathVector LPEEmbroderyStitch::doEffect_path(PathVector const &path_in)
             break;
 
         case order_method_tsp_kopt_2:
-            OrderingAdvanced(orderinginfos, 2);
+            OrderingAdvanced(orderinginfos, 2, control);
             break;
 
         case order_method_tsp_kopt_3:
-            OrderingAdvanced(orderinginfos, 3);
+            OrderingAdvanced(orderinginfos, 3, control);
             break;
 
         case order_method_tsp_kopt_4:
-            OrderingAdvanced(orderinginfos, 4);
+            OrderingAdvanced(orderinginfos, 4, control);
             break;
 
         case order_method_tsp_kopt_5:
-            OrderingAdvanced(orderinginfos, 5);
+            OrderingAdvanced(orderinginfos, 5, control);
             break;
 
         }
@@ -58,6 +58,7 @@ private:
     BoolParam show_stitches;
     ScalarParam show_stitch_gap;
     ScalarParam jump_if_longer;
+    ScalarParam ordering_trial_limit;
 
     LPEEmbroderyStitch(const LPEEmbroderyStitch &) = delete;
     LPEEmbroderyStitch &operator=(const LPEEmbroderyStitch &) = delete;
@@ -37,6 +37,8 @@ public:
     void transform_multiply(Geom::Affine const &postmul, bool set) override;
 
     Geom::Piecewise<Geom::D2<Geom::SBasis> > doEffect_pwd2 (Geom::Piecewise<Geom::D2<Geom::SBasis> > const & pwd2_in) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 
     void resetDefaults(SPItem const* item) override;
 
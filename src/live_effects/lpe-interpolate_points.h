@@ -27,6 +27,8 @@ public:
     ~LPEInterpolatePoints() override;
 
     Geom::PathVector doEffect_path (Geom::PathVector const & path_in) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 
 private:
     EnumParam<unsigned> interpolator_type;
@@ -27,6 +27,8 @@ public:
     void doOnRemove(SPLPEItem const* lpeitem) override;
     void transform_multiply(Geom::Affine const &postmul, bool set) override;
     Geom::PathVector doEffect_path (Geom::PathVector const & path_in) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 
 private:
     LPEJoinType(const LPEJoinType&) = delete;
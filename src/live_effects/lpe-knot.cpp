@@ -13,7 +13,9 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <gdk/gdk.h>
+#include <numeric>
 #include <optional>
 
 #include <2geom/sbasis-to-bezier.h>
@@ -163,59 +165,81 @@ findShadowedTime(Geom::Path const &patha, std::vector<Geom::Point> const &pt_and
 
 namespace LPEKnotNS {//just in case...
 CrossingPoints::CrossingPoints(Geom::PathVector const &paths) : std::vector<CrossingPoint>(){
-//    std::cout<<"\nCrossingPoints creation from path vector\n";
-    for( unsigned i=0; i<paths.size(); i++){
-        for( unsigned ii=0; ii < size_nondegenerate(paths[i]); ii++){
-            for( unsigned j=i; j<paths.size(); j++){
-                for( unsigned jj=(i==j?ii:0); jj < size_nondegenerate(paths[j]); jj++){
-                    std::vector<std::pair<double,double> > times;
-                    if ( (i==j) && (ii==jj) ) {
-
-//                         std::cout<<"--(self int)\n";
-//                         std::cout << paths[i][ii].toSBasis()[Geom::X] <<"\n";
-//                         std::cout << paths[i][ii].toSBasis()[Geom::Y] <<"\n";
-
-                        find_self_intersections( times, paths[i][ii].toSBasis() );
-                    } else {
-//                         std::cout<<"--(pair int)\n";
-//                         std::cout << paths[i][ii].toSBasis()[Geom::X] <<"\n";
-//                         std::cout << paths[i][ii].toSBasis()[Geom::Y] <<"\n";
-//                         std::cout<<"with\n";
-//                         std::cout << paths[j][jj].toSBasis()[Geom::X] <<"\n";
-//                         std::cout << paths[j][jj].toSBasis()[Geom::Y] <<"\n";
-
-                        find_intersections( times, paths[i][ii].toSBasis(), paths[j][jj].toSBasis() );
-                    }
-                    for (auto & time : times){
-                        //std::cout<<"intersection "<<i<<"["<<ii<<"]("<<times[k].first<<")= "<<j<<"["<<jj<<"]("<<times[k].second<<")\n";
-                        if ( !std::isnan(time.first) && !std::isnan(time.second) ){
-                            double zero = 1e-4;
-                            if ( (i==j) && (fabs(time.first+ii - time.second-jj) <= zero) )
-                            { //this is just end=start of successive curves in a path.
-                                continue;
-                            }
-                            if ( (i==j) && (ii == 0) && (jj == size_nondegenerate(paths[i])-1)
-                                 && paths[i].closed()
-                                 && (fabs(time.first) <= zero)
-                                 && (fabs(time.second - 1) <= zero) )
-                            {//this is just end=start of a closed path.
-                                continue;
-                            }
-                            CrossingPoint cp;
-                            cp.pt = paths[i][ii].pointAt(time.first);
-                            cp.sign = 1;
-                            cp.i = i;
-                            cp.j = j;
-                            cp.ni = 0; cp.nj=0;//not set yet
-                            cp.ti = time.first + ii;
-                            cp.tj = time.second + jj;
-                            push_back(cp);
-                        }else{
-                            std::cerr<<"ooops: find_(self)_intersections returned NaN:" << std::endl;
-                            //std::cout<<"intersection "<<i<<"["<<ii<<"](NaN)= "<<j<<"["<<jj<<"](NaN)\n";
-                        }
-                    }
+    // Convert every curve to SBasis once, and only test the pairs whose bounds overlap, found by
+    // sweeping the bounds from left to right.
+    struct Segment {
+        unsigned i, ii;
+        Geom::Rect bounds;
+        Geom::D2<Geom::SBasis> sb;
+    };
+    std::vector<Segment> segments;
+    for (unsigned i = 0; i < paths.size(); i++) {
+        for (unsigned ii = 0; ii < size_nondegenerate(paths[i]); ii++) {
+            segments.push_back({ i, ii, paths[i][ii].boundsFast(), paths[i][ii].toSBasis() });
+        }
+    }
+
+    std::vector<unsigned> order(segments.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&] (unsigned a, unsigned b) {
+        return segments[a].bounds.left() < segments[b].bounds.left();
+    });
+
+    // Candidate pairs (a, b) with a <= b, which is the order of (i, ii) <= (j, jj).
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    std::vector<unsigned> active;
+    for (auto b : order) {
+        auto const &bounds = segments[b].bounds;
+        active.erase(std::remove_if(active.begin(), active.end(), [&] (unsigned a) {
+            return segments[a].bounds.right() < bounds.left();
+        }), active.end());
+        for (auto a : active) {
+            if (segments[a].bounds[Geom::Y].intersects(bounds[Geom::Y])) {
+                pairs.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        pairs.emplace_back(b, b);
+        active.push_back(b);
+    }
+    // Keep the crossings in the order of an exhaustive search, as they are referred to by index.
+    std::sort(pairs.begin(), pairs.end());
+
+    for (auto const &[a, b] : pairs) {
+        unsigned const i = segments[a].i, ii = segments[a].ii;
+        unsigned const j = segments[b].i, jj = segments[b].ii;
+        std::vector<std::pair<double,double> > times;
+        if ( (i==j) && (ii==jj) ) {
+            find_self_intersections( times, segments[a].sb );
+        } else {
+            find_intersections( times, segments[a].sb, segments[b].sb );
+        }
+        for (auto & time : times){
+            //std::cout<<"intersection "<<i<<"["<<ii<<"]("<<times[k].first<<")= "<<j<<"["<<jj<<"]("<<times[k].second<<")\n";
+            if ( !std::isnan(time.first) && !std::isnan(time.second) ){
+                double zero = 1e-4;
+                if ( (i==j) && (fabs(time.first+ii - time.second-jj) <= zero) )
+                { //this is just end=start of successive curves in a path.
+                    continue;
+                }
+                if ( (i==j) && (ii == 0) && (jj == size_nondegenerate(paths[i])-1)
+                     && paths[i].closed()
+                     && (fabs(time.first) <= zero)
+                     && (fabs(time.second - 1) <= zero) )
+                {//this is just end=start of a closed path.
+                    continue;
                 }
+                CrossingPoint cp;
+                cp.pt = paths[i][ii].pointAt(time.first);
+                cp.sign = 1;
+                cp.i = i;
+                cp.j = j;
+                cp.ni = 0; cp.nj=0;//not set yet
+                cp.ti = time.first + ii;
+                cp.tj = time.second + jj;
+                push_back(cp);
+            }else{
+                std::cerr<<"ooops: find_(self)_intersections returned NaN:" << std::endl;
+                //std::cout<<"intersection "<<i<<"["<<ii<<"](NaN)= "<<j<<"["<<jj<<"](NaN)\n";
             }
         }
     }
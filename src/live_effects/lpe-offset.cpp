@@ -438,6 +438,20 @@ sp_simplify_pathvector(Geom::PathVector original_pathv, double threshold)
     return pathliv->MakePathVector();
 }
 
+bool LPEOffset::isCacheable() const
+{
+    // While dragging the knot the tolerance is lowered, and on a group every run also collects
+    // its output for the knot.
+    return !liveknot && !is<SPGroup>(sp_lpe_item) && hasOnlyOwnParams();
+}
+
+void LPEOffset::addCacheDependencies(std::vector<Glib::ustring> &dependencies) const
+{
+    SPCSSAttr *css = sp_repr_css_attr(current_shape->getRepr(), "style");
+    dependencies.emplace_back(sp_repr_css_property(css, "fill-rule", ""));
+    sp_repr_css_attr_unref(css);
+}
+
 Geom::PathVector 
 LPEOffset::doEffect_path(Geom::PathVector const & path_in)
 {
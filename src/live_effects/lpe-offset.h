@@ -43,6 +43,8 @@ public:
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
     void doAfterEffect(SPLPEItem const * /*lpeitem*/, SPCurve *curve) override;
     Geom::PathVector doEffect_path (Geom::PathVector const & path_in) override;
+    bool isCacheable() const override;
+    void addCacheDependencies(std::vector<Glib::ustring> &dependencies) const override;
     bool doOnOpen(SPLPEItem const *lpeitem) override;
     void doOnApply(SPLPEItem const* lpeitem) override;
     void transform_multiply(Geom::Affine const &postmul, bool set) override;
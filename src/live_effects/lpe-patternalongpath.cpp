@@ -17,6 +17,7 @@
 #include "display/curve.h"
 
 #include "object/sp-shape.h"
+#include "svg/svg.h"
 
 #include "ui/knot/knot-holder.h"
 #include "ui/knot/knot-holder-entity.h"
@@ -135,6 +136,20 @@ void LPEPatternAlongPath::transform_multiply(Geom::Affine const &postmul, bool /
     }
 }
 
+bool LPEPatternAlongPath::isCacheable() const
+{
+    return hasOnlyOwnParams({&pattern});
+}
+
+void LPEPatternAlongPath::addCacheDependencies(std::vector<Glib::ustring> &dependencies) const
+{
+    // A linked pattern is serialized as a reference; what is read of it is its path and where it is.
+    if (auto item = cast<SPItem>(pattern.getObject())) {
+        dependencies.emplace_back(sp_svg_write_path(pattern.get_pathvector()));
+        dependencies.emplace_back(sp_svg_transform_write(item->i2doc_affine()));
+    }
+}
+
 void
 LPEPatternAlongPath::doBeforeEffect (SPLPEItem const* lpeitem)
 {
@@ -42,6 +42,8 @@ public:
     ~LPEPatternAlongPath() override;
 
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
+    bool isCacheable() const override;
+    void addCacheDependencies(std::vector<Glib::ustring> &dependencies) const override;
     Geom::Piecewise<Geom::D2<Geom::SBasis> > doEffect_pwd2 (Geom::Piecewise<Geom::D2<Geom::SBasis> > const & pwd2_in) override;
     bool doOnOpen(SPLPEItem const *lpeitem) override;
     void transform_multiply(Geom::Affine const &postmul, bool set) override;
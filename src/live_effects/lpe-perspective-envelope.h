@@ -34,6 +34,8 @@ public:
     ~LPEPerspectiveEnvelope() override;
 
     void doEffect(SPCurve *curve) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 
     virtual Geom::Point projectPoint(Geom::Point p);
 
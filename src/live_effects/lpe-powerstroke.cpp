@@ -211,6 +211,14 @@ LPEPowerStroke::doBeforeEffect(SPLPEItem const *lpeItem)
     }
 }
 
+bool LPEPowerStroke::isCacheable() const
+{
+    // The widths are stored in offset_points; the stroke width and style are only read when the
+    // effect is applied. Adjusting the control points to a new path, or keeping the previous
+    // output while a knot is dragged, depends on earlier runs.
+    return !adjust_path && !knotdragging && !has_recursion && hasOnlyOwnParams();
+}
+
 void LPEPowerStroke::applyStyle(SPLPEItem *lpeitem)
 {
     lpe_shape_convert_stroke_and_fill(cast<SPShape>(lpeitem));
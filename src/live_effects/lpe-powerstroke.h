@@ -42,6 +42,7 @@ public:
     
     Geom::PathVector doEffect_path (Geom::PathVector const & path_in) override;
     void doBeforeEffect(SPLPEItem const *lpeItem) override;
+    bool isCacheable() const override;
     void doOnApply(SPLPEItem const* lpeitem) override;
     void doOnRemove(SPLPEItem const* lpeitem) override;
     void doAfterEffect(SPLPEItem const *lpeitem, SPCurve *curve) override;
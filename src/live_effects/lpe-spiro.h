@@ -24,6 +24,8 @@ public:
     LPEPathFlashType pathFlashType() const override { return SUPPRESS_FLASH; }
 
     void doEffect(SPCurve * curve) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 };
 
 void sp_spiro_do_effect(SPCurve &curve);
@@ -31,6 +31,8 @@ public:
     void doOnApply (SPLPEItem const* lpeitem) override;
 
     Geom::Piecewise<Geom::D2<Geom::SBasis> > doEffect_pwd2 (Geom::Piecewise<Geom::D2<Geom::SBasis> > const & pwd2_in) override;
+    bool isCacheable() const override { return hasOnlyOwnParams(); }
+    bool isConcurrencySafe() const override { return true; }
 
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
 
@@ -988,7 +988,10 @@ void SPGroup::update_patheffect(bool write) {
 #ifdef GROUP_VERBOSE
     g_message("sp_group_update_patheffect: %p\n", lpeitem);
 #endif
-    for (auto sub_item : item_list()) {
+    auto const sub_items = item_list();
+    // Compute the effects of independent children concurrently; the loop below then writes them.
+    sp_lpe_item_precompute_patheffects(sub_items);
+    for (auto sub_item : sub_items) {
         if (sub_item) {
             // don't need lpe version < 1 (issue only reply on lower LPE on nested LPEs
             // this doesn't happen because it's done at very first stage
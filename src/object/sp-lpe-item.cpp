@@ -16,10 +16,12 @@
 #ifdef HAVE_CONFIG_H
 #endif
 
+#include <algorithm>
 #include <glibmm/i18n.h>
 
 #include "bad-uri-exception.h"
 
+#include "async/scheduler.h"
 #include "attributes.h"
 #include "desktop.h"
 #include "display/curve.h"
@@ -296,12 +298,17 @@ bool SPLPEItem::performOnePathEffect(SPCurve *curve, SPShape *current, Inkscape:
                 current->bbox_geom_cache_is_valid = false;
             }
             auto group = cast<SPGroup>(this);
-            if (!group && !is_clip_or_mask) {
+            // Shapes precomputed concurrently have already been prepared for this curve.
+            if (!group && !is_clip_or_mask && !lpe->takePreparedBeforeEffect(current, *curve)) {
                 lpe->doBeforeEffect_impl(this);
             }
 
             try {
-                lpe->doEffect(curve);
+                if (!group && !is_clip_or_mask) {
+                    lpe->doEffect_memoized(curve);
+                } else {
+                    lpe->doEffect(curve);
+                }
                 lpe->has_exception = false;
             }
 
@@ -410,6 +417,27 @@ void SPLPEItem::update_patheffect(bool /*write*/) {
     //throw;
 }
 
+/**
+ * The only effect of a shape, if it can be computed concurrently with those of other shapes.
+ */
+static Inkscape::LivePathEffect::Effect *sp_lpe_item_concurrent_effect(SPItem *item)
+{
+    auto shape = cast<SPShape>(item);
+    if (!shape || !shape->hasPathEffect() || !shape->pathEffectsEnabled() ||
+        shape->path_effect_list->size() != 1 || !shape->curveForEdit())
+    {
+        return nullptr;
+    }
+    auto lpeobj = shape->path_effect_list->front()->lpeobject;
+    auto lpe = lpeobj ? lpeobj->get_lpe() : nullptr;
+    if (!lpe || !lpe->isVisible() || !lpe->isConcurrencySafe() || !lpe->isCacheable() ||
+        (lpe->acceptsNumClicks() > 0 && !lpe->isReady()))
+    {
+        return nullptr;
+    }
+    return lpe;
+}
+
 /**
  * Calls any registered handlers for the update_patheffect action
  */
@@ -425,6 +453,16 @@ sp_lpe_item_update_patheffect (SPLPEItem *lpeitem, bool wholetree, bool write, b
     if (!lpeitem->pathEffectsEnabled())
         return;
 
+    if (sp_lpe_item_concurrent_effect(lpeitem)) {
+        auto parent = cast<SPLPEItem>(lpeitem->parent);
+        // Shapes inside a group with effects are updated through the group.
+        if ((!wholetree || !parent || !parent->hasPathEffectRecursive()) &&
+            lpeitem->document->queuePathEffectUpdate(lpeitem, write, with_satellites))
+        {
+            return;
+        }
+    }
+
     SPLPEItem *top = nullptr;
 
     if (wholetree) {
@@ -445,6 +483,54 @@ sp_lpe_item_update_patheffect (SPLPEItem *lpeitem, bool wholetree, bool write, b
     }
 }
 
+/**
+ * Compute the path effects of several independent items ahead of their update_patheffect() calls.
+ * Shapes whose stack is a single effect that is safe to run concurrently are prepared on the main
+ * thread, then their geometry is computed on the thread pool. The serial update that follows reuses
+ * the results through Effect::doEffect_memoized(), so it only has to write them to the document.
+ */
+void sp_lpe_item_precompute_patheffects(std::vector<SPItem *> const &items)
+{
+    std::vector<std::pair<SPShape *, Inkscape::LivePathEffect::Effect *>> candidates;
+    for (auto item : items) {
+        auto lpe = sp_lpe_item_concurrent_effect(item);
+        if (!lpe) {
+            continue;
+        }
+        // An effect shared by several items only remembers the result for one of them.
+        if (std::any_of(candidates.begin(), candidates.end(), [&] (auto const &c) { return c.second == lpe; })) {
+            continue;
+        }
+        candidates.emplace_back(cast<SPShape>(item), lpe);
+    }
+
+    // Only worth the scheduling when there is work to share.
+    if (candidates.size() < 2) {
+        return;
+    }
+
+    std::vector<Inkscape::LivePathEffect::Effect *> effects;
+    for (auto [shape, lpe] : candidates) {
+        // The same preparation as SPShape::update_patheffect() and SPLPEItem::performOnePathEffect().
+        auto curve = *shape->curveForEdit();
+        shape->setCurveInsync(&curve);
+        lpe->setCurrentShape(shape);
+        lpe->pathvector_before_effect = curve.get_pathvector();
+        if (lpe->lpeversion.param_getSVGValue() != "0") {
+            shape->bbox_vis_cache_is_valid = false;
+            shape->bbox_geom_cache_is_valid = false;
+        }
+        lpe->doBeforeEffect_impl(shape);
+        if (lpe->prepareConcurrentEffect(curve)) {
+            effects.push_back(lpe);
+        }
+    }
+
+    Inkscape::Async::Scheduler::get().parallel_for(0, static_cast<int>(effects.size()), [&] (int i) {
+        effects[i]->runConcurrentEffect();
+    });
+}
+
 /**
  * Gets called when any of the lpestack's lpeobject repr contents change: i.e. parameter change in any of the stacked LPEs
  */
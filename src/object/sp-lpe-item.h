@@ -18,6 +18,7 @@
 #include <list>
 #include <string>
 #include <memory>
+#include <vector>
 #include "sp-item.h"
 
 class LivePathEffectObject;
@@ -128,6 +129,7 @@ public:
 };
 void sp_lpe_item_update_patheffect (SPLPEItem *lpeitem, bool wholetree, bool write, bool with_satellites = false); // careful, class already has method with *very* similar name!
 void sp_lpe_item_enable_path_effects(SPLPEItem *lpeitem, bool enable);
+void sp_lpe_item_precompute_patheffects(std::vector<SPItem *> const &items);
 
 #endif /* !SP_LPE_ITEM_H_SEEN */
 
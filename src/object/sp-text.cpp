@@ -27,11 +27,13 @@
 #include <2geom/affine.h>
 #include <libnrtype/font-factory.h>
 #include <libnrtype/font-instance.h>
+#include <libnrtype/shaping-cache.h>
 
 #include <glibmm/i18n.h>
 #include <glibmm/regex.h>
 
 #include "svg/svg.h"
+#include "async/scheduler.h"
 #include "display/drawing-text.h"
 #include "attributes.h"
 #include "document.h"
@@ -190,6 +192,11 @@ void SPText::update(SPCtx *ctx, guint flags) {
             }
         }
 
+        if (views.empty() && document->queueTextLayout(this)) {
+            // Nothing to show yet; laid out with the other texts at the end of the update.
+            return;
+        }
+
         /* fixme: It is not nice to have it here, but otherwise children content changes does not work */
         /* fixme: Even now it may not work, as we are delayed */
         /* fixme: So check modification flag everywhere immediate state is used */
@@ -885,15 +892,43 @@ SPCurve SPText::getNormalizedBpath() const
 }
 
 void SPText::rebuildLayout()
+{
+    _prepareLayout();
+    layout.calculateFlow();
+    _finishLayout();
+}
+
+void SPText::rebuildLayouts(std::vector<SPText *> const &texts)
+{
+    for (auto text : texts) {
+        text->_prepareLayout();
+    }
+
+    // The singletons used by the layout may only be created on the main thread.
+    FontFactory::get();
+    Inkscape::Text::ShapingCache::get();
+
+    // Only reads the input and the styles it points to, and writes to each layout.
+    Inkscape::Async::Scheduler::get().parallel_for(0, texts.size(), [&] (int i) {
+        texts[i]->layout.calculateFlow();
+    });
+
+    for (auto text : texts) {
+        text->_finishLayout();
+    }
+}
+
+void SPText::_prepareLayout()
 {
     layout.clear();
     _buildLayoutInit();
 
     Inkscape::Text::Layout::OptionalTextTagAttrs optional_attrs;
     _buildLayoutInput(this, optional_attrs, 0, false);
+}
 
-    layout.calculateFlow();
-
+void SPText::_finishLayout()
+{
     for (auto& child: children) {
         if (is<SPTextPath>(&child)) {
             SPTextPath const *textpath = cast<SPTextPath>(&child);
@@ -47,6 +47,9 @@ public:
     /** Completely recalculates the layout. */
     void rebuildLayout();
 
+    /** Same as calling rebuildLayout() on each text, but calculates the layouts concurrently. */
+    static void rebuildLayouts(std::vector<SPText *> const &texts);
+
     //semiprivate:  (need to be accessed by the C-style functions still)
     TextTagAttributes attributes;
     Inkscape::Text::Layout layout;
@@ -91,6 +94,11 @@ private:
     /** Initializes layout from <text> (i.e. this node). */
     void _buildLayoutInit();
 
+    /** The parts of rebuildLayout() before and after calculating the flow, which read and
+    write the object tree and so must run on the main thread. */
+    void _prepareLayout();
+    void _finishLayout();
+
     /** Recursively walks the xml tree adding tags and their contents. The
     non-trivial code does two things: firstly, it manages the positioning
     attributes and their inheritance rules, and secondly it keeps track of line
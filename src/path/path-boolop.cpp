@@ -11,6 +11,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include <glibmm/i18n.h>
@@ -23,6 +25,9 @@
 
 #include "message-stack.h"
 #include "path-chemistry.h"     // copy_object_properties()
+#include "preferences.h"
+
+#include "async/scheduler.h"
 
 #include "helper/geom.h"        // pathv_to_linear_and_cubic_beziers()
 
@@ -391,6 +396,206 @@ sp_pathvector_boolop(Geom::PathVector const &pathva, Geom::PathVector const &pat
     return outres;
 }
 
+BoolOpBackend get_boolop_backend()
+{
+    auto prefs = Inkscape::Preferences::get();
+    return prefs->getString("/options/booleans/backend") == "2geom" ? BoolOpBackend::Geom : BoolOpBackend::Livarot;
+}
+
+/**
+ * Whether the area filled by the path vector with the given rule is the one
+ * Geom::PathIntersectionGraph sees in it, so that it can be handed over as it is: the graph only
+ * looks for crossings between its two operands, and tells inside from outside by parity.
+ */
+static bool is_clean_operand(Geom::PathVector const &pathv, FillRule fill)
+{
+    if (fill != fill_oddEven && pathv.size() > 1) {
+        // Nested subpaths winding the same way fill differently with the non-zero rule.
+        return false;
+    }
+    return pathv.intersectSelf().empty();
+}
+
+/**
+ * Boolean operation with Geom::PathIntersectionGraph, which keeps the curves of the operands
+ * rather than flattening and refitting them as livarot does.
+ *
+ * Operands that cross themselves, or whose fill rule makes a difference, are first uncrossed with
+ * sp_flatten(). If the graph cannot be built, the operation is tried once more on uncrossed
+ * operands, whose coordinates livarot has snapped to its fixed grid.
+ *
+ * @param bop Any operation but bool_op_slice. Differences are B minus A, as in livarot.
+ * @return The result, or nothing if the operation failed and livarot should be used instead.
+ */
+std::optional<Geom::PathVector> sp_pathvector_boolop_2geom(Geom::PathVector const &pathva,
+                                                           Geom::PathVector const &pathvb, bool_op bop,
+                                                           FillRule fra, FillRule frb)
+{
+    if (bop == bool_op_slice) {
+        return {};
+    }
+
+    auto a = pathv_to_linear_and_cubic_beziers(pathva);
+    auto b = pathv_to_linear_and_cubic_beziers(pathvb);
+    bool const clean_a = is_clean_operand(a, fra);
+    bool const clean_b = is_clean_operand(b, frb);
+
+    // An empty operand decides the result by itself, as in ObjectSet::pathBoolOp().
+    if (a.empty() || b.empty()) {
+        bool const resultIsB = ((bop == bool_op_union || bop == bool_op_symdiff) && a.empty())
+                               || (bop == bool_op_inters && b.empty())
+                               || bop == bool_op_diff || bop == bool_op_cut;
+        auto &result = resultIsB ? b : a;
+        if (!(resultIsB ? clean_b : clean_a)) {
+            sp_flatten(result, resultIsB ? frb : fra);
+        }
+        return result;
+    }
+
+    auto run = [bop] (Geom::PathVector const &a, Geom::PathVector const &b) -> std::optional<Geom::PathVector> {
+        try {
+            // dont change tolerande give errors on boolops
+            Geom::PathIntersectionGraph pig(a, b, Geom::EPSILON);
+            if (!pig.valid()) {
+                return {};
+            }
+            switch (bop) {
+                case bool_op_union:
+                    return pig.getUnion();
+                case bool_op_inters:
+                    return pig.getIntersection();
+                case bool_op_diff:
+                    return pig.getBminusA(); // livarot order...
+                case bool_op_symdiff:
+                    return pig.getXOR();
+                case bool_op_cut: {
+                    auto out = pig.getBminusA();
+                    auto tmp = pig.getIntersection();
+                    out.insert(out.end(), tmp.begin(), tmp.end());
+                    return out;
+                }
+                default:
+                    return {};
+            }
+        } catch (Geom::Exception const &e) {
+            g_debug("Path Intersection Graph failed boolops: %s", e.what());
+        }
+        return {};
+    };
+
+    if (clean_a && clean_b) {
+        if (auto out = run(a, b)) {
+            return out;
+        }
+    }
+    sp_flatten(a, fra);
+    sp_flatten(b, frb);
+    return run(a, b);
+}
+
+/**
+ * Fold a boolean operation over many path vectors with sp_pathvector_boolop_2geom(), in the order
+ * ObjectSet::pathBoolOp() uses: the first path vector is A, and each next one is B.
+ *
+ * @return The result, or nothing if any step failed.
+ */
+static std::optional<Geom::PathVector> boolop_2geom_fold(std::vector<Geom::PathVector> const &pathvs,
+                                                         std::vector<FillRule> const &fills, bool_op bop)
+{
+    auto result = pathvs.front();
+    auto fill = fills.front();
+    for (std::size_t i = 1; i < pathvs.size(); i++) {
+        auto out = sp_pathvector_boolop_2geom(result, pathvs[i], bop, fill, fills[i]);
+        if (!out) {
+            return {};
+        }
+        result = std::move(*out);
+        // The result of the graph never crosses itself.
+        fill = fill_oddEven;
+    }
+    return result;
+}
+
+/**
+ * Union or intersection of many livarot paths.
+ *
+ * Folding the operands one by one into the result costs time proportional to the size of the
+ * result at every step. Instead, each operand is turned into a shape once, and the shapes are
+ * merged pairwise in a balanced tree, so that every edge takes part in a logarithmic number of
+ * merges. The conversions and the merges of each level are independent and run concurrently.
+ *
+ * @param paths The operands, already converted with back data. The edges of the result refer to
+ *              them by index, as ConvertToForme() expects.
+ * @param fills The fill rule of each operand.
+ * @param bop Either bool_op_union or bool_op_inters.
+ * @return The resulting shape, owned by the caller.
+ */
+Shape *sp_shape_boolop_nary(std::vector<Path *> const &paths, std::vector<FillRule> const &fills, bool_op bop)
+{
+    g_assert(bop == bool_op_union || bop == bool_op_inters);
+    g_assert(paths.size() == fills.size());
+
+    int const n = paths.size();
+    if (n == 0) {
+        return new Shape;
+    }
+
+    auto &scheduler = Inkscape::Async::Scheduler::get();
+
+    std::vector<std::unique_ptr<Shape>> shapes(n);
+    scheduler.parallel_for(0, n, [&] (int i) {
+        Shape polygon;
+        paths[i]->Fill(&polygon, i);
+        shapes[i] = std::make_unique<Shape>();
+        shapes[i]->ConvertToShape(&polygon, fills[i]);
+    });
+
+    while (shapes.size() > 1) {
+        int const pairs = shapes.size() / 2;
+        std::vector<std::unique_ptr<Shape>> merged(pairs);
+        scheduler.parallel_for(0, pairs, [&] (int i) {
+            auto &a = shapes[2 * i];
+            auto &b = shapes[2 * i + 1];
+            // As in ObjectSet::pathBoolOp(): an empty operand decides the result by itself.
+            bool const zeroA = a->numberOfEdges() == 0;
+            bool const zeroB = b->numberOfEdges() == 0;
+            if (zeroA || zeroB) {
+                bool const resultIsB = bop == bool_op_union ? zeroA : zeroB;
+                merged[i] = std::move(resultIsB ? b : a);
+            } else {
+                merged[i] = std::make_unique<Shape>();
+                merged[i]->Booleen(b.get(), a.get(), bop);
+            }
+        });
+        if (shapes.size() % 2) {
+            merged.push_back(std::move(shapes.back()));
+        }
+        shapes = std::move(merged);
+    }
+
+    return shapes.front().release();
+}
+
+/// Union or intersection of many path vectors, all with the same fill rule.
+Geom::PathVector sp_pathvector_boolop_nary(std::vector<Geom::PathVector> const &pathvs, bool_op bop, FillRule fill)
+{
+    std::vector<Path *> originaux;
+    for (auto const &pathv : pathvs) {
+        originaux.push_back(Path_for_pathvector(pathv_to_linear_and_cubic_beziers(pathv)));
+        originaux.back()->ConvertWithBackData(get_threshold(pathv, 0.1));
+    }
+
+    std::unique_ptr<Shape> shape(sp_shape_boolop_nary(originaux, std::vector<FillRule>(originaux.size(), fill), bop));
+    Path res;
+    res.SetBackData(false);
+    shape->ConvertToForme(&res, originaux.size(), originaux.data());
+
+    for (auto orig : originaux) {
+        delete orig;
+    }
+    return res.MakePathVector();
+}
+
 /**
  * Workaround for buggy Path::Transform() which incorrectly transforms arc commands.
  *
@@ -582,7 +787,33 @@ BoolOpErrors Inkscape::ObjectSet::pathBoolOp(bool_op bop, const bool skip_undo,
     Path::cut_position  *toCut=nullptr;
     int                  nbToCut=0;
 
-    if ( bop == bool_op_inters || bop == bool_op_union || bop == bool_op_diff || bop == bool_op_symdiff ) {
+    // the curve preserving backend, if chosen, does the true boolean ops; livarot takes over if it fails
+    bool done2geom = false;
+    if (get_boolop_backend() == BoolOpBackend::Geom &&
+        (bop == bool_op_inters || bop == bool_op_union || bop == bool_op_diff || bop == bool_op_symdiff)) {
+        std::vector<Geom::PathVector> pathvs;
+        for (auto orig : originaux) {
+            pathvs.push_back(orig->MakePathVector());
+        }
+        if (auto out = boolop_2geom_fold(pathvs, origWind, bop)) {
+            res->LoadPathVector(*out);
+            done2geom = true;
+        } else {
+            g_debug("Path Intersection Graph failed boolops, fallback to livarot");
+        }
+    }
+
+    if (done2geom) {
+        // res already holds the result
+    } else if ((bop == bool_op_inters || bop == bool_op_union) && nbOriginaux > 2) {
+        // associative operation on many paths: merge them in a balanced tree rather than one by one
+        for (int i = 0; i < nbOriginaux; i++) {
+            originaux[i]->ConvertWithBackData(get_threshold(il[i], 0.1));
+        }
+        delete theShape;
+        theShape = sp_shape_boolop_nary(originaux, origWind, bop);
+
+    } else if ( bop == bool_op_inters || bop == bool_op_union || bop == bool_op_diff || bop == bool_op_symdiff ) {
         // true boolean op
         // get the polygons of each path, with the winding rule specified, and apply the operation iteratively
         originaux[0]->ConvertWithBackData(get_threshold(il[0], 0.1));
@@ -772,7 +1003,7 @@ BoolOpErrors Inkscape::ObjectSet::pathBoolOp(bool_op bop, const bool skip_undo,
         // this function uses the point_data to get the winding number of each path (ie: is a hole or not)
         // for later reconstruction in objects, you also need to extract which path is parent of holes (nesting info)
         theShape->ConvertToFormeNested(res, nbOriginaux, &originaux[0], 1, nbNest, nesting, conts);
-    } else {
+    } else if (!done2geom) {
         theShape->ConvertToForme(res, nbOriginaux, &originaux[0]);
     }
 
@@ -10,15 +10,34 @@
 #ifndef PATH_BOOLOP_H
 #define PATH_BOOLOP_H
 
+#include <optional>
+#include <vector>
 #include <2geom/path.h>
 #include "livarot/Path.h"       // FillRule
 #include "object/object-set.h"  // bool_op
 
+class Shape;
+
+/// Implementation of the boolean operations on the desktop, chosen by the preference
+/// /options/booleans/backend.
+enum class BoolOpBackend
+{
+    Livarot, ///< Flatten to polygons, then refit the curves; handles every operation.
+    Geom     ///< Keep the curves with Geom::PathIntersectionGraph; falls back to livarot.
+};
+
+BoolOpBackend get_boolop_backend();
+
 void sp_flatten(Geom::PathVector &pathvector, FillRule fillkind);
 Geom::PathVector sp_pathvector_boolop(Geom::PathVector const &pathva, Geom::PathVector const &pathvb, bool_op bop,
                                       FillRule fra, FillRule frb, bool livarotonly, bool flattenbefore, int &error);
 Geom::PathVector sp_pathvector_boolop(Geom::PathVector const &pathva, Geom::PathVector const &pathvb, bool_op bop,
                                       FillRule fra, FillRule frb, bool livarotonly = false, bool flattenbefore = true);
+std::optional<Geom::PathVector> sp_pathvector_boolop_2geom(Geom::PathVector const &pathva,
+                                                           Geom::PathVector const &pathvb, bool_op bop,
+                                                           FillRule fra, FillRule frb);
+Shape *sp_shape_boolop_nary(std::vector<Path *> const &paths, std::vector<FillRule> const &fills, bool_op bop);
+Geom::PathVector sp_pathvector_boolop_nary(std::vector<Geom::PathVector> const &pathvs, bool_op bop, FillRule fill);
 
 #endif // PATH_BOOLOP_H
 
@@ -18,6 +18,9 @@
 
 #include "path-outline.h"
 
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "path-chemistry.h" // Should be moved to path directory
@@ -25,6 +28,8 @@
 #include "selection.h"
 #include "style.h"
 
+#include "async/scheduler.h"
+
 #include "display/curve.h"  // Should be moved to path directory
 
 #include "helper/geom.h"    // pathv_to_linear_and_cubic()
@@ -44,19 +49,17 @@
 #include "svg/svg.h"
 
 /**
- * Given an item, find a path representing the fill and a path representing the stroke.
- * Returns true if fill path found. Item may not have a stroke in which case stroke path is empty.
- * bbox_only==true skips cleaning up the stroke path.
- * Encapsulates use of livarot.
+ * Given an item, find the path representing its fill, as used by item_find_paths(). Returns
+ * nullptr if the item is not a well structured shape or text.
  */
-bool
-item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& stroke, bool bbox_only = false)
+static SPStyle *
+item_find_fill_path(const SPItem *item, Geom::PathVector& fill)
 {
     auto shape = cast<SPShape>(item);
     auto text = cast<SPText>(item);
 
     if (!shape && !text) {
-        return false;
+        return nullptr;
     }
 
     std::optional<SPCurve> curve;
@@ -66,17 +69,17 @@ item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& st
         curve = text->getNormalizedBpath();
     } else {
         std::cerr << "item_find_paths: item not shape or text!" << std::endl;
-        return false;
+        return nullptr;
     }
 
     if (!curve) {
         std::cerr << "item_find_paths: no curve!" << std::endl;
-        return false;
+        return nullptr;
     }
 
     if (curve->get_pathvector().empty()) {
         std::cerr << "item_find_paths: curve empty!" << std::endl;
-        return false;
+        return nullptr;
     }
 
     fill = curve->get_pathvector();
@@ -84,12 +87,25 @@ item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& st
     if (!item->style) {
         // Should never happen
         std::cerr << "item_find_paths: item with no style!" << std::endl;
-        return false;
+        return nullptr;
     }
 
-    if (item->style->stroke.isNone()) {
+    return item->style;
+}
+
+/**
+ * Find the path representing the stroke of a fill path with the given style, as used by
+ * item_find_paths(). Only reads the style, so that it can run in another thread while the
+ * document is left alone.
+ */
+static Geom::PathVector
+find_stroke_path(Geom::PathVector const &fill, SPStyle *style, Geom::Affine const &transform, bool bbox_only)
+{
+    Geom::PathVector stroke;
+
+    if (style->stroke.isNone()) {
         // No stroke, no chocolate!
-        return true;
+        return stroke;
     }
 
     // Now that we have a valid curve with stroke, do offset. We use Livarot for this as
@@ -99,8 +115,6 @@ item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& st
     // which the outline is created correctly.
     Geom::PathVector pathv = pathv_to_linear_and_cubic_beziers( fill );
 
-    SPStyle *style = item->style;
-
     double stroke_width = style->stroke_width.computed;
     if (stroke_width < Geom::EPSILON) {
         // https://bugs.launchpad.net/inkscape/+bug/1244861
@@ -137,7 +151,6 @@ item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& st
     Path *origin = new Path; // Fill
     Path *offset = new Path;
 
-    Geom::Affine const transform(item->transform);
     double const scale = transform.descrim();
 
     origin->LoadPathVector(pathv);
@@ -172,11 +185,33 @@ item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& st
         theOffset->ConvertToForme(origin, 1, &offset); // Turn shape into contour (stored in origin).
 
         stroke = origin->MakePathVector(); // Note origin was replaced above by stroke!
+
+        delete theShape;
+        delete theOffset;
     }
 
     delete origin;
     delete offset;
 
+    return stroke;
+}
+
+/**
+ * Given an item, find a path representing the fill and a path representing the stroke.
+ * Returns true if fill path found. Item may not have a stroke in which case stroke path is empty.
+ * bbox_only==true skips cleaning up the stroke path.
+ * Encapsulates use of livarot.
+ */
+bool
+item_find_paths(const SPItem *item, Geom::PathVector& fill, Geom::PathVector& stroke, bool bbox_only = false)
+{
+    SPStyle *style = item_find_fill_path(item, fill);
+    if (!style) {
+        return false;
+    }
+
+    stroke = find_stroke_path(fill, style, item->transform, bbox_only);
+
     // std::cout << "    fill:   " << sp_svg_write_path(fill)   << "  count: " << fill.curveCount() << std::endl;
     // std::cout << "    stroke: " << sp_svg_write_path(stroke) << "  count: " << stroke.curveCount() << std::endl;
     return true;
@@ -375,6 +410,73 @@ void item_to_paths_add_marker( SPItem *context,
 }
 
 
+namespace {
+
+/// Fill and stroke paths of shapes, found by item_find_paths() ahead of time.
+using FoundPaths = std::unordered_map<SPItem const *, std::pair<Geom::PathVector, Geom::PathVector>>;
+
+/**
+ * Collect the shapes that item_to_paths() will find the paths of when called on the item, and
+ * that it will not change beforehand.
+ */
+void collect_shapes(SPItem *item, bool legacy, std::vector<SPShape *> &shapes)
+{
+    auto lpeitem = cast<SPLPEItem>(item);
+    if (lpeitem && lpeitem->hasPathEffect()) {
+        // Replaced by a new item first.
+        return;
+    }
+    if (auto group = cast<SPGroup>(item)) {
+        if (!legacy) {
+            for (auto subitem : group->item_list()) {
+                collect_shapes(subitem, legacy, shapes);
+            }
+        }
+    } else if (auto shape = cast<SPShape>(item)) {
+        shapes.push_back(shape);
+    }
+}
+
+/**
+ * Find the fill and stroke paths of many shapes. The fill paths are read from the document in
+ * this thread, and the strokes, where nearly all the time goes, are computed concurrently.
+ */
+FoundPaths find_paths(std::vector<SPShape *> const &shapes)
+{
+    struct Job
+    {
+        SPShape *shape;
+        SPStyle *style;
+        Geom::PathVector fill;
+        Geom::PathVector stroke;
+    };
+
+    std::vector<Job> jobs;
+    jobs.reserve(shapes.size());
+    for (auto shape : shapes) {
+        Job job{shape, nullptr, {}, {}};
+        job.style = item_find_fill_path(shape, job.fill);
+        if (job.style) {
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    Inkscape::Async::Scheduler::get().parallel_for(0, jobs.size(), [&] (int i) {
+        auto &job = jobs[i];
+        job.stroke = find_stroke_path(job.fill, job.style, job.shape->transform, false);
+    });
+
+    FoundPaths found;
+    for (auto &job : jobs) {
+        found.emplace(job.shape, std::make_pair(std::move(job.fill), std::move(job.stroke)));
+    }
+    return found;
+}
+
+Inkscape::XML::Node *item_to_paths(SPItem *item, bool legacy, SPItem *context, FoundPaths *found);
+
+} // namespace
+
 /*
  * Find an outline that represents an item.
  * If legacy, text will not be handled as it is not a shape.
@@ -386,6 +488,35 @@ void item_to_paths_add_marker( SPItem *context,
  */
 Inkscape::XML::Node*
 item_to_paths(SPItem *item, bool legacy, SPItem *context)
+{
+    return item_to_paths(item, legacy, context, nullptr);
+}
+
+std::vector<Inkscape::XML::Node *>
+items_to_paths(std::vector<SPItem *> const &items, bool legacy)
+{
+    std::vector<SPShape *> shapes;
+    for (auto item : items) {
+        collect_shapes(item, legacy, shapes);
+    }
+    auto found = find_paths(shapes);
+
+    std::vector<Inkscape::XML::Node *> result;
+    result.reserve(items.size());
+    for (auto item : items) {
+        result.push_back(item_to_paths(item, legacy, nullptr, &found));
+    }
+    return result;
+}
+
+namespace {
+
+/*
+ * Implementation of item_to_paths(), taking the fill and stroke paths of shapes from found where
+ * they are, instead of finding them again.
+ */
+Inkscape::XML::Node*
+item_to_paths(SPItem *item, bool legacy, SPItem *context, FoundPaths *found)
 {
     char const *id = item->getAttribute("id");
     SPDocument *doc = item->document;
@@ -432,7 +563,7 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
         std::vector<SPItem*> const item_list = group->item_list();
         bool did = false;
         for (auto subitem : item_list) {
-            if (item_to_paths(subitem, legacy)) {
+            if (item_to_paths(subitem, legacy, nullptr, found)) {
                 did = true;
             }
         }
@@ -451,7 +582,16 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
 
     Geom::PathVector fill_path;
     Geom::PathVector stroke_path;
-    bool status = item_find_paths(item, fill_path, stroke_path);
+    bool status;
+    auto it = found ? found->find(item) : FoundPaths::iterator{};
+    if (found && it != found->end()) {
+        std::tie(fill_path, stroke_path) = std::move(it->second);
+        // The item is replaced below, and its address may be reused.
+        found->erase(it);
+        status = true;
+    } else {
+        status = item_find_paths(item, fill_path, stroke_path);
+    }
 
     if (!status) {
         // Was not a well structured shape (or text).
@@ -780,6 +920,8 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
     return out;
 }
 
+} // namespace
+
 /*
   Local Variables:
   mode:c++
@@ -16,6 +16,8 @@
 #ifndef SEEN_PATH_OUTLINE_H
 #define SEEN_PATH_OUTLINE_H
 
+#include <vector>
+
 class SPDesktop;
 class SPItem;
 
@@ -39,6 +41,13 @@ Geom::PathVector* item_to_outline (SPItem const *item, bool exclude_markers = fa
  */
 Inkscape::XML::Node* item_to_paths(SPItem *item, bool legacy = false, SPItem *context = nullptr);
 
+/**
+ * Replace many items by path objects, as item_to_paths() does for each of them in turn. The
+ * strokes of all the shapes among them are outlined concurrently beforehand.
+ * Returns the result of item_to_paths() for each item.
+ */
+std::vector<Inkscape::XML::Node*> items_to_paths(std::vector<SPItem *> const &items, bool legacy = false);
+
 /**
  * Replace selected items by path objects (a.k.a. stroke to >path).
  * TODO: remove desktop dependency.
@@ -307,6 +307,7 @@ static char const preferences_skeleton[] =
     <group id="autoscrollspeed" value="0.7"/>
     <group id="autoscrolldistance" value="-10"/>
     <group id="simplifythreshold" value="0.002"/>
+    <group id="booleans" backend="livarot"/>
     <group id="bitmapeditor" value="gimp"/>
     <group id="svgeditor" value="inkscape"/>
     <group id="bitmapautoreload" value="1"/>
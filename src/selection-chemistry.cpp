@@ -55,6 +55,7 @@
 #include "object/sp-clippath.h"
 #include "object/sp-conn-end.h"
 #include "object/sp-defs.h"
+#include "object/sp-lpe-item.h"
 #include "object/sp-ellipse.h"
 #include "object/sp-flowregion.h"
 #include "object/sp-flowtext.h"
@@ -1711,6 +1712,11 @@ void ObjectSet::applyAffine(Geom::Affine const &affine, bool set_i2d, bool compe
             ordered_items.push_back(item);
         }
     }
+    // Compute the path effects of the transformed items together, once all of them are written.
+    auto const doc = ordered_items.empty() ? nullptr : ordered_items.front()->document;
+    if (doc) {
+        doc->beginPathEffectUpdates();
+    }
     for (auto item : ordered_items) {
         if (is<SPRoot>(item) ) {
             // An SVG element cannot have a transform. We could change 'x' and 'y' in response
@@ -1857,6 +1863,9 @@ void ObjectSet::applyAffine(Geom::Affine const &affine, bool set_i2d, bool compe
             }
         }
     }
+    if (doc) {
+        doc->flushPathEffectUpdates();
+    }
 }
 
 void ObjectSet::removeTransform()
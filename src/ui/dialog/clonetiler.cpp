@@ -17,6 +17,10 @@
 
 #include "clonetiler.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <glibmm/i18n.h>
 
 #include <gtkmm/adjustment.h>
@@ -95,6 +99,8 @@ static Inkscape::Drawing *trace_drawing = nullptr;
 static unsigned trace_visionkey;
 static gdouble trace_zoom;
 static SPDocument *trace_doc = nullptr;
+static cairo_surface_t *trace_surface = nullptr;
+static Geom::IntRect trace_surface_rect;
 
 CloneTiler::CloneTiler()
     : DialogBase("/dialogs/clonetiler/", "CloneTiler")
@@ -1938,20 +1944,71 @@ guint32 CloneTiler::trace_pick(Geom::Rect box)
     /* Item integer bbox in points */
     Geom::IntRect ibox = (box * Geom::Scale(trace_zoom)).roundOutwards();
 
+    double R = 0, G = 0, B = 0, A = 0;
+
+    /* Average the prerendered pixels if they cover the box */
+    if (trace_surface && trace_surface_rect.contains(ibox)) {
+        auto const offset = ibox.min() - trace_surface_rect.min();
+        int const stride = cairo_image_surface_get_stride(trace_surface);
+        unsigned char *data = cairo_image_surface_get_data(trace_surface) + offset.y() * stride + offset.x() * 4;
+        cairo_surface_t *s = cairo_image_surface_create_for_data(data, CAIRO_FORMAT_ARGB32, ibox.width(), ibox.height(), stride);
+        ink_cairo_surface_average_color(s, R, G, B, A);
+        cairo_surface_destroy(s);
+        return SP_RGBA32_F_COMPOSE (R, G, B, A);
+    }
+
     /* Find visible area */
     cairo_surface_t *s = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, ibox.width(), ibox.height());
     Inkscape::DrawingContext dc(s, ibox.min());
     /* Render */
     trace_drawing->render(dc, ibox);
-    double R = 0, G = 0, B = 0, A = 0;
     ink_cairo_surface_average_color(s, R, G, B, A);
     cairo_surface_destroy(s);
 
     return SP_RGBA32_F_COMPOSE (R, G, B, A);
 }
 
+/**
+ * Render the area covering all of the given boxes at once, so that trace_pick() can average
+ * their pixels without rendering each box separately. Does nothing if the area would need too
+ * much memory; the boxes are then rendered one by one as before.
+ */
+void CloneTiler::trace_prerender(std::vector<Geom::Rect> const &boxes)
+{
+    if (!trace_drawing) {
+        return;
+    }
+
+    Geom::OptIntRect area;
+    for (auto const &box : boxes) {
+        area.unionWith((box * Geom::Scale(trace_zoom)).roundOutwards());
+    }
+    // 64 MiB of ARGB32 pixels
+    if (!area || (double)area->width() * area->height() > (1 << 24)) {
+        return;
+    }
+
+    trace_drawing->root()->setTransform(Geom::Scale(trace_zoom));
+    trace_drawing->update();
+
+    trace_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, area->width(), area->height());
+    if (cairo_surface_status(trace_surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(trace_surface);
+        trace_surface = nullptr;
+        return;
+    }
+    Inkscape::DrawingContext dc(trace_surface, area->min());
+    trace_drawing->render(dc, *area);
+    cairo_surface_flush(trace_surface);
+    trace_surface_rect = *area;
+}
+
 void CloneTiler::trace_finish()
 {
+    if (trace_surface) {
+        cairo_surface_destroy(trace_surface);
+        trace_surface = nullptr;
+    }
     if (trace_doc) {
         trace_doc->getRoot()->invoke_hide(trace_visionkey);
         delete trace_drawing;
@@ -2251,6 +2308,22 @@ void CloneTiler::apply()
     Geom::Rect bbox_original (Geom::Point (x0, y0), Geom::Point (x0 + w, y0 + h));
     double perimeter_original = (w + h)/4;
 
+    Geom::Affine parent_transform = (((SPItem*)item->parent)->i2doc_affine())*(item->document->getRoot()->c2p.inverse());
+    Geom::Point item_center = scale_units*desktop->dt2doc(item->getCenter());
+
+    // All tiles are laid out and traced before any clone is created, so that the picks are served
+    // by a single rendering and the document is only updated once for the whole batch.
+    struct Tile
+    {
+        Geom::Affine orig_t;
+        Geom::Affine t;
+        std::string color;
+        double blur;
+        double opacity;
+        bool skip = false;
+    };
+    std::vector<Tile> tiles;
+
     // The integers i and j are reserved for tile column and row.
     // The doubles x and y are used for coordinates
     for (int i = 0;
@@ -2286,7 +2359,6 @@ void CloneTiler::apply()
                                                        rotate_rand,
                                                        rotate_alternatei, rotate_alternatej,
                                                        rotate_cumulatei,  rotate_cumulatej      );
-            Geom::Affine parent_transform = (((SPItem*)item->parent)->i2doc_affine())*(item->document->getRoot()->c2p.inverse());
             Geom::Affine t = parent_transform*orig_t*parent_transform.inverse();
             cur = center * t - center;
             if (fillrect) {
@@ -2337,163 +2409,194 @@ void CloneTiler::apply()
             opacity = CLAMP (opacity, 0, 1);
             }
 
-            // Trace tab
-            if (dotrace) {
-                Geom::Rect bbox_t = transform_rect (bbox_original, t*Geom::Scale(1.0/scale_units));
-
-                guint32 rgba = trace_pick (bbox_t);
-                float r = SP_RGBA32_R_F(rgba);
-                float g = SP_RGBA32_G_F(rgba);
-                float b = SP_RGBA32_B_F(rgba);
-                float a = SP_RGBA32_A_F(rgba);
-
-                float hsl[3];
-                SPColor::rgb_to_hsl_floatv (hsl, r, g, b);
-
-                gdouble val = 0;
-                switch (pick) {
-                case PICK_COLOR:
-                    val = 1 - hsl[2]; // inverse lightness; to match other picks where black = max
-                    break;
-                case PICK_OPACITY:
-                    val = a;
-                    break;
-                case PICK_R:
-                    val = r;
-                    break;
-                case PICK_G:
-                    val = g;
-                    break;
-                case PICK_B:
-                    val = b;
-                    break;
-                case PICK_H:
-                    val = hsl[0];
-                    break;
-                case PICK_S:
-                    val = hsl[1];
-                    break;
-                case PICK_L:
-                    val = 1 - hsl[2];
-                    break;
-                default:
-                    break;
-                }
-
-                if (rand_picked > 0) {
-                    val = randomize01 (val, rand_picked);
-                    r = randomize01 (r, rand_picked);
-                    g = randomize01 (g, rand_picked);
-                    b = randomize01 (b, rand_picked);
-                }
+            tiles.push_back({orig_t, t, color_string, blur, opacity});
+        }
+        cur[Geom::Y] = 0;
+    }
 
-                if (gamma_picked != 0) {
-                    double power;
-                    if (gamma_picked > 0)
-                        power = 1/(1 + fabs(gamma_picked));
-                    else
-                        power = 1 + fabs(gamma_picked);
-
-                    val = pow (val, power);
-                    r = pow (r, power);
-                    g = pow (g, power);
-                    b = pow (b, power);
+    // Trace tab
+    if (dotrace) {
+        std::vector<Geom::Rect> boxes;
+        boxes.reserve(tiles.size());
+        for (auto const &tile : tiles) {
+            boxes.push_back(transform_rect (bbox_original, tile.t*Geom::Scale(1.0/scale_units)));
+        }
+        trace_prerender(boxes);
+
+        for (std::size_t k = 0; k < tiles.size(); k++) {
+            auto &tile = tiles[k];
+
+            guint32 rgba = trace_pick (boxes[k]);
+            float r = SP_RGBA32_R_F(rgba);
+            float g = SP_RGBA32_G_F(rgba);
+            float b = SP_RGBA32_B_F(rgba);
+            float a = SP_RGBA32_A_F(rgba);
+
+            float hsl[3];
+            SPColor::rgb_to_hsl_floatv (hsl, r, g, b);
+
+            gdouble val = 0;
+            switch (pick) {
+            case PICK_COLOR:
+                val = 1 - hsl[2]; // inverse lightness; to match other picks where black = max
+                break;
+            case PICK_OPACITY:
+                val = a;
+                break;
+            case PICK_R:
+                val = r;
+                break;
+            case PICK_G:
+                val = g;
+                break;
+            case PICK_B:
+                val = b;
+                break;
+            case PICK_H:
+                val = hsl[0];
+                break;
+            case PICK_S:
+                val = hsl[1];
+                break;
+            case PICK_L:
+                val = 1 - hsl[2];
+                break;
+            default:
+                break;
+            }
+
+            if (rand_picked > 0) {
+                val = randomize01 (val, rand_picked);
+                r = randomize01 (r, rand_picked);
+                g = randomize01 (g, rand_picked);
+                b = randomize01 (b, rand_picked);
+            }
+
+            if (gamma_picked != 0) {
+                double power;
+                if (gamma_picked > 0)
+                    power = 1/(1 + fabs(gamma_picked));
+                else
+                    power = 1 + fabs(gamma_picked);
+
+                val = pow (val, power);
+                r = pow (r, power);
+                g = pow (g, power);
+                b = pow (b, power);
+            }
+
+            if (invert_picked) {
+                val = 1 - val;
+                r = 1 - r;
+                g = 1 - g;
+                b = 1 - b;
+            }
+
+            val = CLAMP (val, 0, 1);
+            r = CLAMP (r, 0, 1);
+            g = CLAMP (g, 0, 1);
+            b = CLAMP (b, 0, 1);
+
+            // recompose tweaked color
+            rgba = SP_RGBA32_F_COMPOSE(r, g, b, a);
+
+            if (pick_to_presence) {
+                if (g_random_double_range (0, 1) > val) {
+                    tile.skip = true;
+                    continue; // skip!
                 }
+            }
+            if (pick_to_size) {
+                tile.t = parent_transform * Geom::Translate(-center[Geom::X], -center[Geom::Y])
+                * Geom::Scale (val, val) * Geom::Translate(center[Geom::X], center[Geom::Y])
+                * parent_transform.inverse() * tile.t;
+            }
+            if (pick_to_opacity) {
+                tile.opacity *= val;
+            }
+            if (pick_to_color) {
+                gchar color_string[32];
+                sp_svg_write_color(color_string, sizeof(color_string), rgba);
+                tile.color = color_string;
+            }
+        }
+    }
 
-                if (invert_picked) {
-                    val = 1 - val;
-                    r = 1 - r;
-                    g = 1 - g;
-                    b = 1 - b;
-                }
+    bool center_set = obj_repr->attribute("inkscape:transform-center-x") || obj_repr->attribute("inkscape:transform-center-y");
 
-                val = CLAMP (val, 0, 1);
-                r = CLAMP (r, 0, 1);
-                g = CLAMP (g, 0, 1);
-                b = CLAMP (b, 0, 1);
+    // Create the clones
+    std::vector<std::pair<Tile const *, Inkscape::XML::Node *>> clones;
+    for (auto const &tile : tiles) {
+        if (tile.skip) {
+            continue;
+        }
 
-                // recompose tweaked color
-                rgba = SP_RGBA32_F_COMPOSE(r, g, b, a);
+        if (tile.opacity < 1e-6) { // invisibly transparent, skip
+            continue;
+        }
 
-                if (pick_to_presence) {
-                    if (g_random_double_range (0, 1) > val) {
-                        continue; // skip!
-                    }
-                }
-                if (pick_to_size) {
-                    t = parent_transform * Geom::Translate(-center[Geom::X], -center[Geom::Y])
-                    * Geom::Scale (val, val) * Geom::Translate(center[Geom::X], center[Geom::Y])
-                    * parent_transform.inverse() * t;
-                }
-                if (pick_to_opacity) {
-                    opacity *= val;
-                }
-                if (pick_to_color) {
-                    sp_svg_write_color(color_string, sizeof(color_string), rgba);
-                }
-            }
+        auto const &t = tile.t;
+        if (fabs(t[0]) + fabs (t[1]) + fabs(t[2]) + fabs(t[3]) < 1e-6) { // too small, skip
+            continue;
+        }
 
-            if (opacity < 1e-6) { // invisibly transparent, skip
-                continue;
-            }
+        Inkscape::XML::Node *clone = obj_repr->document()->createElement("svg:use");
+        clone->setAttribute("x", "0");
+        clone->setAttribute("y", "0");
+        clone->setAttribute("inkscape:tiled-clone-of", id_href);
+        clone->setAttribute("xlink:href", id_href);
 
-            if (fabs(t[0]) + fabs (t[1]) + fabs(t[2]) + fabs(t[3]) < 1e-6) { // too small, skip
-                continue;
-            }
+        clone->setAttributeOrRemoveIfEmpty("transform", sp_svg_transform_write(t));
 
-            // Create the clone
-            Inkscape::XML::Node *clone = obj_repr->document()->createElement("svg:use");
-            clone->setAttribute("x", "0");
-            clone->setAttribute("y", "0");
-            clone->setAttribute("inkscape:tiled-clone-of", id_href);
-            clone->setAttribute("xlink:href", id_href);
+        if (tile.opacity < 1.0) {
+            clone->setAttributeCssDouble("opacity", tile.opacity);
+        }
 
-            Geom::Point new_center;
-            bool center_set = false;
-            if (obj_repr->attribute("inkscape:transform-center-x") || obj_repr->attribute("inkscape:transform-center-y")) {
-                new_center = scale_units*desktop->dt2doc(item->getCenter()) * orig_t;
-                center_set = true;
-            }
+        if (!tile.color.empty()) {
+            clone->setAttribute("fill", tile.color);
+            clone->setAttribute("stroke", tile.color);
+        }
 
-            clone->setAttributeOrRemoveIfEmpty("transform", sp_svg_transform_write(t));
+        // add the new clone to the top of the original's parent
+        parent->getRepr()->appendChild(clone);
+        clones.emplace_back(&tile, clone);
+    }
 
-            if (opacity < 1.0) {
-                clone->setAttributeCssDouble("opacity", opacity);
-            }
+    // this is necessary for all newly added clones to have correct bboxes,
+    // otherwise filters and centers won't work:
+    desktop->getDocument()->ensureUpToDate();
 
-            if (*color_string) {
-                clone->setAttribute("fill", color_string);
-                clone->setAttribute("stroke", color_string);
+    if (center_set) {
+        // Set all centers before anything is written back, so that the document stays up to date
+        for (auto const &[tile, clone] : clones) {
+            if (auto clone_item = cast<SPItem>(desktop->getDocument()->getObjectByRepr(clone))) {
+                clone_item->setCenter(desktop->doc2dt(item_center * tile->orig_t));
             }
+        }
+    }
 
-            // add the new clone to the top of the original's parent
-            parent->getRepr()->appendChild(clone);
-
-            if (blur > 0.0) {
-                SPObject *clone_object = desktop->getDocument()->getObjectByRepr(clone);
-                auto item = cast<SPItem>(clone_object);
-                double radius = blur * perimeter_original * t.descrim();
-                // this is necessary for all newly added clones to have correct bboxes,
-                // otherwise filters won't work:
-                desktop->getDocument()->ensureUpToDate();
-                SPFilter *constructed = new_filter_gaussian_blur(desktop->getDocument(), radius, t.descrim());
-                constructed->update_filter_region(item);
-                sp_style_set_property_url (clone_object, "filter", constructed, false);
-            }
+    for (auto const &[tile, clone] : clones) {
+        SPObject *clone_object = desktop->getDocument()->getObjectByRepr(clone);
+        auto clone_item = cast<SPItem>(clone_object);
+        if (!clone_item) {
+            continue;
+        }
 
-            if (center_set) {
-                SPObject *clone_object = desktop->getDocument()->getObjectByRepr(clone);
-                auto item = cast<SPItem>(clone_object);
-                if (clone_object && item) {
-                    clone_object->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
-                    item->setCenter(desktop->doc2dt(new_center));
-                    clone_object->updateRepr();
-                }
-            }
+        if (tile->blur > 0.0) {
+            double radius = tile->blur * perimeter_original * tile->t.descrim();
+            SPFilter *constructed = new_filter_gaussian_blur(desktop->getDocument(), radius, tile->t.descrim());
+            constructed->update_filter_region(clone_item);
+            sp_style_set_property_url (clone_object, "filter", constructed, false);
+        }
 
-            Inkscape::GC::release(clone);
+        if (center_set) {
+            clone_object->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
+            clone_object->updateRepr();
         }
-        cur[Geom::Y] = 0;
+    }
+
+    for (auto const &[tile, clone] : clones) {
+        Inkscape::GC::release(clone);
     }
 
     if (dotrace) {
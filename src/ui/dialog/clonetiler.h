@@ -11,6 +11,8 @@
 #ifndef __SP_CLONE_TILER_H__
 #define __SP_CLONE_TILER_H__
 
+#include <vector>
+
 #include "ui/dialog/dialog-base.h"
 #include "ui/widget/color-picker.h"
 
@@ -79,6 +81,7 @@ protected:
     void       trace_hide_tiled_clones_recursively(SPObject *from);
     guint      number_of_clones(SPObject *obj);
     void       trace_setup(SPDocument *doc, gdouble zoom, SPItem *original);
+    void       trace_prerender(std::vector<Geom::Rect> const &boxes);
     guint32    trace_pick(Geom::Rect box);
     void       trace_finish();
     bool       is_a_clone_of(SPObject *tile, SPObject *obj);
@@ -1075,6 +1075,8 @@ void InkscapePreferences::initPageTools()
     _page_text.add_line( true, "", _font_fontsdir_user, "", _("Load additional fonts from \"fonts\" directory located in Inkscape's user configuration directory"));
     _font_fontdirs_custom.init("/options/font/custom_fontdirs", 50);
     _page_text.add_line(true, _("Additional font directories"), _font_fontdirs_custom, "", _("Load additional fonts from custom locations (one path per line)"), true);
+    _font_glyph_outline_cache.init( _("Share glyph outlines between sessions"), "/options/font/glyph_outline_cache", false);
+    _page_text.add_line( true, "", _font_glyph_outline_cache, "", _("Keep the outlines of glyphs in the cache directory, so that converting text to paths or exporting it does not have to read them from the fonts again (requires restart)"));
 
 
     this->AddNewObjectsStyle(_page_text, "/tools/text");
@@ -2500,6 +2502,14 @@ void InkscapePreferences::initPageBehavior()
     _page_behavior.add_line( false, _("_Simplification threshold:"), _misc_simpl, "",
                            _("How strong is the Node tool's Simplify command by default. If you invoke this command several times in quick succession, it will act more and more aggressively; invoking it again after a pause restores the default threshold."), false);
 
+    {
+        std::vector<Glib::ustring> labels = {_("Livarot"), _("2Geom (keep curves)")};
+        std::vector<Glib::ustring> values = {"livarot", "2geom"};
+        _misc_boolop_backend.init("/options/booleans/backend", labels, values, "livarot");
+        _page_behavior.add_line(false, _("Boolean operations:"), _misc_boolop_backend, "",
+                                _("Livarot handles every operation, but replaces curves with new ones fitted to a flattened result. 2Geom keeps the original curves of union, intersection, difference and exclusion, and falls back to Livarot when it fails."), false);
+    }
+
     _markers_color_stock.init ( _("Color stock markers the same color as object"), "/options/markers/colorStockMarkers", true);
     _markers_color_custom.init ( _("Color custom markers the same color as object"), "/options/markers/colorCustomMarkers", false);
     _markers_color_update.init ( _("Update marker color when object color changes"), "/options/markers/colorUpdateMarkers", true);
@@ -424,6 +424,7 @@ protected:
     UI::Widget::PrefCheckButton _font_fontsdir_system;
     UI::Widget::PrefCheckButton _font_fontsdir_user;
     UI::Widget::PrefMultiEntry  _font_fontdirs_custom;
+    UI::Widget::PrefCheckButton _font_glyph_outline_cache;
 
     UI::Widget::PrefCheckButton _misc_comment;
     UI::Widget::PrefCheckButton _misc_default_metadata;
@@ -436,6 +437,7 @@ protected:
 
     // System page
     UI::Widget::PrefSpinButton  _misc_simpl;
+    UI::Widget::PrefCombo       _misc_boolop_backend;
     Gtk::Entry                  _sys_user_prefs;
     Gtk::Entry                  _sys_tmp_files;
     Gtk::Entry                  _sys_extension_dir;
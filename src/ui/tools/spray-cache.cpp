@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Per-stroke lookup structures of the spray tool.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "spray-cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "desktop.h"
+#include "document.h"
+
+#include "display/cairo-utils.h"
+#include "display/control/canvas-item-drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing.h"
+#include "helper/geom.h"
+#include "object/sp-item-group.h"
+#include "object/sp-item.h"
+#include "object/sp-root.h"
+
+namespace Inkscape {
+namespace UI {
+namespace Tools {
+namespace {
+
+// Items covering more grid cells than this are kept in a list that every query scans.
+constexpr int MAX_CELLS_PER_ENTRY = 64;
+// Number of grid cells across the first fetched neighbourhood.
+constexpr int CELLS_PER_NEIGHBOURHOOD = 8;
+// Largest raster kept, in pixels.
+constexpr double MAX_RASTER_PIXELS = 1 << 22;
+
+long long cell_key(long long x, long long y)
+{
+    return (x << 32) ^ (y & 0xffffffff);
+}
+
+} // namespace
+
+SprayStrokeCache::~SprayStrokeCache()
+{
+    reset();
+}
+
+void SprayStrokeCache::reset()
+{
+    for (auto const &entry : _entries) {
+        if (entry.item) {
+            sp_object_unref(entry.item);
+        }
+    }
+    _entries.clear();
+    _index.clear();
+    _covered.clear();
+    _cells.clear();
+    _large.clear();
+    _cell_size = 0;
+
+    dropSurface();
+}
+
+std::vector<SPItem *> SprayStrokeCache::itemsPartiallyInBox(SPDesktop *desktop, Geom::Rect const &box)
+{
+    if (!covers(box)) {
+        auto area = box;
+        area.expandBy(_margin);
+        if (_cell_size <= 0) {
+            _cell_size = std::max(area.width(), area.height()) / CELLS_PER_NEIGHBOURHOOD;
+            if (!(_cell_size > 1e-6)) {
+                _cell_size = 1;
+            }
+        }
+        for (auto item : desktop->getDocument()->getItemsPartiallyInBox(desktop->dkey, area)) {
+            if (auto bounds = item->documentVisualBounds()) {
+                insert(item, *bounds);
+            }
+        }
+        _covered.push_back(area);
+    }
+
+    std::vector<std::size_t> found = _large;
+    if (!forCells(box, [&] (long long key) {
+            auto it = _cells.find(key);
+            if (it != _cells.end()) {
+                found.insert(found.end(), it->second.begin(), it->second.end());
+            }
+        })) {
+        // Too large an area to look up cell by cell.
+        found.resize(_entries.size());
+        for (std::size_t i = 0; i < found.size(); i++) {
+            found[i] = i;
+        }
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+
+    std::vector<SPItem *> result;
+    for (auto i : found) {
+        auto const &entry = _entries[i];
+        // Skip items deleted or hidden since they were fetched, as the document would.
+        if (!entry.item || !entry.item->parent || entry.item->isHidden() || entry.item->isLocked()) {
+            continue;
+        }
+        if (box.intersects(entry.bounds)) {
+            result.push_back(entry.item);
+        }
+    }
+    return result;
+}
+
+void SprayStrokeCache::itemAdded(SPDesktop *desktop, SPItem *item)
+{
+    // The document reports the outermost group below a layer rather than the item itself.
+    while (item->parent && item->parent != item->document->getRoot()) {
+        auto group = cast<SPGroup>(item->parent);
+        if (!group || group->effectiveLayerMode(desktop->dkey) == SPGroup::LAYER) {
+            break;
+        }
+        item = group;
+    }
+    if (auto bounds = item->documentVisualBounds()) {
+        erase(item);
+        insert(item, *bounds);
+    }
+}
+
+void SprayStrokeCache::itemRemoved(SPDesktop * /*desktop*/, SPItem *item)
+{
+    erase(item);
+}
+
+void SprayStrokeCache::averageColor(SPDesktop *desktop, Geom::IntRect const &area, double &R, double &G, double &B, double &A)
+{
+    // Create the drawing items of what was sprayed since the last document update.
+    desktop->getDocument()->ensureUpToDate();
+    averageColor(*desktop->getCanvasDrawing()->get_drawing(), desktop->doc2dt() * desktop->d2w(), area, R, G, B, A);
+}
+
+void SprayStrokeCache::averageColor(Drawing &drawing, Geom::Affine const &affine, Geom::IntRect const &area, double &R,
+                                    double &G, double &B, double &A)
+{
+    // Lay out the new items now rather than on the next canvas update, as they would otherwise be
+    // rendered with stale bounds. The areas this marks for redrawing are collected in _dirty.
+    // A snapshotted drawing is being rendered by the canvas and cannot be updated; its pending
+    // changes are reported once the canvas updates it.
+    if (!drawing.snapshotted()) {
+        drawing.update(Geom::IntRect::infinite(), affine);
+    }
+
+    if (_surface && (_drawing != &drawing || !Geom::are_near(_surface_affine, affine, 1e-9))) {
+        dropSurface();
+    }
+
+    if (!_surface || !_surface_rect.contains(area)) {
+        dropSurface();
+
+        int const margin = std::ceil(std::min(_margin * affine.descrim(), 1e4));
+        auto rect = expandedBy(area, margin);
+        if ((double)rect.width() * rect.height() > MAX_RASTER_PIXELS) {
+            rect = area;
+        }
+        if ((double)rect.width() * rect.height() > MAX_RASTER_PIXELS) {
+            drawing.averageColor(area, R, G, B, A);
+            return;
+        }
+
+        _surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, rect.width(), rect.height());
+        _surface_rect = rect;
+        _surface_affine = affine;
+        _drawing = &drawing;
+        _redraw_connection = drawing.signal_redraw_area.connect([this] (Geom::IntRect const &marked) {
+            if (auto part = expandedBy(marked, 1) & _surface_rect) {
+                _dirty.push_back(*part);
+            }
+        });
+        render(rect);
+    } else if (!_dirty.empty() && !drawing.snapshotted()) {
+        // Content sprayed or erased since the raster was rendered.
+        for (auto const &rect : _dirty) {
+            render(rect);
+        }
+        _dirty.clear();
+    }
+
+    auto const offset = area.min() - _surface_rect.min();
+    int const stride = cairo_image_surface_get_stride(_surface);
+    unsigned char *data = cairo_image_surface_get_data(_surface) + offset.y() * stride + offset.x() * 4;
+    cairo_surface_t *s = cairo_image_surface_create_for_data(data, CAIRO_FORMAT_ARGB32, area.width(), area.height(), stride);
+    ink_cairo_surface_average_color_premul(s, R, G, B, A);
+    cairo_surface_destroy(s);
+}
+
+void SprayStrokeCache::insert(SPItem *item, Geom::Rect const &bounds)
+{
+    if (_index.count(item)) {
+        return;
+    }
+
+    auto const i = _entries.size();
+    _entries.push_back({item, bounds});
+    _index[item] = i;
+    sp_object_ref(item);
+
+    if (_cell_size <= 0 || !forCells(bounds, [&] (long long key) { _cells[key].push_back(i); })) {
+        _large.push_back(i);
+    }
+}
+
+void SprayStrokeCache::erase(SPItem *item)
+{
+    auto it = _index.find(item);
+    if (it == _index.end()) {
+        return;
+    }
+    // Cells keep the index of the entry; it is skipped from now on.
+    _entries[it->second].item = nullptr;
+    _index.erase(it);
+    sp_object_unref(item);
+}
+
+bool SprayStrokeCache::covers(Geom::Rect const &box) const
+{
+    return std::any_of(_covered.begin(), _covered.end(), [&] (Geom::Rect const &area) {
+        return area.contains(box);
+    });
+}
+
+/**
+ * Call f with the key of each grid cell overlapping the rectangle. Returns false without calling
+ * it if there are too many.
+ */
+template <typename F>
+bool SprayStrokeCache::forCells(Geom::Rect const &rect, F &&f) const
+{
+    double const x0 = std::floor(rect.left() / _cell_size);
+    double const y0 = std::floor(rect.top() / _cell_size);
+    double const x1 = std::floor(rect.right() / _cell_size);
+    double const y1 = std::floor(rect.bottom() / _cell_size);
+    if (!std::isfinite(x0 + y0 + x1 + y1) || (x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_ENTRY) {
+        return false;
+    }
+    for (auto y = (long long)y0; y <= (long long)y1; y++) {
+        for (auto x = (long long)x0; x <= (long long)x1; x++) {
+            f(cell_key(x, y));
+        }
+    }
+    return true;
+}
+
+void SprayStrokeCache::dropSurface()
+{
+    if (_surface) {
+        cairo_surface_destroy(_surface);
+        _surface = nullptr;
+    }
+    _redraw_connection.disconnect();
+    _drawing = nullptr;
+    _dirty.clear();
+}
+
+// Render the drawing into part of the raster.
+void SprayStrokeCache::render(Geom::IntRect const &rect)
+{
+    auto const offset = rect.min() - _surface_rect.min();
+    int const stride = cairo_image_surface_get_stride(_surface);
+    unsigned char *data = cairo_image_surface_get_data(_surface) + offset.y() * stride + offset.x() * 4;
+    cairo_surface_t *s = cairo_image_surface_create_for_data(data, CAIRO_FORMAT_ARGB32, rect.width(), rect.height(), stride);
+    {
+        cairo_t *cr = cairo_create(s);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    }
+    Inkscape::DrawingContext dc(s, rect.min());
+    _drawing->render(dc, rect);
+    cairo_surface_flush(s);
+    cairo_surface_destroy(s);
+}
+
+} // namespace Tools
+} // namespace UI
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
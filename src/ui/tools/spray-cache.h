@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Per-stroke lookup structures of the spray tool.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_UI_TOOLS_SPRAY_CACHE_H
+#define INKSCAPE_UI_TOOLS_SPRAY_CACHE_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+#include <2geom/rect.h>
+#include <cairo.h>
+#include <sigc++/connection.h>
+
+class SPDesktop;
+class SPItem;
+
+namespace Inkscape {
+class Drawing;
+
+namespace UI {
+namespace Tools {
+
+/**
+ * Answers the overlap and colour queries the spray tool makes for every candidate position,
+ * without walking the document or rendering the canvas each time.
+ *
+ * Items overlapping the brush neighbourhood are fetched from the document once and kept in a
+ * grid, together with the items sprayed during the stroke. Picked colours are averaged from one
+ * raster of the brush neighbourhood, re-rendered only where the drawing reports changes.
+ *
+ * The cache is only valid for the duration of one stroke; call reset() when it starts and ends.
+ */
+class SprayStrokeCache
+{
+public:
+    SprayStrokeCache() = default;
+    SprayStrokeCache(SprayStrokeCache const &) = delete;
+    SprayStrokeCache &operator=(SprayStrokeCache const &) = delete;
+    ~SprayStrokeCache();
+
+    /// Forget all items and the raster.
+    void reset();
+
+    /// Set how far around a queried area to fetch items and render, in desktop units.
+    void setNeighbourhood(double margin) { _margin = margin; }
+
+    /// Same as SPDocument::getItemsPartiallyInBox() for the desktop's document.
+    std::vector<SPItem *> itemsPartiallyInBox(SPDesktop *desktop, Geom::Rect const &box);
+
+    /// Record an item created or changed during the stroke.
+    void itemAdded(SPDesktop *desktop, SPItem *item);
+    /// Record an item about to be deleted during the stroke.
+    void itemRemoved(SPDesktop *desktop, SPItem *item);
+
+    /// Same as Drawing::averageColor() of the canvas drawing, with the area in window coordinates.
+    void averageColor(SPDesktop *desktop, Geom::IntRect const &area, double &R, double &G, double &B, double &A);
+    /**
+     * Same as Drawing::averageColor() once the drawing is updated with the given affine, from
+     * document to window coordinates.
+     */
+    void averageColor(Drawing &drawing, Geom::Affine const &affine, Geom::IntRect const &area, double &R, double &G,
+                      double &B, double &A);
+
+private:
+    struct Entry
+    {
+        SPItem *item;
+        Geom::Rect bounds;
+    };
+
+    void insert(SPItem *item, Geom::Rect const &bounds);
+    void erase(SPItem *item);
+    bool covers(Geom::Rect const &box) const;
+    template <typename F>
+    bool forCells(Geom::Rect const &rect, F &&f) const;
+
+    void dropSurface();
+    void render(Geom::IntRect const &rect);
+
+    double _margin = 0;
+
+    // Occupancy
+    std::vector<Entry> _entries;
+    std::unordered_map<SPItem *, std::size_t> _index;
+    std::vector<Geom::Rect> _covered;
+    double _cell_size = 0;
+    std::unordered_map<long long, std::vector<std::size_t>> _cells;
+    std::vector<std::size_t> _large; // Entries spanning too many cells to be kept in the grid.
+
+    // Raster of the drawing, in window coordinates.
+    cairo_surface_t *_surface = nullptr;
+    Geom::IntRect _surface_rect;
+    Geom::Affine _surface_affine;
+    Drawing *_drawing = nullptr;
+    sigc::connection _redraw_connection;
+    std::vector<Geom::IntRect> _dirty; // Marked for redrawing by the drawing, not yet rendered.
+};
+
+} // namespace Tools
+} // namespace UI
+} // namespace Inkscape
+
+#endif // INKSCAPE_UI_TOOLS_SPRAY_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
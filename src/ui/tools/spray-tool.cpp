@@ -21,6 +21,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <numeric>
 #include <vector>
 #include <tuple>
@@ -420,14 +421,17 @@ double randomize01(double val, double rand)
     return CLAMP(val, 0, 1); // this should be unnecessary with the above provisions, but just in case...
 }
 
-static guint32 getPickerData(Geom::IntRect area, SPDesktop *desktop)
+static guint32 getPickerData(Geom::IntRect area, SPDesktop *desktop, SprayStrokeCache *cache = nullptr)
 {
-    Inkscape::CanvasItemDrawing *canvas_item_drawing = desktop->getCanvasDrawing();
-    Inkscape::Drawing *drawing = canvas_item_drawing->get_drawing();
-
     // Get average color.
     double R, G, B, A;
-    drawing->averageColor(area, R, G, B, A);
+    if (cache) {
+        cache->averageColor(desktop, area, R, G, B, A);
+    } else {
+        Inkscape::CanvasItemDrawing *canvas_item_drawing = desktop->getCanvasDrawing();
+        Inkscape::Drawing *drawing = canvas_item_drawing->get_drawing();
+        drawing->averageColor(area, R, G, B, A);
+    }
 
     //this can fix the bug #1511998 if confirmed
     if ( A < 1e-6) {
@@ -447,6 +451,7 @@ static void showHidden(std::vector<SPItem *> items_down){
 }
 //todo: maybe move same parameter to preferences
 static bool fit_item(SPDesktop *desktop,
+                     SprayStrokeCache &cache,
                      SPItem *item,
                      Geom::OptRect bbox,
                      Geom::Point &move,
@@ -512,11 +517,11 @@ static bool fit_item(SPDesktop *desktop,
     double height_transformed = bbox_procesed->height();
     Geom::Point mid_point = desktop->d2w(bbox_procesed->midpoint());
     Geom::IntRect area = Geom::IntRect::from_xywh(floor(mid_point[Geom::X]), floor(mid_point[Geom::Y]), 1, 1);
-    guint32 rgba = getPickerData(area, desktop);
+    guint32 rgba = getPickerData(area, desktop, &cache);
     guint32 rgba2 = 0xffffff00;
     Geom::Rect rect_sprayed(desktop->d2w(Geom::Point(bbox_left_main,bbox_top_main)), desktop->d2w(Geom::Point(bbox_right_main,bbox_bottom_main)));
     if (!rect_sprayed.hasZeroArea()) {
-        rgba2 = getPickerData(rect_sprayed.roundOutwards(), desktop);
+        rgba2 = getPickerData(rect_sprayed.roundOutwards(), desktop, &cache);
     }
     if(pick_no_overlap) {
         if(rgba != rgba2) {
@@ -545,13 +550,14 @@ static bool fit_item(SPDesktop *desktop,
         offset_width = 0;
         offset_height = 0;
     }
-    std::vector<SPItem*> items_down = desktop->getDocument()->getItemsPartiallyInBox(desktop->dkey, *bbox_procesed);
+    std::vector<SPItem*> items_down = cache.itemsPartiallyInBox(desktop, *bbox_procesed);
     Inkscape::Selection *selection = desktop->getSelection();
     if (selection->isEmpty()) {
         return false;
     }
     std::vector<SPItem*> const items_selected(selection->items().begin(), selection->items().end());
     std::vector<SPItem*> items_down_erased;
+    bool hidden = false;
     for (std::vector<SPItem*>::const_iterator i=items_down.begin(); i!=items_down.end(); ++i) {
         SPItem *item_down = *i;
         Geom::OptRect bbox_down = item_down->documentVisualBounds();
@@ -572,6 +578,7 @@ static bool fit_item(SPDesktop *desktop,
             {
                 if(mode == SPRAY_MODE_ERASER) {
                     if(strcmp(item_down_sharp, spray_origin) != 0 && !selection->includes(item_down) ){
+                        cache.itemRemoved(desktop, item_down);
                         item_down->deleteObject();
                         items_down_erased.pop_back();
                         break;
@@ -587,6 +594,7 @@ static bool fit_item(SPDesktop *desktop,
                 } else if(picker || over_transparent || over_no_transparent) {
                     item_down->setHidden(true);
                     item_down->updateRepr();
+                    hidden = true;
                 }
             }
         }
@@ -598,7 +606,8 @@ static bool fit_item(SPDesktop *desktop,
         return false;
     }
     if(picker || over_transparent || over_no_transparent){
-        if(!no_overlap){
+        if(!no_overlap && hidden){
+            // The cached raster still shows the hidden items, so render without them.
             doc->ensureUpToDate();
             rgba = getPickerData(area, desktop);
             if (!rect_sprayed.hasZeroArea()) {
@@ -717,6 +726,7 @@ static bool fit_item(SPDesktop *desktop,
                         return false;
                     }
                     if(!fit_item(desktop
+                                 , cache
                                  , item
                                  , bbox
                                  , move
@@ -820,6 +830,7 @@ static bool fit_item(SPDesktop *desktop,
 }
 
 static bool sp_spray_recursive(SPDesktop *desktop,
+                               SprayStrokeCache &cache,
                                Inkscape::ObjectSet *set,
                                SPItem *item,
                                SPItem *&single_path_output,
@@ -867,7 +878,9 @@ static bool sp_spray_recursive(SPDesktop *desktop,
         if (auto box = cast<SPBox3D>(item)) {
             desktop->getSelection()->remove(item);
             set->remove(item);
+            cache.itemRemoved(desktop, item);
             item = box->convert_to_group();
+            cache.itemAdded(desktop, item);
             set->add(item);
             desktop->getSelection()->add(item);
         }
@@ -902,6 +915,7 @@ static bool sp_spray_recursive(SPDesktop *desktop,
                    pick_no_overlap || no_overlap || picker ||
                    !over_transparent || !over_no_transparent) {
                     if(!fit_item(desktop
+                                 , cache
                                  , item
                                  , a
                                  , move
@@ -955,6 +969,7 @@ static bool sp_spray_recursive(SPDesktop *desktop,
                 if(picker){
                     sp_desktop_apply_css_recursive(item_copied, css, true);
                 }
+                cache.itemAdded(desktop, item_copied);
                 did = true;
             }
         }
@@ -1033,6 +1048,7 @@ static bool sp_spray_recursive(SPDesktop *desktop,
                    pick_no_overlap || no_overlap || picker ||
                    !over_transparent || !over_no_transparent) {
                     if(!fit_item(desktop
+                                 , cache
                                  , item
                                  , a
                                  , move
@@ -1093,6 +1109,7 @@ static bool sp_spray_recursive(SPDesktop *desktop,
                 if(picker){
                     sp_desktop_apply_css_recursive(item_copied, css, true);
                 }
+                cache.itemAdded(desktop, item_copied);
                 Inkscape::GC::release(clone);
                 did = true;
             }
@@ -1127,6 +1144,12 @@ static bool sp_spray_dilate(SprayTool *tc, Geom::Point /*event_p*/, Geom::Point
     double move_mean = get_move_mean(tc);
     double move_standard_deviation = get_move_standard_deviation(tc);
 
+    // Candidate positions fall within the brush, give or take the size of the sprayed items.
+    if (auto bbox = set->visualBounds()) {
+        double const scale = tc->scale * (1.0 + tc->scale_variation / 100.0);
+        tc->strokeCache().setNeighbourhood(2 * radius + scale * std::max(bbox->width(), bbox->height()));
+    }
+
     {
         std::vector<SPItem*> const items(set->items().begin(), set->items().end());
 
@@ -1138,6 +1161,7 @@ static bool sp_spray_dilate(SprayTool *tc, Geom::Point /*event_p*/, Geom::Point
         for(auto item : items){
             g_assert(item != nullptr);
             if (sp_spray_recursive(desktop
+                                , tc->strokeCache()
                                 , set
                                 , item
                                 , tc->single_path_output
@@ -1246,6 +1270,7 @@ bool SprayTool::root_handler(GdkEvent* event) {
                 this->has_dilated = false;
 
                 object_set = *_desktop->getSelection();
+                stroke_cache.reset();
                 if (mode == SPRAY_MODE_SINGLE_PATH) {
                     this->single_path_output = nullptr;
                 }
@@ -1317,7 +1342,9 @@ bool SprayTool::root_handler(GdkEvent* event) {
                         this->is_dilating = true;
                         this->has_dilated = false;
                         if(this->is_dilating) {
+                            stroke_cache.reset();
                             sp_spray_dilate(this, scroll_w, _desktop->dt2doc(scroll_dt), Geom::Point(0, 0), false);
+                            stroke_cache.reset();
                         }
                         this->has_dilated = true;
 
@@ -1365,6 +1392,7 @@ bool SprayTool::root_handler(GdkEvent* event) {
             }
             _desktop->getSelection()->clear();
             object_set.clear();
+            stroke_cache.reset();
             break;
         }
 
@@ -25,6 +25,7 @@
 #include "ui/tools/tool-base.h"
 #include "object/object-set.h"
 #include "display/control/canvas-item-ptr.h"
+#include "ui/tools/spray-cache.h"
 
 #define SP_SPRAY_CONTEXT(obj) (dynamic_cast<Inkscape::UI::Tools::SprayTool*>((Inkscape::UI::Tools::ToolBase*)obj))
 #define SP_IS_SPRAY_CONTEXT(obj) (dynamic_cast<const Inkscape::UI::Tools::SprayTool*>((const Inkscape::UI::Tools::ToolBase*)obj) != NULL)
@@ -123,10 +124,14 @@ public:
     ObjectSet* objectSet() {
         return &object_set;
     }
+    SprayStrokeCache &strokeCache() {
+        return stroke_cache;
+    }
     SPItem* single_path_output = nullptr;
 
 private:
     ObjectSet object_set;
+    SprayStrokeCache stroke_cache;
 };
 
 }
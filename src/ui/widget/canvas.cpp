@@ -16,13 +16,13 @@
 #include <mutex>
 #include <array>
 #include <cassert>
-#include <boost/asio/thread_pool.hpp>
-#include <boost/asio/post.hpp>
+#include <cmath>
 #include <2geom/convex-hull.h>
 
 #include "canvas.h"
 #include "canvas-grid.h"
 
+#include "async/scheduler.h"
 #include "color.h"          // Background color
 #include "desktop.h"
 #include "document.h"
@@ -130,6 +130,52 @@ struct Tile
     Fragment fragment;
     Cairo::RefPtr<Cairo::ImageSurface> surface;
     Cairo::RefPtr<Cairo::ImageSurface> outline_surface;
+    bool preview = false; // Rendered at reduced resolution, to be refined later.
+};
+
+// Estimates the velocity at which the view is being scrolled or panned, for predictive prerendering.
+class PanTracker
+{
+public:
+    // Record a change of view position by 'delta' canvas pixels at the given monotonic time.
+    void moved(Geom::IntPoint const &delta, gint64 time)
+    {
+        if (_last_time) {
+            double const dt = (time - *_last_time) / 1e6;
+            if (dt > REST_TIME) {
+                // Starting again from rest.
+                _velocity = {};
+            } else if (dt > 0) {
+                // Exponentially smooth the instantaneous velocity, so that jittery input gives a steady estimate.
+                auto const instantaneous = Geom::Point(delta) / dt;
+                _velocity += (instantaneous - _velocity) * (1.0 - std::exp(-dt / SMOOTHING));
+            }
+        }
+        _last_time = time;
+    }
+
+    // Forget the motion, for example because the view jumped rather than moved.
+    void reset()
+    {
+        _velocity = {};
+        _last_time = {};
+    }
+
+    // The velocity in canvas pixels per second, or zero if the view has come to rest.
+    Geom::Point velocity(gint64 time) const
+    {
+        if (!_last_time || (time - *_last_time) / 1e6 > REST_TIME) {
+            return {};
+        }
+        return _velocity;
+    }
+
+private:
+    static constexpr double SMOOTHING = 0.05; // seconds
+    static constexpr double REST_TIME = 0.15; // seconds
+
+    Geom::Point _velocity;
+    std::optional<gint64> _last_time;
 };
 
 // The urgency with which the async redraw process should exit.
@@ -158,11 +204,15 @@ struct RedrawData
     int tile_size;
     int preempt;
     int margin;
+    int padding;
+    Geom::Point lookahead; // The expected travel of the view over the prerender lookahead time, in store pixels.
     std::optional<int> redraw_delay;
     int render_time_limit;
     int numthreads;
     bool background_in_stores_required;
     uint64_t page, desk;
+    std::shared_ptr<CMSTransform const> cms_transform; // Applied to tiles on the render threads, if set.
+    int preview_downscale; // Zero if progressive rendering is disabled.
     bool debug_framecheck;
     bool debug_show_redraw;
 
@@ -180,9 +230,14 @@ struct RedrawData
     std::vector<Geom::IntRect> rects;
     int effective_tile_size;
 
+    Cairo::RefPtr<Cairo::Region> previewed;
+    bool preview; // Whether the current rects are for the reduced-resolution pass.
+    bool preview_done;
+
     // Results
     std::mutex tiles_mutex;
     std::vector<Tile> tiles;
+    Cairo::RefPtr<Cairo::Region> refined; // Painted at full resolution this redraw; previews arriving later over it are dropped.
     bool timeoutflag;
 
     // Return comparison object for sorting rectangles by distance from mouse point.
@@ -227,6 +282,7 @@ public:
     // Invalidation
     std::unique_ptr<Updater> updater; // Tracks the unclean region and decides how to redraw it.
     Cairo::RefPtr<Cairo::Region> invalidated; // Buffers invalidations while the updater is in use by the background process.
+    Cairo::RefPtr<Cairo::Region> previewed; // Parts of the store holding reduced-resolution content that still needs refining.
 
     // Graphics state; holds all the graphics resources, including the drawn content.
     std::unique_ptr<Graphics> graphics;
@@ -267,7 +323,7 @@ public:
     bool background_in_stores_required() const { return !q->get_opengl_enabled() && SP_RGBA32_A_U(page) == 255 && SP_RGBA32_A_U(desk) == 255; } // Enable solid colour optimisation if both page and desk are solid (as opposed to checkerboard).
 
     // Async redraw process.
-    std::optional<boost::asio::thread_pool> pool;
+    bool ignore_redraw_requests = false;
     int numthreads;
     int get_numthreads() const;
 
@@ -279,17 +335,25 @@ public:
     bool init_redraw();
     bool end_redraw(); // returns true to indicate further redraw cycles required
     void process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible = true, bool preemptible = true);
+    void process_preview(Geom::IntRect const &bounds);
     void render_tile(int debug_id);
-    void paint_rect(Geom::IntRect const &rect);
-    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass);
+    void paint_rect(Geom::IntRect const &rect, bool preview);
+    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass, int downscale = 1);
     void paint_error_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface);
 
+    // Colour management.
+    std::shared_ptr<CMSTransform const> get_cms_transform() const;
+
     // Trivial overload of GtkWidget function.
     void queue_draw_area(Geom::IntRect const &rect);
 
     // For tracking the last known mouse position. (The function Gdk::Window::get_device_position cannot be used because of slow X11 round-trips. Remove this workaround when X11 dies.)
     std::optional<Geom::IntPoint> last_mouse;
 
+    // Predictive prerendering.
+    PanTracker pan_tracker;
+    Geom::IntRect get_prerender_rect() const;
+
     // Auto-scrolling.
     std::optional<guint> tick_callback;
     std::optional<gint64> last_time;
@@ -324,6 +388,7 @@ Canvas::Canvas()
     d->updater = Updater::create(pref_to_updater(d->prefs.update_strategy));
     d->updater->reset();
     d->invalidated = Cairo::Region::create();
+    d->previewed = Cairo::Region::create();
 
     // Preferences
     d->prefs.grabsize.action = [=] { d->canvasitem_ctx->root()->update_canvas_item_ctrl_sizes(d->prefs.grabsize); };
@@ -358,11 +423,7 @@ Canvas::Canvas()
         int const new_numthreads = d->get_numthreads();
         if (d->numthreads == new_numthreads) return;
         d->numthreads = new_numthreads;
-        d->deactivate();
-        d->deactivate_graphics();
-        d->pool.emplace(d->numthreads);
-        d->activate_graphics();
-        d->activate();
+        d->schedule_redraw();
     };
 
     // Canvas item tree
@@ -380,7 +441,7 @@ Canvas::Canvas()
 
     // Async redraw process.
     d->numthreads = d->get_numthreads();
-    d->pool.emplace(d->numthreads);
+    Inkscape::Async::Scheduler::get(); // Ensure the shared pool is created on the main thread.
 
     d->sync.connectExit([this] { d->after_redraw(); });
 }
@@ -590,9 +651,13 @@ void CanvasPrivate::launch_redraw()
     if (q->_need_update || affine_changed) {
         FrameCheck::Event fc;
         if (prefs.debug_framecheck) fc = FrameCheck::Event("update");
+        // If only the affine has changed, the store has just been recreated, so there is nothing for the
+        // canvas items to invalidate, and their requests would discard content restored from the tile cache.
+        ignore_redraw_requests = !q->_need_update;
         q->_need_update = false;
         canvasitem_ctx->setAffine(stores.store().affine);
         canvasitem_ctx->root()->update(affine_changed);
+        ignore_redraw_requests = false;
     }
 
     // Update strategy.
@@ -619,6 +684,7 @@ void CanvasPrivate::launch_redraw()
     }
 
     // Snapshot the CanvasItems and DrawingItems.
+    stores.begin_redraw();
     canvasitem_ctx->snapshot();
     q->_drawing->snapshot();
 
@@ -637,6 +703,12 @@ void CanvasPrivate::launch_redraw()
         rd.visible = (Geom::Parallelogram(rd.visible) * q->_affine.inverse() * stores.store().affine).bounds().roundOutwards();
     }
 
+    // Predict how far the view will travel, also in store space.
+    rd.lookahead = pan_tracker.velocity(g_get_monotonic_time()) * (prefs.prerender_lookahead / 1000.0);
+    if (stores.mode() == Stores::Mode::Decoupled) {
+        rd.lookahead *= (q->_affine.inverse() * stores.store().affine).withoutTranslation();
+    }
+
     // Get other misc data.
     rd.store = Fragment{ stores.store().affine, stores.store().rect };
     rd.decoupled_mode = stores.mode() == Stores::Mode::Decoupled;
@@ -646,21 +718,26 @@ void CanvasPrivate::launch_redraw()
     rd.tile_size = prefs.tile_size;
     rd.preempt = prefs.preempt;
     rd.margin = prefs.prerender;
+    rd.padding = prefs.padding;
     rd.redraw_delay = prefs.debug_delay_redraw ? std::make_optional<int>(prefs.debug_delay_redraw_time) : std::nullopt;
     rd.render_time_limit = prefs.render_time_limit;
     rd.numthreads = get_numthreads();
     rd.background_in_stores_required = background_in_stores_required();
     rd.page = page;
     rd.desk = desk;
+    rd.cms_transform = get_cms_transform();
+    rd.preview_downscale = prefs.progressive_render ? prefs.progressive_downscale : 0;
     rd.debug_framecheck = prefs.debug_framecheck;
     rd.debug_show_redraw = prefs.debug_show_redraw;
 
     rd.snapshot_drawn = stores.snapshot().drawn ? stores.snapshot().drawn->copy() : Cairo::RefPtr<Cairo::Region>();
+    rd.previewed = previewed->copy();
+    rd.refined = Cairo::Region::create();
     rd.grabbed = q->_grabbed_canvas_item && prefs.block_updates ? (roundedOutwards(q->_grabbed_canvas_item->get_bounds()) & rd.visible & rd.store.rect).regularized() : Geom::OptIntRect();
 
     abort_flags.store((int)AbortFlags::None, std::memory_order_relaxed);
 
-    boost::asio::post(*pool, [this] { init_tiler(); });
+    Inkscape::Async::Scheduler::get().post([this] { init_tiler(); }, Inkscape::Async::Priority::Interactive);
 }
 
 void CanvasPrivate::after_redraw()
@@ -708,12 +785,20 @@ void CanvasPrivate::handle_stores_action(Stores::Action action)
             invalidated->do_union(geom_to_cairo(stores.store().rect));
             updater->reset();
 
+            // Except for content restored from the tile cache, which is already up to date.
+            for (int i = 0; i < stores.store().drawn->get_num_rectangles(); i++) {
+                updater->mark_clean(cairo_to_geom(stores.store().drawn->get_rectangle(i)));
+            }
+            invalidated->subtract(stores.store().drawn);
+            previewed = Cairo::Region::create();
+
             if (prefs.debug_show_unclean) q->queue_draw();
             break;
 
         case Stores::Action::Shifted:
             invalidated->intersect(geom_to_cairo(stores.store().rect));
             updater->intersect(stores.store().rect);
+            previewed->intersect(geom_to_cairo(stores.store().rect));
 
             if (prefs.debug_show_unclean) q->queue_draw();
             break;
@@ -739,23 +824,17 @@ void CanvasPrivate::commit_tiles()
         tiles = std::move(rd.tiles);
     }
 
-    auto cms_system = Inkscape::CMSSystem::get();
     for (auto &tile : tiles) {
-        // Todo: Make CMS system thread-safe, then move this to render thread too.
-        if (q->_cms_active) {
-            auto transf = prefs.from_display
-                ? cms_system->get_display_transform_monitor(q->_cms_key)
-                : cms_system->get_display_transform_system();
-            if (transf) {
-                tile.surface->flush();
-                auto px = tile.surface->get_data();
-                int stride = tile.surface->get_stride();
-                for (int i = 0; i < tile.surface->get_height(); i++) {
-                    auto row = px + i * stride;
-                    Inkscape::CMSSystem::do_transform(transf, row, row, tile.surface->get_width());
-                }
-                tile.surface->mark_dirty();
-            }
+        // Remember the tile for when this zoom level is revisited. (Not in outline mode, where there are two layers.)
+        if (!tile.outline_surface && !tile.preview) {
+            stores.cache_tile(tile.fragment, tile.surface);
+        }
+
+        // Keep track of which content is only a preview.
+        if (tile.preview) {
+            previewed->do_union(geom_to_cairo(tile.fragment.rect));
+        } else {
+            previewed->subtract(geom_to_cairo(tile.fragment.rect));
         }
 
         // Paste tile content onto stores.
@@ -1571,6 +1650,8 @@ void Canvas::redraw_all()
         return;
     }
     d->invalidated->do_union(geom_to_cairo(d->stores.store().rect));
+    d->stores.clear_cache();
+    d->previewed = Cairo::Region::create();
     d->schedule_redraw();
     if (d->prefs.debug_show_unclean) queue_draw();
 }
@@ -1586,6 +1667,10 @@ void Canvas::redraw_area(int x0, int y0, int x1, int y1)
         return;
     }
 
+    if (d->ignore_redraw_requests) {
+        return;
+    }
+
     // Clamp area to Cairo's technically supported max size (-2^30..+2^30-1).
     // This ensures that the rectangle dimensions don't overflow and wrap around.
     constexpr int min_coord = -(1 << 30);
@@ -1607,6 +1692,8 @@ void Canvas::redraw_area(int x0, int y0, int x1, int y1)
 
     auto const rect = Geom::IntRect(x0, y0, x1, y1);
     d->invalidated->do_union(geom_to_cairo(rect));
+    d->stores.invalidate(rect);
+    d->previewed->subtract(geom_to_cairo(rect));
     d->schedule_redraw();
     if (d->prefs.debug_show_unclean) queue_draw();
 }
@@ -1652,6 +1739,7 @@ void Canvas::set_pos(Geom::IntPoint const &pos)
         return;
     }
 
+    d->pan_tracker.moved(pos - _pos, g_get_monotonic_time());
     _pos = pos;
 
     d->schedule_redraw();
@@ -1667,6 +1755,8 @@ void Canvas::set_affine(Geom::Affine const &affine)
         return;
     }
 
+    // Zooming or rotating makes the view jump, which is not a pan.
+    d->pan_tracker.reset();
     _affine = affine;
 
     d->schedule_redraw();
@@ -2089,6 +2179,8 @@ void CanvasPrivate::init_tiler()
     rd.start_time = g_get_monotonic_time();
     rd.phase = 0;
     rd.vis_store = (rd.visible & rd.store.rect).regularized();
+    rd.preview = false;
+    rd.preview_done = false;
 
     if (!init_redraw()) {
         sync.signalExit();
@@ -2101,7 +2193,7 @@ void CanvasPrivate::init_tiler()
     rd.numactive = rd.numthreads;
 
     for (int i = 0; i < rd.numthreads - 1; i++) {
-        boost::asio::post(*pool, [=] { render_tile(i); });
+        Inkscape::Async::Scheduler::get().post([=] { render_tile(i); }, Inkscape::Async::Priority::Interactive);
     }
 
     render_tile(rd.numthreads - 1);
@@ -2135,6 +2227,13 @@ bool CanvasPrivate::init_redraw()
 
         case 2:
             if (rd.vis_store) {
+                // In progressive mode, first cover the whole of the visible content that is not clean with a quick reduced-resolution preview.
+                if (rd.preview_downscale && !rd.preview_done) {
+                    rd.preview_done = true;
+                    process_preview(*rd.vis_store);
+                    return true;
+                }
+
                 // The main priority to redraw, and the bread and butter of Inkscape's painting, is the visible content that is not clean.
                 // This may be done over several cycles, at the direction of the Updater, each outwards from the mouse.
                 process_redraw(*rd.vis_store, updater->get_next_clean_region());
@@ -2147,8 +2246,14 @@ bool CanvasPrivate::init_redraw()
         case 3: {
             // The lowest priority to redraw is the prerender margin around the visible rectangle.
             // (This is in addition to any opportunistic prerendering that may have already occurred in the above steps.)
-            auto prerender = expandedBy(rd.visible, rd.margin);
+            auto prerender = get_prerender_rect();
             auto prerender_store = (prerender & rd.store.rect).regularized();
+
+            // While the view is moving, prerender outwards from where it is heading rather than from the mouse.
+            if (!rd.lookahead.isZero()) {
+                auto const reach = rd.visible.maxExtent() / 2.0 + rd.margin;
+                rd.mouse_loc = (Geom::Point(rd.visible.midpoint()) + Geom::unit_vector(rd.lookahead) * reach).round();
+            }
             if (prerender_store) {
                 process_redraw(*prerender_store, updater->clean_region);
                 return true;
@@ -2163,6 +2268,24 @@ bool CanvasPrivate::init_redraw()
     }
 }
 
+// Get the rectangle to prerender around the visible rectangle. While the view is moving, the margin is widened ahead of the
+// motion by the expected travel, up to the padding of the stores, and narrowed by the same amount behind it.
+Geom::IntRect CanvasPrivate::get_prerender_rect() const
+{
+    auto result = expandedBy(rd.visible, rd.margin);
+    for (auto i : { Geom::X, Geom::Y }) {
+        int const extra = std::min<double>(std::abs(rd.lookahead[i]), rd.padding);
+        int const ahead = rd.margin + extra;
+        int const behind = std::max(rd.margin - extra, 0);
+        if (rd.lookahead[i] > 0) {
+            result[i] = Geom::IntInterval(rd.visible[i].min() - behind, rd.visible[i].max() + ahead);
+        } else if (rd.lookahead[i] < 0) {
+            result[i] = Geom::IntInterval(rd.visible[i].min() - ahead, rd.visible[i].max() + behind);
+        }
+    }
+    return result;
+}
+
 // Paint a given subrectangle of the store given by 'bounds', but avoid painting the part of it within 'clean' if possible.
 // Some parts both outside the bounds and inside the clean region may also be painted if it helps reduce fragmentation.
 void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible, bool preemptible)
@@ -2194,6 +2317,28 @@ void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Ca
     rd.effective_tile_size = rd.tile_size * adjust;
 }
 
+// Queue the part of 'bounds' that is neither clean nor already previewed for painting at reduced resolution.
+// Unlike process_redraw(), the rectangles are not coarsened or extended, as a preview must never overwrite clean content.
+void CanvasPrivate::process_preview(Geom::IntRect const &bounds)
+{
+    rd.bounds = bounds;
+    rd.clean = unioned(updater->clean_region->copy(), rd.previewed);
+    rd.interruptible = true;
+    rd.preemptible = false;
+    rd.preview = true;
+
+    auto region = Cairo::Region::create(geom_to_cairo(rd.bounds));
+    region->subtract(rd.clean);
+
+    for (int i = 0; i < region->get_num_rectangles(); i++) {
+        rd.rects.emplace_back(cairo_to_geom(region->get_rectangle(i)));
+    }
+    std::make_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
+
+    // Previews are cheap, so use larger tiles.
+    rd.effective_tile_size = rd.tile_size * rd.preview_downscale;
+}
+
 // Process rectangles until none left or timed out.
 void CanvasPrivate::render_tile(int debug_id)
 {
@@ -2269,13 +2414,16 @@ void CanvasPrivate::render_tile(int debug_id)
             }
         }
 
-        // Mark the rectangle as clean.
-        updater->mark_clean(rect);
+        // Mark the rectangle as clean, unless it is only being previewed.
+        bool const preview = rd.preview;
+        if (!preview) {
+            updater->mark_clean(rect);
+        }
 
         rd.mutex.unlock();
 
         // Paint the rectangle.
-        paint_rect(rect);
+        paint_rect(rect, preview);
 
         rd.mutex.lock();
 
@@ -2320,6 +2468,11 @@ bool CanvasPrivate::end_redraw()
             return init_redraw();
 
         case 2:
+            if (rd.preview) {
+                // Finished the preview; now refine it at full resolution.
+                rd.preview = false;
+                return init_redraw();
+            }
             if (!updater->report_finished()) {
                 rd.phase++;
             }
@@ -2334,7 +2487,7 @@ bool CanvasPrivate::end_redraw()
     }
 }
 
-void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
+void CanvasPrivate::paint_rect(Geom::IntRect const &rect, bool preview)
 {
     // Make sure the paint rectangle lies within the store.
     assert(rd.store.rect.contains(rect));
@@ -2352,7 +2505,7 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
 
         try {
 
-            paint_single_buffer(surface, rect, need_background, outline_pass);
+            paint_single_buffer(surface, rect, need_background, outline_pass, preview ? rd.preview_downscale : 1);
 
         } catch (std::bad_alloc const &) {
             // Note: std::bad_alloc actually indicates a Cairo error that occurs regularly at high zoom, and we must handle it.
@@ -2373,7 +2526,19 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
     Tile tile;
     tile.fragment.affine = rd.store.affine;
     tile.fragment.rect = rect;
+    tile.preview = preview;
     tile.surface = paint(background_in_stores_required(), false);
+    if (rd.cms_transform) {
+        // Colour-correct on the render thread, before the tile reaches the stores.
+        tile.surface->flush();
+        auto px = tile.surface->get_data();
+        int stride = tile.surface->get_stride();
+        for (int i = 0; i < tile.surface->get_height(); i++) {
+            auto row = px + i * stride;
+            rd.cms_transform->do_transform(row, row, tile.surface->get_width());
+        }
+        tile.surface->mark_dirty();
+    }
     if (outlines_enabled) {
         tile.outline_surface = paint(false, true);
     }
@@ -2384,14 +2549,32 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
     // Stick the tile on the list of tiles to reap.
     {
         auto g = std::lock_guard(rd.tiles_mutex);
+        if (!preview) {
+            rd.refined->do_union(geom_to_cairo(rect));
+        } else if (rd.refined->contains_rectangle(geom_to_cairo(rect)) != Cairo::REGION_OVERLAP_OUT) {
+            // Overtaken by the full-resolution pass on another thread.
+            return;
+        }
         rd.tiles.emplace_back(std::move(tile));
     }
 }
 
-void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass)
+void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass, int downscale)
 {
+    // For a preview, paint into a smaller surface at the same device scale, and scale it up at the end.
+    auto target = surface;
+    if (downscale > 1) {
+        double sx, sy;
+        cairo_surface_get_device_scale(surface->cobj(), &sx, &sy);
+        int const width  = (rect.width()  + downscale - 1) / downscale;
+        int const height = (rect.height() + downscale - 1) / downscale;
+        target = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width * sx, height * sy);
+        cairo_surface_set_device_scale(target->cobj(), sx, sy);
+    }
+
     // Create Cairo context.
-    auto cr = Cairo::Context::create(surface);
+    auto cr = Cairo::Context::create(target);
+    cr->scale(1.0 / downscale, 1.0 / downscale);
 
     // Clear background.
     cr->save();
@@ -2413,6 +2596,17 @@ void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const
         cr->set_operator(Cairo::OPERATOR_OVER);
         cr->paint();
     }
+
+    // Scale up the preview to fill the tile.
+    if (target != surface) {
+        auto up = Cairo::Context::create(surface);
+        up->scale(downscale, downscale);
+        up->set_source(target, 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(up->cobj()), CAIRO_FILTER_BILINEAR);
+        cairo_pattern_set_extend(cairo_get_source(up->cobj()), CAIRO_EXTEND_PAD);
+        up->set_operator(Cairo::OPERATOR_SOURCE);
+        up->paint();
+    }
 }
 
 void CanvasPrivate::paint_error_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface)
@@ -2424,6 +2618,19 @@ void CanvasPrivate::paint_error_buffer(Cairo::RefPtr<Cairo::ImageSurface> const
     cr->paint();
 }
 
+// Fetch the display transform on the main thread, for use by the render threads.
+std::shared_ptr<CMSTransform const> CanvasPrivate::get_cms_transform() const
+{
+    if (!q->_cms_active) {
+        return {};
+    }
+
+    auto cms_system = Inkscape::CMSSystem::get();
+    return prefs.from_display
+        ? cms_system->get_display_transform_monitor(q->_cms_key)
+        : cms_system->get_display_transform_system();
+}
+
 } // namespace Inkscape::UI::Widget
 
 /*
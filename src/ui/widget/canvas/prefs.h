@@ -22,6 +22,8 @@ public:
     Pref<bool>   request_opengl           = { "/options/rendering/request_opengl" };
     Pref<int>    grabsize                 = { "/options/grabsize/value", 3, 1, 15 };
     Pref<int>    numthreads               = { "/options/threading/numthreads", 0, 1, 256 };
+    Pref<int>    tile_cache_size          = { "/options/rendering/tile_cache_size", 256, 0, 4096 }; // MiB
+    Pref<bool>   progressive_render       = { "/options/rendering/progressive_render" };
 
     // Colour management
     Pref<bool>   from_display             = { "/options/displayprofile/from_display" };
@@ -39,10 +41,12 @@ public:
     Pref<int>    pixelstreamer_method     = { "/options/rendering/pixelstreamer_method", 1, 1, 4 };
     Pref<int>    padding                  = { "/options/rendering/padding", 350, 0, 1000 };
     Pref<int>    prerender                = { "/options/rendering/prerender", 100, 0, 1000 };
+    Pref<int>    prerender_lookahead      = { "/options/rendering/prerender_lookahead", 250, 0, 2000 }; // ms
     Pref<int>    preempt                  = { "/options/rendering/preempt", 250, 0, 1000 };
     Pref<int>    coarsener_min_size       = { "/options/rendering/coarsener_min_size", 200, 0, 1000 };
     Pref<int>    coarsener_glue_size      = { "/options/rendering/coarsener_glue_size", 80, 0, 1000 };
     Pref<double> coarsener_min_fullness   = { "/options/rendering/coarsener_min_fullness", 0.3, 0.0, 1.0 };
+    Pref<int>    progressive_downscale    = { "/options/rendering/progressive_downscale", 4, 2, 8 };
 
     // Debug switches
     Pref<bool>   debug_framecheck         = { "/options/rendering/debug_framecheck" };
@@ -68,10 +72,12 @@ private:
         pixelstreamer_method.set_enabled(on);
         padding.set_enabled(on);
         prerender.set_enabled(on);
+        prerender_lookahead.set_enabled(on);
         preempt.set_enabled(on);
         coarsener_min_size.set_enabled(on);
         coarsener_glue_size.set_enabled(on);
         coarsener_min_fullness.set_enabled(on);
+        progressive_downscale.set_enabled(on);
         debug_framecheck.set_enabled(on);
         debug_logging.set_enabled(on);
         debug_delay_redraw.set_enabled(on);
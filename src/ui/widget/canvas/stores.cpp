@@ -94,9 +94,11 @@ void Stores::recreate_store(Fragment const &view)
     // Recreate the store at the view's affine.
     _store.affine = view.affine;
     _store.rect = centered(view);
-    _store.drawn = Cairo::Region::create();
     // Tell the graphics to create a blank new store.
     _graphics->recreate_store(_store.rect.dimensions());
+    // Fill it with any content still cached from a previous visit to this zoom level.
+    _store.drawn = _tile_cache.restore(_store, *_graphics);
+    if (_prefs.debug_logging && !_store.drawn->empty()) std::cout << "Restored store from tile cache" << std::endl;
 }
 
 void Stores::shift_store(Fragment const &view)
@@ -239,11 +241,14 @@ void Stores::reset()
     _mode = Mode::None;
     _store.drawn.clear();
     _snapshot.drawn.clear();
+    _tile_cache.clear();
 }
 
 // Handle transitions and actions in response to viewport changes.
 auto Stores::update(Fragment const &view) -> Action
 {
+    _tile_cache.set_budget(static_cast<std::size_t>(_prefs.tile_cache_size) << 20);
+
     switch (_mode) {
         
         case Mode::None: {
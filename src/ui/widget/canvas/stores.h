@@ -8,6 +8,7 @@
 #define INKSCAPE_UI_WIDGET_CANVAS_STORES_H
 
 #include "fragment.h"
+#include "tilecache.h"
 #include "util.h"
 
 namespace Inkscape {
@@ -64,6 +65,18 @@ public:
     /// Record a rectangle as being drawn to the store.
     void mark_drawn(Geom::IntRect const &rect) { _store.drawn->do_union(geom_to_cairo(rect)); }
 
+    /// Keep a copy of a tile drawn to the store, to be reused when returning to its zoom level.
+    void cache_tile(Fragment const &fragment, Cairo::RefPtr<Cairo::ImageSurface> const &surface) { _tile_cache.insert(fragment, surface); }
+
+    /// Mark a rectangle of the store as out of date in the tile cache at every zoom level.
+    void invalidate(Geom::IntRect const &rect) { if (_mode != Mode::None) _tile_cache.invalidate(rect, _store.affine); }
+
+    /// Discard all cached tiles.
+    void clear_cache() { _tile_cache.clear(); }
+
+    /// Indicate the start of a redraw, from which tiles reflect all previous invalidations.
+    void begin_redraw() { _tile_cache.begin_redraw(); }
+
     // Getters.
     Store const &store() const { return _store; }
     Store const &snapshot() const { return _snapshot; }
@@ -74,6 +87,9 @@ private:
     Mode _mode;
     Store _store, _snapshot;
 
+    // Content of previously visited zoom levels.
+    TileCache _tile_cache;
+
     // The graphics object that executes the operations on the stores.
     Graphics *_graphics;
 
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <algorithm>
+#include <cmath>
+#include <cairomm/context.h>
+#include <2geom/parallelogram.h>
+#include "helper/geom.h"
+#include "ui/util.h"
+#include "tilecache.h"
+#include "graphics.h"
+
+namespace Inkscape {
+namespace UI {
+namespace Widget {
+namespace {
+
+int floordiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+bool same_affine(Geom::Affine const &a, Geom::Affine const &b)
+{
+    return Geom::are_near(a, b, 1e-9);
+}
+
+template <typename F>
+void for_each_rect(Cairo::RefPtr<Cairo::Region> const &reg, F &&f)
+{
+    for (int i = 0; i < reg->get_num_rectangles(); i++) {
+        f(cairo_to_geom(reg->get_rectangle(i)));
+    }
+}
+
+} // namespace
+
+void TileCache::set_budget(std::size_t budget)
+{
+    _budget = budget;
+    if (_budget == 0) {
+        clear();
+        return;
+    }
+    while (_bytes > _budget && !_levels.empty()) {
+        auto &level = _levels.back();
+        while (!level.cells.empty() && _bytes > _budget) {
+            drop_cell(level, level.cells.begin());
+        }
+        if (level.cells.empty()) {
+            _levels.pop_back();
+        }
+    }
+}
+
+void TileCache::clear()
+{
+    _levels.clear();
+    _bytes = 0;
+    _pending.clear();
+}
+
+void TileCache::begin_redraw()
+{
+    _pending.clear();
+}
+
+void TileCache::invalidate(Geom::IntRect const &rect, Geom::Affine const &affine)
+{
+    if (!_pending || !same_affine(_pending_affine, affine)) {
+        _pending = Cairo::Region::create();
+        _pending_affine = affine;
+    }
+    _pending->do_union(geom_to_cairo(rect));
+
+    for (auto it = _levels.begin(); it != _levels.end(); ) {
+        auto &level = *it;
+
+        // Map the rectangle into the level. Canvas items such as handles keep their size on screen
+        // rather than scaling with the affine, so allow a generous margin for them.
+        Geom::IntRect r = rect;
+        if (!same_affine(level.affine, affine)) {
+            auto bounds = (Geom::Parallelogram(rect) * affine.inverse() * level.affine).bounds();
+            constexpr double max = 1 << 30;
+            if (!(Geom::Rect(-max, -max, max, max).contains(bounds))) {
+                // Too large to represent; the whole level is affected.
+                _bytes -= level.cells.size() * cell_bytes();
+                it = _levels.erase(it);
+                continue;
+            }
+            r = expandedBy(bounds.roundOutwards(), FIXED_SIZE_MARGIN);
+        }
+
+        // Visit the cached cells rather than the covered ones, as the rectangle may be huge when mapped.
+        for (auto cit = level.cells.begin(); cit != level.cells.end(); ) {
+            auto const &[index, cell] = *cit;
+            auto const cell_rect = Geom::IntRect::from_xywh(index.first * CELL_SIZE, index.second * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+            if (cell_rect.intersects(r)) {
+                cell.valid->subtract(geom_to_cairo(r));
+            }
+            if (cell.valid->empty()) {
+                cit = drop_cell(level, cit);
+            } else {
+                ++cit;
+            }
+        }
+
+        if (level.cells.empty()) {
+            it = _levels.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TileCache::insert(Fragment const &fragment, Cairo::RefPtr<Cairo::ImageSurface> const &surface)
+{
+    if (_budget == 0) {
+        return;
+    }
+
+    double sx, sy;
+    cairo_surface_get_device_scale(surface->cobj(), &sx, &sy);
+    int const scale = std::round(sx);
+    if (scale != _scale) {
+        clear();
+        _scale = scale;
+    }
+
+    // Skip content that was invalidated while this tile was being rendered.
+    auto region = Cairo::Region::create(geom_to_cairo(fragment.rect));
+    if (_pending && same_affine(_pending_affine, fragment.affine)) {
+        region->subtract(_pending);
+    }
+    if (region->empty()) {
+        return;
+    }
+
+    auto it = find(fragment.affine);
+    if (it == _levels.end()) {
+        _levels.emplace_front();
+        _levels.front().affine = fragment.affine;
+    } else {
+        _levels.splice(_levels.begin(), _levels, it);
+    }
+    auto &level = _levels.front();
+
+    auto const &r = fragment.rect;
+    for (int cy = floordiv(r.top(), CELL_SIZE); cy <= floordiv(r.bottom() - 1, CELL_SIZE); cy++) {
+        for (int cx = floordiv(r.left(), CELL_SIZE); cx <= floordiv(r.right() - 1, CELL_SIZE); cx++) {
+            auto const cell_rect = Geom::IntRect::from_xywh(cx * CELL_SIZE, cy * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+            auto part = Cairo::Region::create(geom_to_cairo(cell_rect));
+            part->intersect(region);
+            if (part->empty()) {
+                continue;
+            }
+
+            auto &cell = level.cells[{cx, cy}];
+            if (!cell.surface) {
+                if (!make_room(level)) {
+                    level.cells.erase({cx, cy});
+                    return;
+                }
+                cell.surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, CELL_SIZE * _scale, CELL_SIZE * _scale);
+                cairo_surface_set_device_scale(cell.surface->cobj(), _scale, _scale);
+                cell.valid = Cairo::Region::create();
+                _bytes += cell_bytes();
+            }
+
+            auto cr = Cairo::Context::create(cell.surface);
+            for_each_rect(part, [&] (Geom::IntRect const &rect) {
+                auto const local = rect - cell_rect.min();
+                cr->rectangle(local.left(), local.top(), local.width(), local.height());
+            });
+            cr->clip();
+            cr->set_operator(Cairo::OPERATOR_SOURCE);
+            cr->set_source(surface, r.left() - cell_rect.left(), r.top() - cell_rect.top());
+            cr->paint();
+
+            cell.valid->do_union(part);
+        }
+    }
+}
+
+Cairo::RefPtr<Cairo::Region> TileCache::restore(Fragment const &store, Graphics &graphics)
+{
+    auto result = Cairo::Region::create();
+
+    auto it = find(store.affine);
+    if (it == _levels.end()) {
+        return result;
+    }
+    _levels.splice(_levels.begin(), _levels, it);
+    auto &level = _levels.front();
+
+    for (auto &[index, cell] : level.cells) {
+        auto const cell_rect = Geom::IntRect::from_xywh(index.first * CELL_SIZE, index.second * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+        if (!store.rect.intersects(cell_rect)) {
+            continue;
+        }
+
+        auto part = cell.valid->copy();
+        part->intersect(geom_to_cairo(store.rect));
+
+        for_each_rect(part, [&] (Geom::IntRect const &rect) {
+            auto surface = graphics.request_tile_surface(rect, false);
+            {
+                auto cr = Cairo::Context::create(surface);
+                cr->set_operator(Cairo::OPERATOR_SOURCE);
+                cr->set_source(cell.surface, cell_rect.left() - rect.left(), cell_rect.top() - rect.top());
+                cr->paint();
+            }
+            graphics.draw_tile(Fragment{ store.affine, rect }, std::move(surface), {});
+        });
+
+        result->do_union(part);
+    }
+
+    return result;
+}
+
+auto TileCache::find(Geom::Affine const &affine) -> std::list<Level>::iterator
+{
+    return std::find_if(_levels.begin(), _levels.end(), [&] (Level const &level) {
+        return same_affine(level.affine, affine);
+    });
+}
+
+std::size_t TileCache::cell_bytes() const
+{
+    return std::size_t{4} * CELL_SIZE * CELL_SIZE * _scale * _scale;
+}
+
+auto TileCache::drop_cell(Level &level, CellMap::iterator it) -> CellMap::iterator
+{
+    _bytes -= cell_bytes();
+    return level.cells.erase(it);
+}
+
+// Evict the least recently used levels other than 'keep' until there is room for one more cell.
+bool TileCache::make_room(Level const &keep)
+{
+    while (_bytes + cell_bytes() > _budget) {
+        if (_levels.empty() || &_levels.back() == &keep) {
+            return false;
+        }
+        auto &level = _levels.back();
+        _bytes -= level.cells.size() * cell_bytes();
+        _levels.pop_back();
+    }
+    return true;
+}
+
+} // namespace Widget
+} // namespace UI
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Cache of rendered content at recently visited zoom levels.
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_UI_WIDGET_CANVAS_TILECACHE_H
+#define INKSCAPE_UI_WIDGET_CANVAS_TILECACHE_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <utility>
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+#include <cairomm/refptr.h>
+#include <cairomm/region.h>
+#include <cairomm/surface.h>
+#include "fragment.h"
+
+namespace Inkscape {
+namespace UI {
+namespace Widget {
+class Graphics;
+
+/**
+ * Retains rendered content for the affines the store was recently drawn at, so that returning to
+ * a previous zoom level can fill the new store without rendering.
+ *
+ * Content is kept per affine in a grid of fixed-size cells, each remembering the part of it that
+ * holds valid content. Invalidations are mapped into every level. The least recently used levels
+ * are evicted first when the memory budget is exceeded.
+ */
+class TileCache
+{
+public:
+    /// Set the memory budget in bytes. Zero disables the cache.
+    void set_budget(std::size_t budget);
+
+    /// Discard all content.
+    void clear();
+
+    /// Start of a redraw. Content rendered from here on reflects all invalidations so far.
+    void begin_redraw();
+
+    /// Mark a rectangle as out of date, given in the coordinates of the given affine.
+    void invalidate(Geom::IntRect const &rect, Geom::Affine const &affine);
+
+    /// Copy a rendered tile into the cache.
+    void insert(Fragment const &fragment, Cairo::RefPtr<Cairo::ImageSurface> const &surface);
+
+    /**
+     * Paste all cached content for the store's affine within its rectangle into the store.
+     * Returns the region that was pasted.
+     */
+    Cairo::RefPtr<Cairo::Region> restore(Fragment const &store, Graphics &graphics);
+
+    std::size_t memory_usage() const { return _bytes; }
+
+private:
+    static constexpr int CELL_SIZE = 256;
+    static constexpr int FIXED_SIZE_MARGIN = 64;
+
+    struct Cell
+    {
+        Cairo::RefPtr<Cairo::ImageSurface> surface;
+        Cairo::RefPtr<Cairo::Region> valid;
+    };
+
+    using CellMap = std::map<std::pair<int, int>, Cell>;
+
+    struct Level
+    {
+        Geom::Affine affine;
+        CellMap cells;
+    };
+
+    std::list<Level> _levels; // Most recently used first.
+    std::size_t _budget = 0;
+    std::size_t _bytes = 0;
+    int _scale = 0; // Device scale of all cell surfaces.
+
+    // Invalidations of the current level since the start of the redraw; tiles of this redraw do
+    // not have up-to-date content there.
+    Cairo::RefPtr<Cairo::Region> _pending;
+    Geom::Affine _pending_affine;
+
+    std::list<Level>::iterator find(Geom::Affine const &affine);
+    std::size_t cell_bytes() const;
+    CellMap::iterator drop_cell(Level &level, CellMap::iterator it);
+    bool make_room(Level const &keep);
+};
+
+} // namespace Widget
+} // namespace UI
+} // namespace Inkscape
+
+#endif // INKSCAPE_UI_WIDGET_CANVAS_TILECACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -16,6 +16,7 @@
 #include <unordered_map>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <algorithm>
 
 namespace Inkscape {
@@ -37,8 +38,13 @@ namespace Util {
  *     my_ptr = my_cached_map.lookup(k)
  *
  * When all copies of the shared_ptr my_ptr have expired, the object is marked as unused. However
- * it is not immediately deleted. As further objects are marked as unused, the oldest unused
- * objects are gradually deleted, with their number never exceeding the value max_cache_size.
+ * it is not immediately deleted. As further objects are added, the oldest unused objects are
+ * gradually deleted, with their number never exceeding the value max_cache_size when add()
+ * returns.
+ *
+ * The map may be used from several threads, and its shared pointers released on any of them.
+ * Objects are only ever deleted by add() and clear(), so a factory that serialises its calls
+ * to these also serialises the destruction of its objects.
  *
  * Note that the cache must not be destroyed while any shared pointers to any of its objects are
  * still active. This is in accord with its expected usage; if the factory loads objects from an
@@ -65,8 +71,13 @@ public:
      */
     auto add(Tk key, std::unique_ptr<Tv> value)
     {
+        auto lock = std::lock_guard(mutex);
         auto ret = map.emplace(std::move(key), std::move(value));
-        return get_view(ret.first->second);
+        auto view = get_view(ret.first->second);
+        while (unused.size() > max_cache_size) {
+            pop_unused();
+        }
+        return view;
     }
 
     /**
@@ -76,6 +87,7 @@ public:
      */
     auto lookup(Tk const &key) -> std::shared_ptr<Tv>
     {
+        auto lock = std::lock_guard(mutex);
         if (auto it = map.find(key); it != map.end()) {
             return get_view(it->second);
         } else {
@@ -85,6 +97,7 @@ public:
 
     void clear()
     {
+        auto lock = std::lock_guard(mutex);
         unused.clear();
         map.clear();
     }
@@ -98,8 +111,9 @@ private:
     };
 
     std::size_t const max_cache_size;
-    std::unordered_map<Tk, Item, Hash, Compare> map;
+    std::unordered_map<Tk, Item, Hash, Compare> map; // Node-based, so Items never move.
     std::deque<Tv*> unused;
+    std::mutex mutex;
 
     auto get_view(Item &item)
     {
@@ -107,8 +121,12 @@ private:
             return view;
         } else {
             remove_unused(item.value.get());
-            auto new_view = std::shared_ptr<Tv>(item.value.get(), [this] (Tv *value) {
-                push_unused(value);
+            auto new_view = std::shared_ptr<Tv>(item.value.get(), [this, &item] (Tv *value) {
+                auto lock = std::lock_guard(mutex);
+                // Unless another thread looked it up again in the meantime.
+                if (item.view.expired()) {
+                    push_unused(value);
+                }
             });
             item.view = new_view;
             return new_view;
@@ -125,10 +143,8 @@ private:
 
     void push_unused(Tv *value)
     {
+        remove_unused(value); // An earlier view may have expired late.
         unused.emplace_back(value);
-        if (unused.size() > max_cache_size) {
-            pop_unused();
-        }
     }
 
     void pop_unused()
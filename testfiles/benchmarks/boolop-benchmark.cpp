@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark and comparison of the two implementations of boolean operations.
+ *
+ * Runs union, intersection, difference and exclusion on pairs of path vectors, once with livarot
+ * and once with Geom::PathIntersectionGraph through sp_pathvector_boolop_2geom(), and reports the
+ * best time of a few runs, the number of nodes and the area of each result as JSON on standard
+ * output. The inputs are the shapes of path-boolop-test, and generated ones: smooth blobs made of
+ * the given numbers of cubic segments, and grids of circles overlapping a shifted copy.
+ *
+ * Usage: boolop-benchmark [--repeat N] [SEGMENTS...]
+ *
+ * The areas of the two results of an operation are expected to agree to within the flattening
+ * tolerance of livarot; if they do not, or if the 2geom backend fails and would fall back to
+ * livarot, this is reported on standard error and the exit status is 1.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <2geom/circle.h>
+#include <2geom/path.h>
+#include <2geom/pathvector.h>
+#include <2geom/sbasis-geometric.h>
+
+#include "path/path-boolop.h"
+#include "svg/svg.h"
+
+namespace {
+
+struct Input
+{
+    std::string name;
+    Geom::PathVector a;
+    Geom::PathVector b;
+};
+
+/// A closed path around center whose distance to it varies smoothly, so that it never crosses itself.
+Geom::Path blob(Geom::Point const &center, double radius, int segments, std::mt19937 &gen)
+{
+    std::uniform_real_distribution<double> phase(0, 2 * M_PI);
+    double const p1 = phase(gen);
+    double const p2 = phase(gen);
+    auto const point = [&] (double t) {
+        double const r = radius * (1 + 0.2 * std::sin(5 * t + p1) + 0.1 * std::sin(13 * t + p2));
+        return center + Geom::Point::polar(t, r);
+    };
+
+    double const step = 2 * M_PI / segments;
+    Geom::Path path(point(0));
+    for (int i = 0; i < segments; i++) {
+        // Control points along the chord, bent outwards a little.
+        auto const p = point(i * step);
+        auto const q = point((i + 1) * step);
+        auto const bulge = Geom::rot90(q - p) * -0.1;
+        path.appendNew<Geom::CubicBezier>(p + (q - p) / 3 + bulge, q - (q - p) / 3 + bulge, q);
+    }
+    path.close();
+    return path;
+}
+
+Input blobs(int segments, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    return {"blobs-" + std::to_string(segments),
+            Geom::PathVector(blob({0, 0}, 100, segments, gen)),
+            Geom::PathVector(blob({60, 20}, 100, segments, gen))};
+}
+
+Input circles(int count)
+{
+    Input input{"circles-" + std::to_string(count), {}, {}};
+    int const side = std::ceil(std::sqrt(count));
+    for (int i = 0; i < count; i++) {
+        Geom::Point const center(i % side * 30, i / side * 30);
+        input.a.push_back(Geom::Path(Geom::Circle(center, 12)));
+        input.b.push_back(Geom::Path(Geom::Circle(center + Geom::Point(10, 7), 12)));
+    }
+    return input;
+}
+
+std::vector<Input> corpus()
+{
+    // The shapes of testfiles/src/path-boolop-test.cpp
+    auto const bigger = sp_svg_read_pathv("M 0,0 L 0,2 L 2,2 L 2,0 z");
+    auto const smaller = sp_svg_read_pathv("M 0.5,0.5 L 0.5,1.5 L 1.5,1.5 L 1.5,0.5 z");
+    auto const outside = sp_svg_read_pathv("M 0,1.5 L 0.5,1.5 L 0.5,2.5 L 0,2.5 z");
+    return {
+        {"test-bigger-smaller", bigger, smaller},
+        {"test-bigger-outside", bigger, outside},
+        {"test-smaller-outside", smaller, outside},
+    };
+}
+
+double area(Geom::PathVector const &pathv)
+{
+    if (pathv.empty()) {
+        return 0;
+    }
+    Geom::Point centroid;
+    double area = 0;
+    Geom::centroid(pathv.toPwSb(), centroid, area);
+    return std::abs(area);
+}
+
+std::size_t nodes(Geom::PathVector const &pathv)
+{
+    std::size_t count = 0;
+    for (auto const &path : pathv) {
+        count += path.size_default();
+    }
+    return count;
+}
+
+template <typename F>
+double best_ms(int repeat, F &&f)
+{
+    double best = INFINITY;
+    for (int r = 0; r < repeat; r++) {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+/// Returns false if the backends disagree.
+bool run(Input const &input, int repeat, bool first)
+{
+    static std::pair<bool_op, char const *> const ops[] = {
+        {bool_op_union, "union"},
+        {bool_op_inters, "intersection"},
+        {bool_op_diff, "difference"},
+        {bool_op_symdiff, "exclusion"},
+    };
+
+    bool ok = true;
+    std::cout << (first ? "" : ",\n") << "    {\n"
+              << "      \"input\": \"" << input.name << "\",\n"
+              << "      \"nodes\": " << nodes(input.a) + nodes(input.b) << ",\n"
+              << "      \"operations\": [\n";
+
+    for (std::size_t i = 0; i < std::size(ops); i++) {
+        auto const [bop, name] = ops[i];
+
+        Geom::PathVector livarot;
+        double const livarot_ms = best_ms(repeat, [&] {
+            livarot = sp_pathvector_boolop(input.a, input.b, bop, fill_nonZero, fill_nonZero, true);
+        });
+
+        std::optional<Geom::PathVector> geom;
+        double const geom_ms = best_ms(repeat, [&] {
+            geom = sp_pathvector_boolop_2geom(input.a, input.b, bop, fill_nonZero, fill_nonZero);
+        });
+
+        double const livarot_area = area(livarot);
+        double const geom_area = geom ? area(*geom) : NAN;
+        double const scale = std::max(area(input.a), area(input.b));
+        bool const agree = geom && std::abs(livarot_area - geom_area) <= 1e-2 * scale;
+        if (!geom) {
+            std::cerr << input.name << ", " << name << ": 2geom backend failed" << std::endl;
+        } else if (!agree) {
+            std::cerr << input.name << ", " << name << ": area " << geom_area << " with 2geom, "
+                      << livarot_area << " with livarot" << std::endl;
+        }
+        ok = ok && agree;
+
+        std::cout << (i ? ",\n" : "") << "        {\n"
+                  << "          \"operation\": \"" << name << "\",\n"
+                  << "          \"livarot_ms\": " << livarot_ms << ",\n"
+                  << "          \"livarot_nodes\": " << nodes(livarot) << ",\n"
+                  << "          \"livarot_area\": " << livarot_area << ",\n"
+                  << "          \"2geom_ms\": " << geom_ms << ",\n"
+                  << "          \"2geom_nodes\": " << (geom ? nodes(*geom) : 0) << ",\n"
+                  << "          \"2geom_area\": " << (geom ? geom_area : 0) << ",\n"
+                  << "          \"agree\": " << (agree ? "true" : "false") << "\n        }";
+    }
+    std::cout << "\n      ]\n    }";
+    return ok;
+}
+
+int usage()
+{
+    std::cerr << "Usage: boolop-benchmark [--repeat N] [SEGMENTS...]" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int repeat = 3;
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-' && std::atoi(arg.c_str()) > 0) {
+            sizes.push_back(std::atoi(arg.c_str()));
+        } else {
+            return usage();
+        }
+    }
+    if (sizes.empty()) {
+        sizes = { 100, 1000, 10000 };
+    }
+
+    auto inputs = corpus();
+    for (std::size_t n = 0; n < sizes.size(); n++) {
+        inputs.push_back(blobs(sizes[n], n + 1));
+        inputs.push_back(circles(std::max(1, sizes[n] / 4)));
+    }
+
+    bool ok = true;
+    std::cout << "{\n  \"results\": [\n";
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        ok = run(inputs[i], repeat, i == 0) && ok;
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return ok ? 0 : 1;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
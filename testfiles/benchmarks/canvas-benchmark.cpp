@@ -0,0 +1,484 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Headless benchmark of the canvas redraw loop.
+ *
+ * Loads each SVG file given on the command line, then replays a script of pans, zooms and edits
+ * against the canvas stores, updater and tile cache, rendering with the Cairo backend into an
+ * offscreen store. Reports per-frame latency percentiles, tile counts and cache hit rates as JSON
+ * on standard output.
+ *
+ * Usage: canvas-benchmark [--script FILE] [--size WxH] [--repeat N] FILE.svg...
+ *
+ * A script has one command per line; blank lines and lines starting with '#' are ignored.
+ *
+ *   pan DX DY [STEPS]    Move the view by (DX, DY) pixels over STEPS frames.
+ *   zoom FACTOR [STEPS]  Zoom about the centre of the view by FACTOR over STEPS frames.
+ *   edit [COUNT]         Nudge COUNT shapes by one pixel, one frame each.
+ *   redraw               Invalidate everything.
+ *
+ * Without a script, a sweep of pans, a zoom in and back out (which should be served from the
+ * tile cache), and a few edits is replayed.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cairomm/context.h>
+#include <2geom/transforms.h>
+
+#include "async/scheduler.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-item.h"
+#include "display/surface-pool.h"
+#include "document.h"
+#include "helper/geom.h"
+#include "inkscape.h"
+#include "object/sp-root.h"
+#include "object/sp-shape.h"
+#include "ui/util.h"
+#include "ui/widget/canvas/fragment.h"
+#include "ui/widget/canvas/graphics.h"
+#include "ui/widget/canvas/prefs.h"
+#include "ui/widget/canvas/stores.h"
+#include "ui/widget/canvas/updaters.h"
+
+using namespace Inkscape;
+using namespace Inkscape::UI::Widget;
+
+namespace {
+
+constexpr char const *DEFAULT_SCRIPT = R"(
+pan 1500 0 30
+pan 0 1500 30
+pan -1500 -1500 30
+zoom 4 10
+zoom 0.25 10
+edit 20
+redraw
+)";
+
+struct Command
+{
+    std::string name;
+    double x = 0;
+    double y = 0;
+    int steps = 1;
+};
+
+std::vector<Command> parse_script(std::istream &in)
+{
+    std::vector<Command> result;
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream ss(line);
+        Command cmd;
+        if (!(ss >> cmd.name) || cmd.name[0] == '#') {
+            continue;
+        }
+        bool ok = true;
+        if (cmd.name == "pan") {
+            ok = (bool)(ss >> cmd.x >> cmd.y);
+            ss >> cmd.steps;
+        } else if (cmd.name == "zoom") {
+            ok = (bool)(ss >> cmd.x);
+            ss >> cmd.steps;
+        } else if (cmd.name == "edit") {
+            ss >> cmd.steps;
+        } else if (cmd.name != "redraw") {
+            ok = false;
+        }
+        if (!ok || cmd.steps < 1) {
+            std::cerr << "Script line " << lineno << ": cannot parse '" << line << "'" << std::endl;
+            std::exit(1);
+        }
+        result.push_back(cmd);
+    }
+    return result;
+}
+
+struct Results
+{
+    std::vector<double> latencies; // milliseconds
+    long tiles = 0;
+    double tile_pixels = 0;
+    double restored_pixels = 0; // From the tile cache.
+    double dirty_pixels = 0;    // Not restored, so needing rendering after a store recreation.
+};
+
+double region_area(Cairo::RefPtr<Cairo::Region> const &region)
+{
+    double area = 0;
+    for (int i = 0; i < region->get_num_rectangles(); i++) {
+        auto const r = region->get_rectangle(i);
+        area += (double)r.width * r.height;
+    }
+    return area;
+}
+
+double percentile(std::vector<double> sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto const rank = std::clamp<std::size_t>(std::ceil(p / 100 * sorted.size()), 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+/**
+ * Replicates what the canvas does on each frame: update the stores for the view, render every
+ * unclean tile of the visible area on the render threads, and commit the tiles to the stores.
+ */
+class Bench
+{
+public:
+    Bench(SPDocument *doc, Geom::IntPoint const &size)
+        : _doc(doc)
+        , _stores(_prefs)
+        , _size(size)
+    {
+        _graphics = Graphics::create_cairo(_prefs, _stores, _pi);
+        _stores.set_graphics(_graphics.get());
+        _graphics->set_scale_factor(1);
+        _graphics->set_colours(0xffffffff, 0xffffffff, 0x000000ff);
+        _graphics->set_background_in_stores(true);
+
+        _updater = Updater::create(Updater::Strategy::Responsive);
+        _updater->reset();
+        _invalidated = Cairo::Region::create();
+
+        _dkey = SPItem::display_key_new(1);
+        _drawing.setRoot(doc->getRoot()->invoke_show(_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+
+        // Start with the whole document in view.
+        auto const bounds = doc->getRoot()->documentVisualBounds().value_or(Geom::Rect(0, 0, 100, 100));
+        double const scale = std::min(size.x() / bounds.width(), size.y() / bounds.height());
+        _affine = Geom::Scale(scale);
+        _pos = (bounds.midpoint() * _affine - Geom::Point(size) / 2).round();
+        _drawing.update(Geom::IntRect::infinite(), _affine);
+
+        collect_shapes(doc->getRoot());
+    }
+
+    ~Bench()
+    {
+        _doc->getRoot()->invoke_hide(_dkey);
+    }
+
+    void run(std::vector<Command> const &script)
+    {
+        frame(); // Initial render, not counted.
+        _results = {};
+
+        for (auto const &cmd : script) {
+            for (int i = 0; i < cmd.steps; i++) {
+                if (cmd.name == "pan") {
+                    auto const from = Geom::Point(cmd.x, cmd.y) * i / cmd.steps;
+                    auto const to = Geom::Point(cmd.x, cmd.y) * (i + 1) / cmd.steps;
+                    _pos += to.round() - from.round();
+                } else if (cmd.name == "zoom") {
+                    zoom(std::pow(cmd.x, 1.0 / cmd.steps));
+                } else if (cmd.name == "edit") {
+                    edit();
+                } else if (cmd.name == "redraw") {
+                    _invalidated->do_union(geom_to_cairo(_stores.store().rect));
+                    _stores.clear_cache();
+                }
+                frame();
+            }
+        }
+    }
+
+    Results const &results() const { return _results; }
+
+private:
+    SPDocument *_doc;
+    Prefs _prefs;
+    PageInfo _pi;
+    Stores _stores;
+    std::unique_ptr<Graphics> _graphics;
+    std::unique_ptr<Updater> _updater;
+    Cairo::RefPtr<Cairo::Region> _invalidated;
+
+    Drawing _drawing;
+    unsigned _dkey;
+    std::vector<SPShape *> _shapes;
+    unsigned _next_shape = 0;
+
+    Geom::IntPoint _size;
+    Geom::IntPoint _pos;
+    Geom::Affine _affine;
+
+    Results _results;
+
+    void collect_shapes(SPObject *obj)
+    {
+        if (auto shape = cast<SPShape>(obj)) {
+            _shapes.push_back(shape);
+        }
+        for (auto &child : obj->children) {
+            collect_shapes(&child);
+        }
+    }
+
+    Fragment view() const { return { _affine, Geom::IntRect::from_xywh(_pos, _size) }; }
+
+    void zoom(double factor)
+    {
+        // Keep the document point at the centre of the view fixed.
+        auto const centre = Geom::Point(_pos) + Geom::Point(_size) / 2;
+        _affine *= Geom::Scale(factor);
+        _pos = (centre * factor - Geom::Point(_size) / 2).round();
+        _drawing.update(Geom::IntRect::infinite(), _affine);
+    }
+
+    void edit()
+    {
+        if (_shapes.empty()) {
+            return;
+        }
+        auto shape = _shapes[_next_shape++ % _shapes.size()];
+        auto const before = shape->documentVisualBounds();
+        shape->move_rel(Geom::Translate(1 / _affine.descrim(), 0));
+        _doc->ensureUpToDate();
+        auto const after = shape->documentVisualBounds();
+        _drawing.update(Geom::IntRect::infinite(), _affine);
+
+        for (auto const &bounds : { before, after }) {
+            if (bounds) {
+                auto const rect = (*bounds * _affine).roundOutwards();
+                _invalidated->do_union(geom_to_cairo(rect));
+                _stores.invalidate(rect);
+            }
+        }
+    }
+
+    void handle_stores_action(Stores::Action action)
+    {
+        switch (action) {
+            case Stores::Action::Recreated: {
+                auto const &store = _stores.store();
+                _invalidated->do_union(geom_to_cairo(store.rect));
+                _updater->reset();
+                for (int i = 0; i < store.drawn->get_num_rectangles(); i++) {
+                    _updater->mark_clean(cairo_to_geom(store.drawn->get_rectangle(i)));
+                }
+                _invalidated->subtract(store.drawn);
+                _results.restored_pixels += region_area(store.drawn);
+                _results.dirty_pixels += region_area(_invalidated);
+                break;
+            }
+            case Stores::Action::Shifted:
+                _invalidated->intersect(geom_to_cairo(_stores.store().rect));
+                _updater->intersect(_stores.store().rect);
+                break;
+            default:
+                break;
+        }
+        if (action != Stores::Action::None) {
+            _drawing.setCacheLimit(_stores.store().rect);
+        }
+    }
+
+    void frame()
+    {
+        auto const start = std::chrono::steady_clock::now();
+
+        handle_stores_action(_stores.update(view()));
+
+        _updater->mark_dirty(_invalidated);
+        _invalidated = Cairo::Region::create();
+        _updater->next_frame();
+
+        // Split the unclean visible area into tiles.
+        auto const visible = view().rect & _stores.store().rect;
+        std::vector<Geom::IntRect> rects;
+        if (visible) {
+            auto region = Cairo::Region::create(geom_to_cairo(*visible));
+            region->subtract(_updater->clean_region);
+            int const tile_size = _prefs.tile_size;
+            for (int i = 0; i < region->get_num_rectangles(); i++) {
+                auto const r = cairo_to_geom(region->get_rectangle(i));
+                for (int y = r.top(); y < r.bottom(); y += tile_size) {
+                    for (int x = r.left(); x < r.right(); x += tile_size) {
+                        rects.emplace_back(x, y, std::min(x + tile_size, r.right()), std::min(y + tile_size, r.bottom()));
+                    }
+                }
+            }
+        }
+
+        // Render them on the render threads.
+        std::vector<Cairo::RefPtr<Cairo::ImageSurface>> surfaces(rects.size());
+        for (std::size_t i = 0; i < rects.size(); i++) {
+            surfaces[i] = _graphics->request_tile_surface(rects[i], true);
+        }
+        _stores.begin_redraw();
+        _drawing.snapshot();
+        auto const store_affine = _stores.store().affine;
+        Async::Scheduler::get().parallel_for(0, (int)rects.size(), [&] (int i) {
+            auto cr = Cairo::Context::create(surfaces[i]);
+            Graphics::paint_background(Fragment{ store_affine, rects[i] }, _pi, 0xffffffff, 0xffffffff, cr);
+            auto dc = DrawingContext(cr->cobj(), rects[i].min());
+            _drawing.render(dc, rects[i]);
+        });
+        _drawing.unsnapshot();
+
+        // Commit them to the store.
+        for (std::size_t i = 0; i < rects.size(); i++) {
+            auto const fragment = Fragment{ store_affine, rects[i] };
+            _stores.cache_tile(fragment, surfaces[i]);
+            _graphics->draw_tile(fragment, std::move(surfaces[i]), {});
+            _stores.mark_drawn(rects[i]);
+            _updater->mark_clean(rects[i]);
+            _results.tile_pixels += (double)rects[i].width() * rects[i].height();
+        }
+        _results.tiles += rects.size();
+
+        handle_stores_action(_stores.finished_draw(view()));
+
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        _results.latencies.push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+    }
+};
+
+std::string json_string(std::string const &s)
+{
+    std::string result = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+void print_results(std::ostream &out, std::string const &file, Results const &r, SurfacePool::Stats const &pool)
+{
+    auto sorted = r.latencies;
+    std::sort(sorted.begin(), sorted.end());
+    double const cacheable = r.restored_pixels + r.dirty_pixels;
+
+    out << "    {\n"
+        << "      \"file\": " << json_string(file) << ",\n"
+        << "      \"frames\": " << sorted.size() << ",\n"
+        << "      \"latency_ms\": { "
+        << "\"p50\": " << percentile(sorted, 50) << ", "
+        << "\"p90\": " << percentile(sorted, 90) << ", "
+        << "\"p99\": " << percentile(sorted, 99) << ", "
+        << "\"max\": " << (sorted.empty() ? 0 : sorted.back()) << " },\n"
+        << "      \"tiles\": " << r.tiles << ",\n"
+        << "      \"tile_megapixels\": " << r.tile_pixels / 1e6 << ",\n"
+        << "      \"tile_cache_hit_rate\": " << (cacheable > 0 ? r.restored_pixels / cacheable : 0) << ",\n"
+        << "      \"surface_pool\": { "
+        << "\"hits\": " << pool.hits << ", "
+        << "\"misses\": " << pool.misses << ", "
+        << "\"discards\": " << pool.discards << " }\n"
+        << "    }";
+}
+
+int usage()
+{
+    std::cerr << "Usage: canvas-benchmark [--script FILE] [--size WxH] [--repeat N] FILE.svg..." << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string script_file;
+    Geom::IntPoint size(1920, 1080);
+    int repeat = 1;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "--script" && i + 1 < argc) {
+            script_file = argv[++i];
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &size.x(), &size.y()) != 2 || size.x() <= 0 || size.y() <= 0) {
+                return usage();
+            }
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] == '-') {
+            return usage();
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        return usage();
+    }
+
+    std::vector<Command> script;
+    if (script_file.empty()) {
+        std::istringstream in(DEFAULT_SCRIPT);
+        script = parse_script(in);
+    } else {
+        std::ifstream in(script_file);
+        if (!in) {
+            std::cerr << "Cannot open script " << script_file << std::endl;
+            return 1;
+        }
+        script = parse_script(in);
+    }
+
+    Application::create(false);
+    Async::Scheduler::get();
+
+    std::cout << "{\n  \"results\": [\n";
+    bool first = true;
+    for (auto const &file : files) {
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDoc(file.c_str(), false));
+        if (!doc) {
+            std::cerr << "Cannot open " << file << std::endl;
+            return 1;
+        }
+        doc->ensureUpToDate();
+
+        for (int i = 0; i < repeat; i++) {
+            SurfacePool::get().reset_stats();
+            auto bench = Bench(doc.get(), size);
+            bench.run(script);
+
+            std::cout << (first ? "" : ",\n");
+            print_results(std::cout, file, bench.results(), SurfacePool::get().stats());
+            first = false;
+        }
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
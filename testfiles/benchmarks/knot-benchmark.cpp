@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of the crossing detection of the Knot path effect.
+ *
+ * Builds scribbles resembling long hand-drawn paths, made of the given numbers of cubic segments,
+ * and times the construction of LPEKnotNS::CrossingPoints on them. Reports the best time of a few
+ * runs and the number of crossings found as JSON on standard output.
+ *
+ * Usage: knot-benchmark [--repeat N] [--verify] [SEGMENTS...]
+ *
+ * With --verify, the crossings are also computed by testing every pair of segments, and the
+ * results compared. This is slow for large paths.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <2geom/basic-intersection.h>
+#include <2geom/path.h>
+#include <2geom/pathvector.h>
+
+#include "live_effects/lpe-knot.h"
+
+using namespace Inkscape::LivePathEffect;
+
+namespace {
+
+/// A smooth random walk confined to a square, so that it crosses itself often.
+Geom::PathVector scribble(int segments, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> turn(-0.6, 0.6);
+    std::uniform_real_distribution<double> step(5, 20);
+
+    double const size = 10 * std::sqrt(segments) + 100;
+    Geom::Point p(size / 2, size / 2);
+    double angle = 0;
+
+    Geom::Path path(p);
+    for (int i = 0; i < segments; i++) {
+        angle += turn(gen);
+        auto q = p + Geom::Point::polar(angle, step(gen));
+        if (q.x() < 0 || q.y() < 0 || q.x() > size || q.y() > size) {
+            // Turn back towards the middle.
+            angle = std::atan2(size / 2 - p.y(), size / 2 - p.x());
+            q = p + Geom::Point::polar(angle, step(gen));
+        }
+        auto const d = (q - p) / 3;
+        path.appendNew<Geom::CubicBezier>(p + d + Geom::rot90(d) * turn(gen), q - d + Geom::rot90(d) * turn(gen), q);
+        p = q;
+    }
+    return Geom::PathVector(path);
+}
+
+/// Count the crossings by testing every pair of segments, as the effect used to.
+std::size_t count_exhaustive(Geom::PathVector const &paths)
+{
+    std::size_t count = 0;
+    for (unsigned i = 0; i < paths.size(); i++) {
+        for (unsigned ii = 0; ii < paths[i].size_default(); ii++) {
+            for (unsigned j = i; j < paths.size(); j++) {
+                for (unsigned jj = i == j ? ii : 0; jj < paths[j].size_default(); jj++) {
+                    std::vector<std::pair<double, double>> times;
+                    if (i == j && ii == jj) {
+                        Geom::find_self_intersections(times, paths[i][ii].toSBasis());
+                    } else {
+                        Geom::find_intersections(times, paths[i][ii].toSBasis(), paths[j][jj].toSBasis());
+                    }
+                    for (auto const &[ti, tj] : times) {
+                        if (std::isnan(ti) || std::isnan(tj)) {
+                            continue;
+                        }
+                        if (i == j && std::abs(ti + ii - tj - jj) <= 1e-4) {
+                            continue; // End of one segment is the start of the next.
+                        }
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int usage()
+{
+    std::cerr << "Usage: knot-benchmark [--repeat N] [--verify] [SEGMENTS...]" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int repeat = 3;
+    bool verify = false;
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (!arg.empty() && arg[0] != '-' && std::atoi(arg.c_str()) > 0) {
+            sizes.push_back(std::atoi(arg.c_str()));
+        } else {
+            return usage();
+        }
+    }
+    if (sizes.empty()) {
+        sizes = { 500, 1000, 2000, 4000 };
+    }
+
+    std::cout << "{\n  \"results\": [\n";
+    for (std::size_t n = 0; n < sizes.size(); n++) {
+        auto const paths = scribble(sizes[n], n + 1);
+
+        double best = INFINITY;
+        std::size_t crossings = 0;
+        for (int r = 0; r < repeat; r++) {
+            auto const start = std::chrono::steady_clock::now();
+            auto const points = LPEKnotNS::CrossingPoints(paths);
+            auto const end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+            crossings = points.size();
+        }
+
+        std::cout << (n ? ",\n" : "") << "    {\n"
+                  << "      \"segments\": " << sizes[n] << ",\n"
+                  << "      \"crossings\": " << crossings << ",\n";
+        if (verify) {
+            auto const expected = count_exhaustive(paths);
+            std::cout << "      \"crossings_exhaustive\": " << expected << ",\n";
+            if (expected != crossings) {
+                std::cerr << "Mismatch for " << sizes[n] << " segments: " << crossings << " crossings, expected "
+                          << expected << std::endl;
+            }
+        }
+        std::cout << "      \"best_ms\": " << best << "\n    }";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of the livarot sweep, which lies under booleans, offsets, stroke to path and flowed
+ * text.
+ *
+ * For each input, times turning every path into an uncrossed polygon with Shape::ConvertToShape,
+ * and the union of all paths, both folded one by one with Shape::Booleen as the union used to be
+ * and merged with sp_shape_boolop_nary. Reports the best time of a few runs as JSON on standard
+ * output.
+ *
+ * Usage: livarot-benchmark [--repeat N] [--circles N]... [FILE.svg...]
+ *
+ * The paths of an SVG file are those of all its shapes, in document coordinates; the boolean
+ * test cases under testfiles/ make good inputs. --circles adds a synthetic input of N
+ * overlapping circles. Without any input, a few sizes of synthetic inputs are used.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <2geom/circle.h>
+#include <2geom/path.h>
+#include <2geom/pathvector.h>
+
+#include "async/scheduler.h"
+#include "display/curve.h"
+#include "document.h"
+#include "helper/geom.h"
+#include "inkscape.h"
+#include "livarot/Path.h"
+#include "livarot/Shape.h"
+#include "object/sp-root.h"
+#include "object/sp-shape.h"
+#include "path/path-boolop.h"
+#include "path/path-util.h"
+
+using namespace Inkscape;
+
+namespace {
+
+struct Input
+{
+    std::string name;
+    std::vector<Geom::PathVector> paths;
+};
+
+Input circles(int count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    double const size = 30 * std::sqrt(count);
+    std::uniform_real_distribution<double> pos(0, size);
+    std::uniform_real_distribution<double> radius(10, 40);
+
+    Input input{"circles-" + std::to_string(count), {}};
+    for (int i = 0; i < count; i++) {
+        input.paths.emplace_back(Geom::Path(Geom::Circle(pos(gen), pos(gen), radius(gen))));
+    }
+    return input;
+}
+
+void collect_paths(SPObject *object, std::vector<Geom::PathVector> &paths)
+{
+    if (auto shape = cast<SPShape>(object)) {
+        if (shape->curve() && !shape->curve()->is_empty()) {
+            paths.push_back(shape->curve()->get_pathvector() * shape->i2doc_affine());
+        }
+    }
+    for (auto &child : object->children) {
+        collect_paths(&child, paths);
+    }
+}
+
+/// Livarot paths of the input, converted to polylines with back data as the boolean operations do.
+std::vector<Path *> make_livarot_paths(Input const &input)
+{
+    std::vector<Path *> result;
+    for (auto const &pathv : input.paths) {
+        auto path = Path_for_pathvector(pathv_to_linear_and_cubic_beziers(pathv));
+        path->ConvertWithBackData(0.1);
+        result.push_back(path);
+    }
+    return result;
+}
+
+template <typename F>
+double best_ms(int repeat, F &&f)
+{
+    double best = INFINITY;
+    for (int r = 0; r < repeat; r++) {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+void run(Input const &input, int repeat, bool first)
+{
+    auto const paths = make_livarot_paths(input);
+    int const n = paths.size();
+    std::size_t edges = 0;
+
+    double const convert = best_ms(repeat, [&] {
+        edges = 0;
+        for (int i = 0; i < n; i++) {
+            Shape polygon, shape;
+            paths[i]->Fill(&polygon, i);
+            shape.ConvertToShape(&polygon, fill_nonZero);
+            edges += shape.numberOfEdges();
+        }
+    });
+
+    int folded_edges = 0;
+    double const fold = best_ms(repeat, [&] {
+        auto acc = std::make_unique<Shape>();
+        {
+            Shape polygon;
+            paths[0]->Fill(&polygon, 0);
+            acc->ConvertToShape(&polygon, fill_nonZero);
+        }
+        for (int i = 1; i < n; i++) {
+            Shape polygon;
+            auto shape = std::make_unique<Shape>();
+            paths[i]->Fill(&polygon, i);
+            shape->ConvertToShape(&polygon, fill_nonZero);
+            if (shape->numberOfEdges() == 0) {
+                continue;
+            }
+            if (acc->numberOfEdges() == 0) {
+                acc = std::move(shape);
+                continue;
+            }
+            auto result = std::make_unique<Shape>();
+            result->Booleen(shape.get(), acc.get(), bool_op_union);
+            acc = std::move(result);
+        }
+        folded_edges = acc->numberOfEdges();
+    });
+
+    int nary_edges = 0;
+    double const nary = best_ms(repeat, [&] {
+        std::unique_ptr<Shape> shape(sp_shape_boolop_nary(paths, std::vector<FillRule>(n, fill_nonZero), bool_op_union));
+        nary_edges = shape->numberOfEdges();
+    });
+
+    for (auto path : paths) {
+        delete path;
+    }
+
+    std::cout << (first ? "" : ",\n") << "    {\n"
+              << "      \"input\": \"" << input.name << "\",\n"
+              << "      \"paths\": " << n << ",\n"
+              << "      \"edges\": " << edges << ",\n"
+              << "      \"convert_ms\": " << convert << ",\n"
+              << "      \"union_fold_ms\": " << fold << ",\n"
+              << "      \"union_fold_edges\": " << folded_edges << ",\n"
+              << "      \"union_nary_ms\": " << nary << ",\n"
+              << "      \"union_nary_edges\": " << nary_edges << "\n    }";
+}
+
+int usage()
+{
+    std::cerr << "Usage: livarot-benchmark [--repeat N] [--circles N]... [FILE.svg...]" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int repeat = 3;
+    std::vector<int> sizes;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--circles" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            sizes.push_back(std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] == '-') {
+            return usage();
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (sizes.empty() && files.empty()) {
+        sizes = { 100, 400, 1600 };
+    }
+
+    Async::Scheduler::get();
+
+    std::cout << "{\n  \"results\": [\n";
+    bool first = true;
+    for (std::size_t i = 0; i < sizes.size(); i++) {
+        run(circles(sizes[i], i + 1), repeat, first);
+        first = false;
+    }
+
+    if (!files.empty()) {
+        Application::create(false);
+    }
+    for (auto const &file : files) {
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDoc(file.c_str(), false));
+        if (!doc) {
+            std::cerr << "Cannot open " << file << std::endl;
+            return 1;
+        }
+        doc->ensureUpToDate();
+
+        Input input{file, {}};
+        collect_paths(doc->getRoot(), input.paths);
+        if (input.paths.empty()) {
+            std::cerr << "No paths in " << file << std::endl;
+            continue;
+        }
+        run(input, repeat, first);
+        first = false;
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmark of the feMorphology renderer.
+ *
+ * Dilates and erodes random images of the given sizes, once along each axis as FilterMorphology
+ * does, with the reference deque implementation and with the van Herk/Gil-Werman passes, at
+ * several radii. Reports the best time of a few runs for each as JSON on standard output, and
+ * whether both implementations agree.
+ *
+ * Usage: morphology-benchmark [--repeat N] [--a8] [--radius R]... [SIZE...]
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "display/nr-filter-morphology.h"
+
+using namespace Inkscape::Filters;
+
+namespace {
+
+cairo_surface_t *random_surface(cairo_format_t format, int size, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    auto s = cairo_image_surface_create(format, size, size);
+    cairo_surface_flush(s);
+    auto data = cairo_image_surface_get_data(s);
+    int const stride = cairo_image_surface_get_stride(s);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < stride; ++x) {
+            data[y * stride + x] = dist(gen);
+        }
+    }
+    cairo_surface_mark_dirty(s);
+    return s;
+}
+
+bool same_pixels(cairo_surface_t *a, cairo_surface_t *b)
+{
+    int const h = cairo_image_surface_get_height(a);
+    int const stride = cairo_image_surface_get_stride(a);
+    return std::memcmp(cairo_image_surface_get_data(a), cairo_image_surface_get_data(b), h * stride) == 0;
+}
+
+int usage()
+{
+    std::cerr << "Usage: morphology-benchmark [--repeat N] [--a8] [--radius R]... [SIZE...]" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int repeat = 3;
+    auto format = CAIRO_FORMAT_ARGB32;
+    std::vector<double> radii;
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--a8") {
+            format = CAIRO_FORMAT_A8;
+        } else if (arg == "--radius" && i + 1 < argc && std::atof(argv[i + 1]) > 0) {
+            radii.push_back(std::atof(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-' && std::atoi(arg.c_str()) > 0) {
+            sizes.push_back(std::atoi(arg.c_str()));
+        } else {
+            return usage();
+        }
+    }
+    if (radii.empty()) {
+        radii = { 1, 2, 4, 8, 16, 32, 64 };
+    }
+    if (sizes.empty()) {
+        sizes = { 512, 1024, 2048 };
+    }
+
+    bool all_same = true;
+    bool first = true;
+    std::cout << "{\n  \"results\": [\n";
+    for (std::size_t n = 0; n < sizes.size(); n++) {
+        int const size = sizes[n];
+        auto const input = random_surface(format, size, n + 1);
+        auto const interm = cairo_image_surface_create(format, size, size);
+        auto const deque_out = cairo_image_surface_create(format, size, size);
+        auto const vanherk_out = cairo_image_surface_create(format, size, size);
+
+        for (auto op : { MORPHOLOGY_OPERATOR_DILATE, MORPHOLOGY_OPERATOR_ERODE }) {
+            for (double radius : radii) {
+                auto const time = [&] (MorphologyAlgorithm algorithm, cairo_surface_t *out) {
+                    double best = INFINITY;
+                    for (int r = 0; r < repeat; r++) {
+                        auto const start = std::chrono::steady_clock::now();
+                        morphology_pass(input, interm, radius, Geom::X, op, algorithm);
+                        morphology_pass(interm, out, radius, Geom::Y, op, algorithm);
+                        auto const end = std::chrono::steady_clock::now();
+                        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+                    }
+                    return best;
+                };
+                double const deque = time(MorphologyAlgorithm::DEQUE, deque_out);
+                double const vanherk = time(MorphologyAlgorithm::VAN_HERK, vanherk_out);
+                bool const same = same_pixels(deque_out, vanherk_out);
+                all_same &= same;
+
+                std::cout << (first ? "" : ",\n") << "    {\n"
+                          << "      \"size\": " << size << ",\n"
+                          << "      \"operator\": \"" << (op == MORPHOLOGY_OPERATOR_DILATE ? "dilate" : "erode") << "\",\n"
+                          << "      \"radius\": " << radius << ",\n"
+                          << "      \"deque_ms\": " << deque << ",\n"
+                          << "      \"van_herk_ms\": " << vanherk << ",\n"
+                          << "      \"same_pixels\": " << (same ? "true" : "false") << "\n    }";
+                first = false;
+            }
+        }
+
+        cairo_surface_destroy(vanherk_out);
+        cairo_surface_destroy(deque_out);
+        cairo_surface_destroy(interm);
+        cairo_surface_destroy(input);
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    if (!all_same) {
+        std::cerr << "The van Herk passes do not match the deque implementation" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
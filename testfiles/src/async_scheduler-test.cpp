@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "async/scheduler.h"
+using namespace Inkscape::Async;
+
+TEST(SchedulerTest, ParallelForVisitsEachIndexOnce)
+{
+    Scheduler scheduler(4);
+
+    std::vector<std::atomic<int>> visits(10000);
+    scheduler.parallel_for(0, visits.size(), [&] (int i) {
+        visits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    for (auto &v : visits) {
+        EXPECT_EQ(v.load(), 1);
+    }
+}
+
+TEST(SchedulerTest, SlotsAreExclusive)
+{
+    Scheduler scheduler(3);
+
+    int const slots = scheduler.concurrency(3);
+    std::vector<std::atomic<int>> busy(slots);
+    std::atomic<bool> overlap = false;
+
+    scheduler.parallel_for_slots(0, 1000, [&] (int, int slot) {
+        ASSERT_LT(slot, slots);
+        if (busy[slot].fetch_add(1) != 0) overlap = true;
+        std::this_thread::yield();
+        busy[slot].fetch_sub(1);
+    }, 3);
+
+    EXPECT_FALSE(overlap);
+}
+
+TEST(SchedulerTest, NestedParallelForCompletes)
+{
+    Scheduler scheduler(2);
+
+    std::atomic<int> sum = 0;
+    scheduler.parallel_for(0, 16, [&] (int) {
+        scheduler.parallel_for(0, 16, [&] (int j) {
+            sum.fetch_add(j, std::memory_order_relaxed);
+        });
+    });
+
+    EXPECT_EQ(sum.load(), 16 * (15 * 16 / 2));
+}
+
+TEST(SchedulerTest, HigherPriorityRunsFirst)
+{
+    Scheduler scheduler(1);
+
+    // Block the only worker so that all later tasks queue up.
+    std::mutex gate;
+    gate.lock();
+    scheduler.post([&] { auto lock = std::lock_guard(gate); }, Priority::Interactive);
+
+    std::mutex order_mutex;
+    std::vector<Priority> order;
+    std::atomic<int> done = 0;
+    auto record = [&] (Priority p) {
+        return [&, p] {
+            EXPECT_EQ(Scheduler::current_priority(), p);
+            auto lock = std::lock_guard(order_mutex);
+            order.push_back(p);
+            done++;
+        };
+    };
+
+    scheduler.post(record(Priority::Background), Priority::Background);
+    scheduler.post(record(Priority::Export), Priority::Export);
+    scheduler.post(record(Priority::Interactive), Priority::Interactive);
+
+    gate.unlock();
+    while (done.load() < 3) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(order, (std::vector{Priority::Interactive, Priority::Export, Priority::Background}));
+}
+
+TEST(SchedulerTest, PriorityScopeIsInherited)
+{
+    Scheduler scheduler(2);
+
+    std::atomic<int> wrong = 0;
+    {
+        auto scope = Scheduler::PriorityScope(Priority::Export);
+        scheduler.parallel_for(0, 100, [&] (int) {
+            if (Scheduler::current_priority() != Priority::Export) wrong++;
+        });
+    }
+
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_EQ(Scheduler::current_priority(), Priority::Interactive);
+}
+
+TEST(SchedulerTest, ParallelForRethrowsOnCaller)
+{
+    Scheduler scheduler(3);
+
+    std::atomic<int> visited = 0;
+    auto run = [&] {
+        scheduler.parallel_for(0, 1000, [&] (int i) {
+            visited.fetch_add(1, std::memory_order_relaxed);
+            if (i == 100 || i == 700) {
+                throw std::runtime_error("body failed");
+            }
+        });
+    };
+    EXPECT_THROW(run(), std::runtime_error);
+    EXPECT_GT(visited.load(), 0);
+    EXPECT_LE(visited.load(), 1000);
+
+    // The pool is still usable, and the helpers of the failed loop did not outlive its body.
+    std::atomic<int> sum = 0;
+    scheduler.parallel_for(0, 100, [&] (int i) { sum.fetch_add(i, std::memory_order_relaxed); });
+    EXPECT_EQ(sum.load(), 99 * 100 / 2);
+}
+
+TEST(SchedulerTest, NestedParallelForRethrows)
+{
+    Scheduler scheduler(2);
+
+    EXPECT_THROW(scheduler.parallel_for(0, 8, [&] (int) {
+        scheduler.parallel_for(0, 8, [&] (int j) {
+            if (j == 5) {
+                throw std::logic_error("inner body failed");
+            }
+        });
+    }), std::logic_error);
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the area marked for redrawing when an item inside a filtered group changes.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <2geom/path.h>
+
+#include "display/curve.h"
+#include "display/drawing.h"
+#include "display/drawing-group.h"
+#include "display/drawing-shape.h"
+#include "display/nr-filter.h"
+#include "display/nr-filter-offset.h"
+
+using namespace Inkscape;
+
+namespace {
+
+std::shared_ptr<SPCurve const> make_rect(Geom::Rect const &rect)
+{
+    return std::make_shared<SPCurve const>(Geom::PathVector(Geom::Path(rect)));
+}
+
+Geom::OptIntRect union_of(std::vector<Geom::IntRect> const &rects)
+{
+    Geom::OptIntRect result;
+    for (auto const &rect : rects) {
+        result.unionWith(rect);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(DrawingItemDamageTest, FilteredGroupMarksOnlyDamageThroughFilter)
+{
+    Drawing drawing;
+    auto root = new DrawingGroup(drawing);
+    drawing.setRoot(root);
+
+    // A group shifting its content 5px to the right, around a large shape and a small one.
+    auto group = new DrawingGroup(drawing);
+    root->appendChild(group);
+    group->setItemBounds(Geom::Rect(0, 0, 200, 200));
+    auto filter = std::make_unique<Filters::Filter>(1);
+    auto offset = std::make_unique<Filters::FilterOffset>();
+    offset->set_dx(5);
+    offset->set_dy(0);
+    filter->add_primitive(std::move(offset));
+    group->setFilterRenderer(std::move(filter));
+
+    auto frame = new DrawingShape(drawing);
+    frame->setPath(make_rect(Geom::Rect(0, 0, 200, 200)));
+    group->appendChild(frame);
+    auto moving = new DrawingShape(drawing);
+    moving->setPath(make_rect(Geom::Rect(50, 50, 60, 60)));
+    group->appendChild(moving);
+
+    drawing.update();
+    ASSERT_TRUE(group->drawbox());
+    auto const group_drawbox = *group->drawbox();
+
+    std::vector<Geom::IntRect> marked;
+    auto connection = drawing.signal_redraw_area.connect([&] (Geom::IntRect const &area) { marked.push_back(area); });
+
+    // Move the small shape within the group, so that the group's bounds stay the same.
+    moving->setPath(make_rect(Geom::Rect(70, 50, 80, 60)));
+    drawing.update();
+    connection.disconnect();
+
+    ASSERT_FALSE(marked.empty());
+    for (auto const &area : marked) {
+        EXPECT_NE(area, group_drawbox);
+    }
+    // The old and the new place of the shape, both shifted by the filter.
+    EXPECT_EQ(union_of(marked), Geom::OptIntRect(Geom::IntRect(55, 50, 85, 60)));
+    EXPECT_EQ(group->drawbox(), Geom::OptIntRect(group_drawbox));
+}
+
+TEST(DrawingItemDamageTest, FilteredGroupMarksAllWhenItsBoundsChange)
+{
+    Drawing drawing;
+    auto root = new DrawingGroup(drawing);
+    drawing.setRoot(root);
+
+    auto group = new DrawingGroup(drawing);
+    root->appendChild(group);
+    group->setItemBounds(Geom::Rect(0, 0, 100, 100));
+    auto filter = std::make_unique<Filters::Filter>(1);
+    filter->add_primitive(std::make_unique<Filters::FilterOffset>());
+    group->setFilterRenderer(std::move(filter));
+
+    auto shape = new DrawingShape(drawing);
+    shape->setPath(make_rect(Geom::Rect(0, 0, 100, 100)));
+    group->appendChild(shape);
+    drawing.update();
+
+    std::vector<Geom::IntRect> marked;
+    auto connection = drawing.signal_redraw_area.connect([&] (Geom::IntRect const &area) { marked.push_back(area); });
+
+    // The filter region follows the bounds of the group, so its whole output may change.
+    group->setItemBounds(Geom::Rect(0, 0, 150, 100));
+    shape->setPath(make_rect(Geom::Rect(0, 0, 150, 100)));
+    drawing.update();
+    connection.disconnect();
+
+    ASSERT_TRUE(group->drawbox());
+    auto const marked_area = union_of(marked);
+    ASSERT_TRUE(marked_area);
+    EXPECT_TRUE(marked_area->contains(*group->drawbox()));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the sub-path ordering of the embroidery stitch LPE.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "live_effects/lpe-embrodery-stitch-ordering.h"
+
+using namespace Inkscape::LivePathEffect::LPEEmbroderyStitchOrdering;
+
+namespace {
+
+std::vector<OrderingInfo> random_lines(int n, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> pos(0, 1000);
+    std::uniform_real_distribution<double> offset(-20, 20);
+
+    std::vector<OrderingInfo> infos(n);
+    for (int i = 0; i < n; i++) {
+        auto &info = infos[i];
+        info.index = i;
+        info.reverse = false;
+        info.used = false;
+        info.connect = true;
+        info.begOrig = Geom::Point(pos(gen), pos(gen));
+        info.endOrig = info.begOrig + Geom::Point(offset(gen), offset(gen));
+    }
+    return infos;
+}
+
+// Total length of the jumps between consecutive sub-paths
+double jump_length(std::vector<OrderingInfo> const &infos)
+{
+    double length = 0;
+    for (size_t i = 1; i < infos.size(); i++) {
+        length += Geom::distance(infos[i - 1].GetEndRev(), infos[i].GetBegRev());
+    }
+    return length;
+}
+
+void expect_permutation(std::vector<OrderingInfo> const &infos, std::size_t n)
+{
+    ASSERT_EQ(infos.size(), n);
+    std::vector<std::size_t> indices;
+    for (auto const &info : infos) {
+        indices.push_back(info.index);
+    }
+    std::sort(indices.begin(), indices.end());
+    for (std::size_t i = 0; i < n; i++) {
+        EXPECT_EQ(indices[i], i);
+    }
+}
+
+} // namespace
+
+TEST(EmbroideryOrderingTest, ClosestMatchesExhaustiveSearch)
+{
+    auto infos = random_lines(500, 1);
+
+    // Greedy nearest neighbor by looking at all remaining sub-paths
+    auto expected = infos;
+    {
+        std::vector<bool> used(expected.size());
+        std::vector<std::pair<int, bool>> order{{0, false}};
+        used[0] = true;
+        auto p = expected[0].endOrig;
+        for (size_t n = 1; n < expected.size(); n++) {
+            std::pair<int, bool> best;
+            double best_dist = INFINITY;
+            for (size_t i = 0; i < expected.size(); i++) {
+                if (used[i]) {
+                    continue;
+                }
+                for (bool rev : {false, true}) {
+                    double dist = Geom::distance(p, rev ? expected[i].endOrig : expected[i].begOrig);
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best = {i, rev};
+                    }
+                }
+            }
+            used[best.first] = true;
+            order.push_back(best);
+            p = best.second ? expected[best.first].begOrig : expected[best.first].endOrig;
+        }
+        for (size_t n = 0; n < order.size(); n++) {
+            expected[n] = infos[order[n].first];
+            expected[n].reverse = order[n].second;
+        }
+    }
+
+    OrderingClosest(infos, false);
+    ASSERT_EQ(infos.size(), expected.size());
+    for (size_t n = 0; n < infos.size(); n++) {
+        EXPECT_EQ(infos[n].index, expected[n].index);
+        EXPECT_EQ(infos[n].reverse, expected[n].reverse);
+    }
+}
+
+TEST(EmbroideryOrderingTest, AdvancedShortensJumps)
+{
+    for (int nDims : {2, 3}) {
+        // Small enough to try all combinations, and large enough to search near connections only
+        for (int n : {30, 2000}) {
+            auto infos = random_lines(n, n + nDims);
+            double const before = jump_length(infos);
+
+            OrderingAdvanced(infos, nDims);
+            expect_permutation(infos, n);
+            EXPECT_LT(jump_length(infos), before);
+        }
+    }
+}
+
+TEST(EmbroideryOrderingTest, AdvancedCanBeCancelled)
+{
+    auto infos = random_lines(2000, 3);
+
+    OrderingControl control;
+    int calls = 0;
+    control.progress = [&calls](double fraction) {
+        EXPECT_GE(fraction, 0.0);
+        EXPECT_LE(fraction, 1.0);
+        calls++;
+        return false;
+    };
+
+    OrderingAdvanced(infos, 5, control);
+    EXPECT_EQ(calls, 1);
+    expect_permutation(infos, 2000);
+}
+
+TEST(EmbroideryOrderingTest, AdvancedTrialLimitIsReproducible)
+{
+    auto const lines = random_lines(2000, 5);
+
+    OrderingControl control;
+    control.maxTrials = 500;
+    auto first = lines;
+    auto second = lines;
+    OrderingAdvanced(first, 3, control);
+    OrderingAdvanced(second, 3, control);
+    expect_permutation(first, 2000);
+    for (size_t n = 0; n < first.size(); n++) {
+        EXPECT_EQ(first[n].index, second[n].index);
+        EXPECT_EQ(first[n].reverse, second[n].reverse);
+    }
+
+    EXPECT_LT(jump_length(first), jump_length(lines));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
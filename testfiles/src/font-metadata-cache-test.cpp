@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the font metadata kept across sessions.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include "libnrtype/font-factory.h"
+#include "libnrtype/font-metadata-cache.h"
+
+using namespace Inkscape;
+using Inkscape::Text::FontMetadataCache;
+
+namespace {
+
+using Names = std::vector<std::pair<std::string, std::string>>;
+
+Names take_names(GList *styles)
+{
+    Names names;
+    for (auto l = styles; l; l = l->next) {
+        auto style = static_cast<StyleNames *>(l->data);
+        names.emplace_back(style->CssName.raw(), style->DisplayName.raw());
+        delete style;
+    }
+    g_list_free(styles);
+    return names;
+}
+
+/// Inserts styles the way FontFactory::GetUIStyles() lists them.
+void insert_names(FontMetadataCache &cache, std::string const &family, Names const &names)
+{
+    GList *styles = nullptr;
+    for (auto const &[css_name, display_name] : names) {
+        styles = g_list_append(styles, new StyleNames(css_name, display_name));
+    }
+    cache.insertStyles(family, styles);
+    for (auto l = styles; l; l = l->next) {
+        delete static_cast<StyleNames *>(l->data);
+    }
+    g_list_free(styles);
+}
+
+using Table = std::tuple<std::string, std::string, std::string, std::string>;
+
+std::map<std::string, Table> tables_of(std::map<Glib::ustring, OTSubstitution> const &tables)
+{
+    std::map<std::string, Table> result;
+    for (auto const &[name, table] : tables) {
+        result[name.raw()] = {table.before.raw(), table.input.raw(), table.after.raw(), table.output.raw()};
+    }
+    return result;
+}
+
+} // namespace
+
+class FontMetadataCacheTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        // Keep the cache file away from the user's. The user cache directory is only looked up once
+        // per process, so this holds for the shared cache too.
+        auto tmp = g_dir_make_tmp("font-metadata-cache-test-XXXXXX", nullptr);
+        ASSERT_TRUE(tmp);
+        dir = tmp;
+        g_free(tmp);
+        g_setenv("XDG_CACHE_HOME", dir.c_str(), true);
+    }
+
+    static void TearDownTestSuite()
+    {
+        // Written now rather than when the statics are destroyed, after the directory is gone.
+        FontMetadataCache::get().save();
+        g_unlink(shared_path().c_str());
+        g_rmdir(Glib::path_get_dirname(shared_path()).c_str());
+        g_rmdir(dir.c_str());
+    }
+
+    void SetUp() override
+    {
+        path = Glib::build_filename(dir, "test.cache");
+        font_file = Glib::build_filename(dir, "font.ttf");
+        Glib::file_set_contents(font_file, "not really a font");
+
+        tables["liga"].before = "";
+        tables["liga"].input = "fi fl";
+        tables["liga"].after = "";
+        tables["liga"].output = "ﬁﬂ";
+        tables["ss01"].before = "a";
+        tables["ss01"].input = "g";
+        tables["ss01"].after = "\t\n";
+        tables["ss01"].output = "g.alt";
+    }
+
+    void TearDown() override
+    {
+        g_unlink(path.c_str());
+        g_unlink(font_file.c_str());
+    }
+
+    static std::string shared_path() { return Glib::build_filename(dir, "inkscape", "font-metadata.cache"); }
+
+    /// Replace the stamp of the fonts the styles were listed from.
+    void set_stamp(std::string const &stamp)
+    {
+        auto contents = Glib::file_get_contents(path);
+        auto const start = contents.find("\nstamp\t");
+        ASSERT_NE(start, std::string::npos);
+        auto const end = contents.find('\n', start + 1);
+        contents.replace(start, end - start, "\nstamp\t" + stamp);
+        Glib::file_set_contents(path, contents);
+    }
+
+    static inline std::string dir;
+    std::string path;
+    std::string font_file;
+    std::map<Glib::ustring, OTSubstitution> tables;
+};
+
+TEST_F(FontMetadataCacheTest, SavedMetadataIsLoadedBack)
+{
+    Names const sans = {{"Normal", "Regular"}, {"Bold", "Bold"}, {"Italic", "Italic"}};
+    Names const serif = {{"Normal", "Book"}};
+    {
+        FontMetadataCache cache(path);
+        EXPECT_FALSE(cache.lookupStyles("Sans"));
+        EXPECT_FALSE(cache.lookupTables(font_file.c_str(), 0));
+
+        insert_names(cache, "Sans", sans);
+        insert_names(cache, "Serif", serif);
+        cache.insertTables(font_file.c_str(), 1, tables);
+        cache.save();
+    }
+    ASSERT_TRUE(Glib::file_test(path, Glib::FILE_TEST_EXISTS));
+
+    FontMetadataCache cache(path);
+    EXPECT_EQ(take_names(cache.lookupStyles("Sans")), sans);
+    EXPECT_EQ(take_names(cache.lookupStyles("Serif")), serif);
+    EXPECT_FALSE(cache.lookupStyles("Monospace"));
+
+    EXPECT_FALSE(cache.lookupTables(font_file.c_str(), 0));
+    auto const loaded = cache.lookupTables(font_file.c_str(), 1);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(tables_of(*loaded), tables_of(tables));
+}
+
+TEST_F(FontMetadataCacheTest, StylesAreDroppedWhenTheFontsChange)
+{
+    {
+        FontMetadataCache cache(path);
+        insert_names(cache, "Sans", {{"Normal", "Regular"}});
+        cache.insertTables(font_file.c_str(), 0, tables);
+    }
+    set_stamp("listed-from-other-fonts");
+
+    // The tables are checked against their own file, which did not change.
+    FontMetadataCache cache(path);
+    EXPECT_FALSE(cache.lookupStyles("Sans"));
+    auto const loaded = cache.lookupTables(font_file.c_str(), 0);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(tables_of(*loaded), tables_of(tables));
+}
+
+TEST_F(FontMetadataCacheTest, TablesAreDroppedWhenTheirFileChanges)
+{
+    {
+        FontMetadataCache cache(path);
+        insert_names(cache, "Sans", {{"Normal", "Regular"}});
+        cache.insertTables(font_file.c_str(), 0, tables);
+    }
+    Glib::file_set_contents(font_file, "not really a font, and a longer one");
+
+    // The styles are checked against the fonts known to fontconfig, which did not change.
+    FontMetadataCache cache(path);
+    EXPECT_EQ(take_names(cache.lookupStyles("Sans")), (Names{{"Normal", "Regular"}}));
+    EXPECT_FALSE(cache.lookupTables(font_file.c_str(), 0));
+}
+
+TEST_F(FontMetadataCacheTest, NamesAreEscaped)
+{
+    std::vector<std::string> const families = {
+        "Tab\tSeparated", "Two\nLines", "Back\\slash", "\"Quoted\" 'family'", "Noto Sans 日本語", "Ünïcödé", "",
+    };
+    Names const names = {
+        {"Normal", ""}, {"Bold\tWide", "Gras\nLarge"}, {"\\", "\\t"}, {"Italic", "Kursiv ÄÖÜ"}, {"\x01", "\x7f"},
+    };
+    {
+        FontMetadataCache cache(path);
+        for (auto const &family : families) {
+            insert_names(cache, family, names);
+        }
+    }
+
+    // One record per line, whatever the names hold.
+    auto const contents = Glib::file_get_contents(path);
+    std::size_t lines = 0;
+    for (auto c : contents) {
+        lines += c == '\n';
+    }
+    EXPECT_EQ(lines, 2 + families.size());
+
+    FontMetadataCache cache(path);
+    for (auto const &family : families) {
+        EXPECT_EQ(take_names(cache.lookupStyles(family)), names) << family;
+    }
+}
+
+TEST_F(FontMetadataCacheTest, StylesAreTheSameFromPangoAndFromCache)
+{
+    auto &factory = FontFactory::get();
+    auto &metadata = FontMetadataCache::get();
+
+    auto const families = factory.GetUIFamilies();
+    ASSERT_FALSE(families.empty());
+
+    std::map<std::string, Names> listed;
+    for (auto const &[name, family] : families) {
+        listed[name] = take_names(factory.GetUIStyles(family));
+        EXPECT_EQ(take_names(metadata.lookupStyles(name)), listed[name]) << name;
+        // Then served from the cache.
+        EXPECT_EQ(take_names(factory.GetUIStyles(family)), listed[name]) << name;
+    }
+
+    // And again in the next session.
+    metadata.save();
+    FontMetadataCache next(shared_path());
+    for (auto const &[name, names] : listed) {
+        EXPECT_EQ(take_names(next.lookupStyles(name)), names) << name;
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for drawing small text from cached glyph masks.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+#include "display/glyph-mask-cache.h"
+#include "object/sp-root.h"
+
+using namespace Inkscape;
+
+namespace {
+
+Geom::IntRect const area(0, 0, 200, 100);
+
+std::string make_text(std::string const &style, std::string const &defs = {})
+{
+    return "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='100'><defs>" + defs + "</defs>"
+           "<text x='10.3' y='40.6' style='font-family:sans-serif;" + style + "'>Hamburgefonstiv 0123</text>"
+           "<text x='12.7' y='80.1' style='font-family:serif;" + style + "'>Quick brown fox, jumps!</text>"
+           "</svg>";
+}
+
+/// Renders a document, with or without drawing its text from glyph masks.
+Cairo::RefPtr<Cairo::ImageSurface> render(std::string const &svg, bool glyph_masks)
+{
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto const root = doc->getRoot();
+    auto const dkey = SPItem::display_key_new(1);
+    Drawing drawing;
+    drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    drawing.setGlyphMasks(glyph_masks);
+    drawing.update();
+
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, area.width(), area.height());
+    {
+        auto ds = DrawingSurface(surface->cobj(), area.min());
+        auto dc = DrawingContext(ds);
+        drawing.render(dc, area);
+    }
+    surface->flush();
+
+    root->invoke_hide(dkey);
+    return surface;
+}
+
+/// Largest difference between the channels of two renderings.
+int max_difference(Cairo::RefPtr<Cairo::ImageSurface> const &a, Cairo::RefPtr<Cairo::ImageSurface> const &b)
+{
+    int result = 0;
+    for (int y = 0; y < a->get_height(); y++) {
+        auto p = a->get_data() + y * a->get_stride();
+        auto q = b->get_data() + y * b->get_stride();
+        for (int x = 0; x < 4 * a->get_width(); x++) {
+            result = std::max(result, std::abs((int)p[x] - (int)q[x]));
+        }
+    }
+    return result;
+}
+
+int covered_pixels(Cairo::RefPtr<Cairo::ImageSurface> const &surface)
+{
+    int result = 0;
+    for (int y = 0; y < surface->get_height(); y++) {
+        auto p = reinterpret_cast<std::uint32_t const *>(surface->get_data() + y * surface->get_stride());
+        for (int x = 0; x < surface->get_width(); x++) {
+            result += (p[x] >> 24) != 0;
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<GlyphMask const> make_mask(int size, std::shared_ptr<void const> const &font_data)
+{
+    auto mask = std::make_shared<GlyphMask>();
+    mask->surface = cairo_image_surface_create(CAIRO_FORMAT_A8, size, size);
+    mask->font_data = font_data;
+    return mask;
+}
+
+GlyphMaskKey make_key(Geom::PathVector const &pathvec)
+{
+    GlyphMaskKey key;
+    key.pathvec = &pathvec;
+    key.coeffs[0] = key.coeffs[3] = 12 * 32;
+    key.coeffs[1] = key.coeffs[2] = 0;
+    key.subpixel[0] = key.subpixel[1] = 0;
+    key.fill_rule = CAIRO_FILL_RULE_WINDING;
+    key.antialias = CAIRO_ANTIALIAS_DEFAULT;
+    return key;
+}
+
+} // namespace
+
+class GlyphMaskCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Application::create(false);
+        GlyphMaskCache::get().clear();
+    }
+
+    void TearDown() override { GlyphMaskCache::get().clear(); }
+};
+
+TEST_F(GlyphMaskCacheTest, MasksMatchOutlines)
+{
+    for (auto size : {"8px", "12px", "30px"}) {
+        auto const svg = make_text(std::string("fill:#204a87;font-size:") + size);
+
+        auto const outlines = render(svg, false);
+        EXPECT_EQ(GlyphMaskCache::get().memory_usage(), 0u) << size;
+        ASSERT_GT(covered_pixels(outlines), 50) << size;
+
+        auto const masks = render(svg, true);
+        EXPECT_GT(GlyphMaskCache::get().memory_usage(), 0u) << size;
+
+        // Positions are rounded to a quarter pixel and scales to 1/32 pixel per em, which only
+        // shows at the edges of the glyphs.
+        EXPECT_LE(max_difference(masks, outlines), 64) << size;
+
+        // Drawn again from the cache.
+        EXPECT_EQ(max_difference(render(svg, true), masks), 0) << size;
+        GlyphMaskCache::get().clear();
+    }
+}
+
+TEST_F(GlyphMaskCacheTest, OtherTextFallsBackToOutlines)
+{
+    std::string const gradient = "<linearGradient id='g'><stop offset='0' stop-color='#f00'/>"
+                                 "<stop offset='1' stop-color='#00f'/></linearGradient>";
+    std::vector<std::pair<std::string, std::string>> const cases = {
+        {"fill:#000;stroke:#f00;stroke-width:0.5;font-size:12px", {}},
+        {"fill:url(#g);font-size:12px", gradient},
+        {"fill:#000;fill-opacity:0.5;font-size:12px", {}},
+        {"fill:#000;font-size:60px", {}},
+    };
+
+    for (auto const &[style, defs] : cases) {
+        auto const svg = make_text(style, defs);
+        auto const masks = render(svg, true);
+        EXPECT_EQ(GlyphMaskCache::get().memory_usage(), 0u) << style;
+        EXPECT_GT(covered_pixels(masks), 50) << style;
+        EXPECT_EQ(max_difference(masks, render(svg, false)), 0) << style;
+    }
+
+    // Whereas the same text filled with a plain colour is drawn from masks.
+    render(make_text("fill:#000;font-size:12px"), true);
+    EXPECT_GT(GlyphMaskCache::get().memory_usage(), 0u);
+}
+
+TEST_F(GlyphMaskCacheTest, EvictsLeastRecentlyUsedMasks)
+{
+    auto &cache = GlyphMaskCache::get();
+    auto const font_data = std::make_shared<int>();
+    std::size_t const mask_bytes = make_mask(256, font_data)->bytes();
+    std::size_t const count = MAX_MASK_BYTES / mask_bytes + 50;
+    std::vector<Geom::PathVector> glyphs(count); // Only their addresses are used.
+
+    for (std::size_t i = 0; i < count; i++) {
+        cache.insert(make_key(glyphs[i]), make_mask(256, font_data));
+        EXPECT_LE(cache.memory_usage(), MAX_MASK_BYTES);
+        // Keep using the first glyph.
+        ASSERT_TRUE(cache.lookup(make_key(glyphs[0])));
+    }
+    EXPECT_EQ(cache.memory_usage(), MAX_MASK_BYTES / mask_bytes * mask_bytes);
+
+    EXPECT_TRUE(cache.lookup(make_key(glyphs[0])));
+    EXPECT_FALSE(cache.lookup(make_key(glyphs[1])));
+    EXPECT_FALSE(cache.lookup(make_key(glyphs[50])));
+    EXPECT_TRUE(cache.lookup(make_key(glyphs[count - 1])));
+
+    // Other transforms are other masks.
+    auto key = make_key(glyphs[count - 1]);
+    key.subpixel[0] = 1;
+    EXPECT_FALSE(cache.lookup(key));
+
+    // Masks of glyphs whose font is gone are dropped.
+    auto other_font = std::make_shared<int>();
+    Geom::PathVector glyph;
+    cache.insert(make_key(glyph), make_mask(16, other_font));
+    auto const usage = cache.memory_usage();
+    other_font.reset();
+    EXPECT_FALSE(cache.lookup(make_key(glyph)));
+    EXPECT_LT(cache.memory_usage(), usage);
+
+    cache.clear();
+    EXPECT_EQ(cache.memory_usage(), 0u);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
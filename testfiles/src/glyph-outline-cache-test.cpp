@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the glyph outlines kept on disk.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
+#include <2geom/bezier-curve.h>
+#include <2geom/path.h>
+
+#include "libnrtype/font-glyph.h"
+#include "libnrtype/glyph-outline-cache.h"
+
+using Inkscape::Text::GlyphOutlineCache;
+
+class GlyphOutlineCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Keep the cache files away from the user's.
+        auto tmp = g_dir_make_tmp("glyph-outline-cache-test-XXXXXX", nullptr);
+        ASSERT_TRUE(tmp);
+        dir = tmp;
+        g_free(tmp);
+        g_setenv("XDG_CACHE_HOME", dir.c_str(), true);
+
+        font_file = Glib::build_filename(dir, "font.ttf");
+        Glib::file_set_contents(font_file, "not really a font");
+
+        GlyphOutlineCache::setEnabled(true);
+
+        glyph.h_advance = 0.6;
+        glyph.h_width = 0.5;
+        glyph.v_advance = 1.0;
+        glyph.v_width = 0.7;
+        glyph.bbox[0] = 0.05;
+        glyph.bbox[1] = -0.1;
+        glyph.bbox[2] = 0.55;
+        glyph.bbox[3] = 0.6;
+
+        Geom::Path outer(Geom::Point(0.05, 0));
+        outer.appendNew<Geom::LineSegment>(Geom::Point(0.55, 0));
+        outer.appendNew<Geom::QuadraticBezier>(Geom::Point(0.55, 0.6), Geom::Point(0.3, 0.6));
+        outer.appendNew<Geom::CubicBezier>(Geom::Point(0.1, 0.6), Geom::Point(0.05, -0.1), Geom::Point(0.05, 0));
+        outer.close();
+        Geom::Path inner(Geom::Point(0.2, 0.1));
+        inner.appendNew<Geom::LineSegment>(Geom::Point(0.4, 0.1));
+        inner.appendNew<Geom::LineSegment>(Geom::Point(0.3, 0.4));
+        inner.close();
+        glyph.pathvector.push_back(outer);
+        glyph.pathvector.push_back(inner);
+    }
+
+    void TearDown() override
+    {
+        GlyphOutlineCache::setEnabled(false);
+
+        auto const outlines = Glib::build_filename(dir, "inkscape", "glyph-outlines");
+        if (Glib::file_test(outlines, Glib::FILE_TEST_IS_DIR)) {
+            for (auto const &name : Glib::Dir(outlines)) {
+                g_unlink(Glib::build_filename(outlines, name).c_str());
+            }
+        }
+        g_rmdir(outlines.c_str());
+        g_rmdir(Glib::build_filename(dir, "inkscape").c_str());
+        g_unlink(font_file.c_str());
+        g_rmdir(dir.c_str());
+    }
+
+    std::string dir;
+    std::string font_file;
+    FontGlyph glyph;
+};
+
+TEST_F(GlyphOutlineCacheTest, GlyphsAreReadBackByLaterOpens)
+{
+    auto cache = GlyphOutlineCache::open(font_file.c_str(), 0, "wght=500");
+    ASSERT_TRUE(cache);
+
+    FontGlyph found;
+    EXPECT_FALSE(cache->lookup(42, found));
+    cache->insert(42, glyph);
+    cache.reset();
+
+    auto reopened = GlyphOutlineCache::open(font_file.c_str(), 0, "wght=500");
+    ASSERT_TRUE(reopened);
+    ASSERT_TRUE(reopened->lookup(42, found));
+    EXPECT_EQ(found.h_advance, glyph.h_advance);
+    EXPECT_EQ(found.h_width, glyph.h_width);
+    EXPECT_EQ(found.v_advance, glyph.v_advance);
+    EXPECT_EQ(found.v_width, glyph.v_width);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(found.bbox[i], glyph.bbox[i]);
+    }
+    EXPECT_EQ(found.pathvector, glyph.pathvector);
+    EXPECT_FALSE(reopened->lookup(43, found));
+
+    // Other coordinates are another file.
+    auto other = GlyphOutlineCache::open(font_file.c_str(), 0, "wght=700");
+    ASSERT_TRUE(other);
+    EXPECT_FALSE(other->lookup(42, found));
+}
+
+TEST_F(GlyphOutlineCacheTest, NothingIsOpenedWhenDisabled)
+{
+    GlyphOutlineCache::setEnabled(false);
+    EXPECT_FALSE(GlyphOutlineCache::open(font_file.c_str(), 0, nullptr));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -13,8 +13,12 @@
 #include <testfiles/lpespaths-test.h>
 #include <src/document.h>
 #include <src/inkscape.h>
+#include <src/display/curve.h>
 #include <src/live_effects/lpe-bool.h>
+#include <src/live_effects/lpe-jointype.h>
+#include <src/live_effects/lpeobject.h>
 #include <src/object/sp-ellipse.h>
+#include <src/object/object-set.h>
 #include <src/object/sp-lpe-item.h>
 
 using namespace Inkscape;
@@ -72,4 +76,274 @@ TEST_F(LPETest, Bool_canBeApplyedToNonSiblingPaths)
     auto operand_path = lpe_bool_op_effect->getParameter("operand-path")->param_getSVGValue();
     auto circle = cast<SPGenericEllipse>(doc->getObjectById(operand_path.substr(1)));
     ASSERT_TRUE(circle != nullptr);
-}
\ No newline at end of file
+
+    // The operand is linked, so the output cannot be memoized.
+    EXPECT_FALSE(lpe_bool_op_effect->isCacheable());
+}
+
+// MEMOIZED OUTPUT
+TEST_F(LPETest, Memoization_followsParameterAndPathChanges)
+{
+    std::string svg("\
+<svg width='100' height='100'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect\
+      id='path-effect1'\
+      effect='offset'\
+      unit='px'\
+      offset='5'\
+      linejoin_type='miter'\
+      lpeversion='1.2' />\
+  </defs>\
+  <path id='path1'\
+    inkscape:path-effect='#path-effect1'\
+    inkscape:original-d='M 20,20 H 80 V 80 H 20 Z'\
+    d='M 20,20 H 80 V 80 H 20 Z' />\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto lpe_item = cast<SPLPEItem>(doc->getObjectById("path1"));
+    ASSERT_TRUE(lpe_item != nullptr);
+    auto effect = lpe_item->getFirstPathEffectOfType(EffectType::OFFSET);
+    ASSERT_TRUE(effect != nullptr);
+    EXPECT_TRUE(effect->isCacheable());
+
+    std::string const initial = lpe_item->getAttribute("d");
+
+    effect->getRepr()->setAttribute("offset", "10");
+    doc->ensureUpToDate();
+    std::string const wider = lpe_item->getAttribute("d");
+    EXPECT_NE(wider, initial);
+
+    effect->getRepr()->setAttribute("offset", "5");
+    doc->ensureUpToDate();
+    EXPECT_EQ(lpe_item->getAttribute("d"), initial);
+
+    lpe_item->setAttribute("inkscape:original-d", "M 30,30 H 70 V 70 H 30 Z");
+    doc->ensureUpToDate();
+    EXPECT_NE(lpe_item->getAttribute("d"), initial);
+}
+
+namespace {
+// Counts how often the output is actually computed.
+class CountingJoinType : public LPEJoinType
+{
+public:
+    using LPEJoinType::LPEJoinType;
+    void doEffect(SPCurve *curve) override
+    {
+        runs++;
+        LPEJoinType::doEffect(curve);
+    }
+    int runs = 0;
+};
+} // namespace
+
+TEST_F(LPETest, Memoization_skipsUnchangedAndFollowsBoundingBox)
+{
+    std::string svg("\
+<svg width='100' height='100'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect id='path-effect1' effect='join_type' line_width='4' lpeversion='1' />\
+    <inkscape:path-effect id='path-effect2' effect='bspline' lpeversion='1' />\
+  </defs>\
+  <path id='path1' style='stroke:#000;stroke-width:1' d='M 20,20 L 80,20 L 80,80' />\
+  <path id='path2'\
+    inkscape:path-effect='#path-effect2'\
+    inkscape:original-d='M 20,20 L 80,20 L 80,80'\
+    d='M 20,20 L 80,20 L 80,80' />\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    // Effects that depend on more than the key covers do not opt in.
+    auto bspline_item = cast<SPLPEItem>(doc->getObjectById("path2"));
+    ASSERT_TRUE(bspline_item != nullptr);
+    auto bspline = bspline_item->getFirstPathEffectOfType(EffectType::BSPLINE);
+    ASSERT_TRUE(bspline != nullptr);
+    EXPECT_FALSE(bspline->isCacheable());
+
+    auto lpeobj = cast<LivePathEffectObject>(doc->getObjectById("path-effect1"));
+    ASSERT_TRUE(lpeobj != nullptr);
+    auto shape = cast<SPShape>(doc->getObjectById("path1"));
+    ASSERT_TRUE(shape != nullptr);
+
+    CountingJoinType effect(lpeobj);
+    ASSERT_TRUE(effect.isCacheable());
+    effect.setCurrentShape(shape);
+
+    Geom::PathVector const input = shape->curve()->get_pathvector();
+    SPCurve first(input);
+    effect.doEffect_memoized(&first);
+    EXPECT_EQ(effect.runs, 1);
+
+    // Same inputs: the previous output is reused without running the effect.
+    SPCurve second(input);
+    effect.doEffect_memoized(&second);
+    EXPECT_EQ(effect.runs, 1);
+    EXPECT_EQ(second.get_pathvector(), first.get_pathvector());
+
+    // A wider stroke grows the visual bounding box but leaves the path alone, which must miss.
+    shape->setAttribute("style", "stroke:#000;stroke-width:10");
+    doc->ensureUpToDate();
+    SPCurve third(input);
+    effect.doEffect_memoized(&third);
+    EXPECT_EQ(effect.runs, 2);
+}
+
+TEST_F(LPETest, Memoization_followsLinkedPattern)
+{
+    std::string svg("\
+<svg width='100' height='100'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect id='path-effect1' effect='skeletal' lpeversion='1.3' pattern='#pattern1'\
+      copytype='single_stretched' prop_scale='1' scale_y_rel='false' spacing='0' normal_offset='0'\
+      tang_offset='0' prop_units='false' vertical_pattern='false' hide_knot='false' fuse_tolerance='0' />\
+    <inkscape:path-effect id='path-effect2' effect='powerstroke' lpeversion='1.3'\
+      offset_points='0.5,4 | 1.5,2' not_jump='false' sort_points='true' interpolator_type='CubicBezierSmooth'\
+      interpolator_beta='0.2' start_linecap_type='zerowidth' linejoin_type='extrp_arc' miter_limit='4'\
+      scale_width='1' end_linecap_type='zerowidth' />\
+  </defs>\
+  <path id='pattern1' d='M 0,0 L 10,0 L 10,2 L 0,2 Z' />\
+  <path id='path1'\
+    inkscape:path-effect='#path-effect1'\
+    inkscape:original-d='M 20,20 L 80,20 L 80,80' />\
+  <path id='path2'\
+    inkscape:path-effect='#path-effect2'\
+    inkscape:original-d='M 20,50 L 50,60 L 80,50' />\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto item = cast<SPLPEItem>(doc->getObjectById("path1"));
+    ASSERT_TRUE(item != nullptr);
+    auto effect = item->getFirstPathEffectOfType(EffectType::PATTERN_ALONG_PATH);
+    ASSERT_TRUE(effect != nullptr);
+    EXPECT_TRUE(effect->isCacheable());
+
+    auto powerstroke_item = cast<SPLPEItem>(doc->getObjectById("path2"));
+    ASSERT_TRUE(powerstroke_item != nullptr);
+    auto powerstroke = powerstroke_item->getFirstPathEffectOfType(EffectType::POWERSTROKE);
+    ASSERT_TRUE(powerstroke != nullptr);
+    EXPECT_TRUE(powerstroke->isCacheable());
+
+    std::string const first = item->getAttribute("d");
+
+    // The pattern is referenced by id, so its changes must reach the key some other way.
+    auto pattern = doc->getObjectById("pattern1");
+    ASSERT_TRUE(pattern != nullptr);
+    pattern->setAttribute("d", "M 0,0 L 10,0 L 10,6 L 0,6 Z");
+    doc->ensureUpToDate();
+    std::string const changed = item->getAttribute("d");
+    EXPECT_NE(changed, first);
+
+    pattern->setAttribute("d", "M 0,0 L 10,0 L 10,2 L 0,2 Z");
+    doc->ensureUpToDate();
+    EXPECT_EQ(item->getAttribute("d"), first);
+}
+
+// CONCURRENT EVALUATION
+TEST_F(LPETest, Concurrent_matchesSerialEvaluation)
+{
+    std::string svg("\
+<svg width='100' height='100'\
+  xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>\
+  <defs>\
+    <inkscape:path-effect id='path-effect1' effect='spiro' lpeversion='1' />\
+    <inkscape:path-effect id='path-effect2' effect='spiro' lpeversion='1' />\
+    <inkscape:path-effect id='path-effect3' effect='spiro' lpeversion='1' />\
+  </defs>\
+  <g id='group1'>\
+    <path id='path1' inkscape:path-effect='#path-effect1' inkscape:original-d='M 10,10 30,40 50,10' />\
+    <path id='path2' inkscape:path-effect='#path-effect2' inkscape:original-d='M 10,50 30,80 50,50 70,80' />\
+    <path id='path3' inkscape:path-effect='#path-effect3' inkscape:original-d='M 60,10 90,20 80,40 Z' />\
+  </g>\
+</svg>");
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+
+    auto group = cast<SPLPEItem>(doc->getObjectById("group1"));
+    ASSERT_TRUE(group != nullptr);
+
+    std::vector<std::string> serial;
+    for (auto id : {"path1", "path2", "path3"}) {
+        auto lpe_item = cast<SPLPEItem>(doc->getObjectById(id));
+        ASSERT_TRUE(lpe_item != nullptr);
+        auto effect = lpe_item->getFirstPathEffectOfType(EffectType::SPIRO);
+        ASSERT_TRUE(effect != nullptr);
+        EXPECT_TRUE(effect->isConcurrencySafe());
+        serial.emplace_back(lpe_item->getAttribute("d"));
+    }
+
+    // Updating the group computes the effects of its children concurrently.
+    sp_lpe_item_update_patheffect(group, false, true);
+    EXPECT_EQ(doc->getObjectById("path1")->getAttribute("d"), serial[0]);
+    EXPECT_EQ(doc->getObjectById("path2")->getAttribute("d"), serial[1]);
+    EXPECT_EQ(doc->getObjectById("path3")->getAttribute("d"), serial[2]);
+}
+
+TEST_F(LPETest, Concurrent_loadAndMoveMatchSerialEvaluation)
+{
+    std::vector<std::string> const originals = {
+        "M 10,10 30,40 50,10",
+        "M 10,50 30,80 50,50 70,80",
+        "M 60,10 90,20 80,40 Z",
+        "M 5,90 15,60 25,95",
+    };
+    auto make_svg = [] (std::vector<std::string> const &paths) {
+        std::string svg = "<svg width='100' height='100' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'><defs>";
+        for (std::size_t i = 0; i < paths.size(); i++) {
+            svg += "<inkscape:path-effect id='path-effect" + std::to_string(i) + "' effect='spiro' lpeversion='1' />";
+        }
+        svg += "</defs>";
+        for (std::size_t i = 0; i < paths.size(); i++) {
+            svg += "<path id='path" + std::to_string(i) + "' inkscape:path-effect='#path-effect" + std::to_string(i) +
+                   "' inkscape:original-d='" + paths[i] + "' />";
+        }
+        return svg + "</svg>";
+    };
+
+    // Each path on its own, so that nothing is computed concurrently.
+    std::vector<std::string> loaded, moved;
+    for (auto const &original : originals) {
+        auto const svg = make_svg({original});
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+        doc->ensureUpToDate();
+        auto item = cast<SPLPEItem>(doc->getObjectById("path0"));
+        ASSERT_TRUE(item != nullptr);
+        loaded.emplace_back(item->getAttribute("d"));
+
+        ObjectSet set(doc.get());
+        set.add(item);
+        set.moveRelative(5, 7);
+        doc->ensureUpToDate();
+        moved.emplace_back(item->getAttribute("d"));
+    }
+
+    // All of them, as on loading a document and nudging everything.
+    auto const svg = make_svg(originals);
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    doc->ensureUpToDate();
+    ObjectSet set(doc.get());
+    for (std::size_t i = 0; i < originals.size(); i++) {
+        auto item = cast<SPLPEItem>(doc->getObjectById("path" + std::to_string(i)));
+        ASSERT_TRUE(item != nullptr);
+        EXPECT_EQ(item->getAttribute("d"), loaded[i]);
+        set.add(item);
+    }
+
+    set.moveRelative(5, 7);
+    doc->ensureUpToDate();
+    for (std::size_t i = 0; i < originals.size(); i++) {
+        EXPECT_EQ(doc->getObjectById("path" + std::to_string(i))->getAttribute("d"), moved[i]);
+    }
+}
+
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for damage propagation through filter primitives.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <2geom/transforms.h>
+
+#include "display/nr-filter-colormatrix.h"
+#include "display/nr-filter-convolve-matrix.h"
+#include "display/nr-filter-gaussian.h"
+#include "display/nr-filter-offset.h"
+
+using namespace Inkscape::Filters;
+
+namespace {
+Geom::IntRect const damage(100, 100, 110, 120);
+} // namespace
+
+TEST(FilterDamageTest, PointwisePrimitivesDoNotSpread)
+{
+    FilterColorMatrix cm;
+    EXPECT_EQ(cm.damage_area(damage, Geom::Scale(2)), damage);
+}
+
+TEST(FilterDamageTest, BlurSpreadsLikeAreaEnlarge)
+{
+    FilterGaussian blur;
+    blur.set_deviation(3.0);
+
+    auto expected = damage;
+    blur.area_enlarge(expected, Geom::identity());
+    EXPECT_EQ(blur.damage_area(damage, Geom::identity()), expected);
+    EXPECT_TRUE(expected.contains(damage));
+    EXPECT_NE(expected, damage);
+}
+
+TEST(FilterDamageTest, OffsetMovesDamage)
+{
+    FilterOffset offset;
+    offset.set_dx(5);
+    offset.set_dy(-3);
+
+    EXPECT_EQ(offset.damage_area(damage, Geom::identity()), Geom::IntRect(105, 97, 115, 117));
+    EXPECT_EQ(offset.damage_area(damage, Geom::Translate(40, 40) * Geom::Scale(2)), Geom::IntRect(110, 94, 120, 114));
+}
+
+TEST(FilterDamageTest, ConvolveDamageMirrorsKernel)
+{
+    FilterConvolveMatrix convolve;
+    convolve.set_orderX(3);
+    convolve.set_orderY(3);
+    convolve.set_targetX(0);
+    convolve.set_targetY(2);
+
+    // Output (x, y) reads inputs (x .. x+2, y-2 .. y), so input (x, y) affects outputs (x-2 .. x, y .. y+2).
+    EXPECT_EQ(convolve.damage_area(damage, Geom::identity()), Geom::IntRect(98, 100, 110, 122));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
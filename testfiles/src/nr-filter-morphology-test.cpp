@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the feMorphology renderer: the van Herk/Gil-Werman passes must give
+ * the same result as the reference deque implementation.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+
+#include "display/nr-filter-morphology.h"
+
+using namespace Inkscape::Filters;
+
+namespace {
+
+cairo_surface_t *random_surface(cairo_format_t format, int w, int h, std::mt19937 &rng)
+{
+    auto s = cairo_image_surface_create(format, w, h);
+    cairo_surface_flush(s);
+    auto data = cairo_image_surface_get_data(s);
+    int stride = cairo_image_surface_get_stride(s);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < stride; ++x) {
+            // Bias towards saturated values so that ties and extremes are exercised.
+            int v = dist(rng);
+            data[y * stride + x] = v < 32 ? 0 : v > 223 ? 255 : v;
+        }
+    }
+    cairo_surface_mark_dirty(s);
+    return s;
+}
+
+bool same_pixels(cairo_surface_t *a, cairo_surface_t *b)
+{
+    int w = cairo_image_surface_get_width(a);
+    int h = cairo_image_surface_get_height(a);
+    int bpp = cairo_image_surface_get_format(a) == CAIRO_FORMAT_A8 ? 1 : 4;
+    int stride = cairo_image_surface_get_stride(a);
+    auto da = cairo_image_surface_get_data(a);
+    auto db = cairo_image_surface_get_data(b);
+    for (int y = 0; y < h; ++y) {
+        if (std::memcmp(da + y * stride, db + y * stride, w * bpp) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(MorphologyTest, VanHerkMatchesDeque)
+{
+    std::mt19937 rng(42);
+    std::pair<int, int> const sizes[] = {{1, 1}, {7, 13}, {64, 33}, {100, 3}};
+
+    for (auto format : {CAIRO_FORMAT_A8, CAIRO_FORMAT_ARGB32}) {
+        for (auto [w, h] : sizes) {
+            auto input = random_surface(format, w, h, rng);
+            auto expected = cairo_image_surface_create(format, w, h);
+            auto actual = cairo_image_surface_create(format, w, h);
+
+            for (auto axis : {Geom::X, Geom::Y}) {
+                for (auto op : {MORPHOLOGY_OPERATOR_ERODE, MORPHOLOGY_OPERATOR_DILATE}) {
+                    for (double radius : {0.0, 1.0, 2.4, 5.0, 31.0, 150.0}) {
+                        morphology_pass(input, expected, radius, axis, op, MorphologyAlgorithm::DEQUE);
+                        morphology_pass(input, actual, radius, axis, op, MorphologyAlgorithm::VAN_HERK);
+                        EXPECT_TRUE(same_pixels(expected, actual))
+                            << "format " << format << ", size " << w << "x" << h << ", axis " << axis
+                            << ", operator " << op << ", radius " << radius;
+                    }
+                }
+            }
+
+            cairo_surface_destroy(actual);
+            cairo_surface_destroy(expected);
+            cairo_surface_destroy(input);
+        }
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -3,6 +3,7 @@
 #include <src/path/path-boolop.h>
 #include <src/svg/svg.h>
 #include <2geom/svg-path-writer.h>
+#include <2geom/transforms.h>
 
 class PathBoolopTest : public ::testing::Test
 {
@@ -83,4 +84,67 @@ TEST_F(PathBoolopTest, DifferenceOutside){
     comparePaths(pvRectangleDifference, pvBothPaths);
 }
 
-//
\ No newline at end of file
+// Signed area enclosed by polygonal paths
+static double polygon_area(Geom::PathVector const &pathv)
+{
+    double area = 0;
+    for (auto const &path : pathv) {
+        for (auto const &curve : path) {
+            area += Geom::cross(curve.initialPoint(), curve.finalPoint());
+        }
+    }
+    return std::abs(area / 2);
+}
+
+TEST_F(PathBoolopTest, NaryUnionMatchesPairwise){
+    // test that the union of many overlapping squares is the same as folding them one by one
+    std::vector<Geom::PathVector> squares;
+    for (int i = 0; i < 25; i++) {
+        double x = (i % 5) * 1.5 + (i % 3) * 0.25;
+        double y = (i / 5) * 1.5 + (i % 2) * 0.5;
+        squares.push_back(Geom::PathVector(Geom::Path(Geom::Rect(x, y, x + 2, y + 2))));
+    }
+
+    Geom::PathVector pairwise = squares.front();
+    for (size_t i = 1; i < squares.size(); i++) {
+        pairwise = sp_pathvector_boolop(pairwise, squares[i], bool_op_union, fill_nonZero, fill_nonZero, true);
+    }
+    Geom::PathVector nary = sp_pathvector_boolop_nary(squares, bool_op_union, fill_nonZero);
+
+    EXPECT_NEAR(polygon_area(nary), polygon_area(pairwise), 1e-3);
+}
+
+TEST_F(PathBoolopTest, NaryIntersection){
+    // test that the intersection of nested squares is the smallest one, and that a disjoint one empties it
+    std::vector<Geom::PathVector> squares;
+    for (int i = 0; i < 7; i++) {
+        squares.push_back(Geom::PathVector(Geom::Path(Geom::Rect(i * 0.1, i * 0.1, 4 - i * 0.1, 4 - i * 0.1))));
+    }
+    Geom::PathVector nary = sp_pathvector_boolop_nary(squares, bool_op_inters, fill_nonZero);
+    EXPECT_NEAR(polygon_area(nary), 2.8 * 2.8, 1e-3);
+
+    squares.push_back(Geom::PathVector(Geom::Path(Geom::Rect(10, 10, 11, 11))));
+    nary = sp_pathvector_boolop_nary(squares, bool_op_inters, fill_nonZero);
+    EXPECT_NEAR(polygon_area(nary), 0, 1e-6);
+}
+
+TEST_F(PathBoolopTest, GeomBackendMatchesLivarot){
+    // test that the curve preserving backend agrees with livarot on the area of the results
+    for (auto bop : {bool_op_union, bool_op_inters, bool_op_diff, bool_op_symdiff}) {
+        auto result = sp_pathvector_boolop_2geom(pvRectangleBigger, pvRectangleOutside, bop, fill_nonZero, fill_nonZero);
+        ASSERT_TRUE(result);
+        auto expected = sp_pathvector_boolop(pvRectangleBigger, pvRectangleOutside, bop, fill_nonZero, fill_nonZero, true);
+        EXPECT_NEAR(polygon_area(*result), polygon_area(expected), 1e-6);
+    }
+}
+
+TEST_F(PathBoolopTest, GeomBackendKeepsCurves){
+    // test that the union of two circles is made of the arcs of the circles, not of refitted curves
+    Geom::PathVector a = sp_svg_read_pathv("M 0,1 C 0,0.45 0.45,0 1,0 C 1.55,0 2,0.45 2,1 C 2,1.55 1.55,2 1,2 C 0.45,2 0,1.55 0,1 z");
+    Geom::PathVector b = a * Geom::Translate(1, 0);
+    auto result = sp_pathvector_boolop_2geom(a, b, bool_op_union, fill_nonZero, fill_nonZero);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->size(), 1);
+    // Each circle keeps its two outer quarters, and the outer parts of the two quarters crossing the other one.
+    EXPECT_EQ(result->front().size_default(), 8);
+}
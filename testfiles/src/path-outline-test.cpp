@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for stroke to path on many items at once.
+ *//*
+ *
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <doc-per-case-test.h>
+#include <gtest/gtest.h>
+#include <src/object/sp-item.h>
+#include <src/path/path-outline.h>
+#include <src/xml/node.h>
+
+#include <string>
+#include <vector>
+
+using namespace Inkscape;
+
+namespace {
+
+/// Stroked paths, many of them turning back on themselves, where outlining depends on the order
+/// the joins are visited in.
+std::string make_document(int count)
+{
+    static char const *const paths[] = {
+        "M 10,10 L 60,10 L 10,10",
+        "M 0,50 H 50 V 80 H 0 Z",
+        "M 0,100 C 20,80 40,120 60,100 L 0,100",
+        "M 0,0 L 30,30 L 0,0 L 30,0",
+        "M 5,5 Q 40,0 20,20 T 5,5",
+    };
+    static char const *const joins[] = {"round", "miter", "bevel"};
+
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>";
+    for (int i = 0; i < count; i++) {
+        svg += "<path id='p" + std::to_string(i) + "' transform='translate(" + std::to_string(i % 10 * 80) + ","
+             + std::to_string(i / 10 * 130) + ")' d='" + paths[i % 5] + "' style='fill:none;stroke:#000;stroke-width:"
+             + std::to_string(1 + i % 6) + ";stroke-linejoin:" + joins[i % 3] + "'/>";
+    }
+    svg += "</svg>";
+    return svg;
+}
+
+void collect_path_data(XML::Node const *node, std::vector<std::string> &data)
+{
+    if (auto d = node->attribute("d")) {
+        data.emplace_back(d);
+    }
+    for (auto child = node->firstChild(); child; child = child->next()) {
+        collect_path_data(child, data);
+    }
+}
+
+} // namespace
+
+class PathOutlineTest : public DocPerCaseTest
+{
+};
+
+TEST_F(PathOutlineTest, ConcurrentStrokeToPathMatchesSerial)
+{
+    int const count = 60;
+    auto const svg = make_document(count);
+
+    auto serial = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+    auto concurrent = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+    ASSERT_TRUE(serial);
+    ASSERT_TRUE(concurrent);
+    serial->ensureUpToDate();
+    concurrent->ensureUpToDate();
+
+    std::vector<SPItem *> items;
+    for (int i = 0; i < count; i++) {
+        auto const id = "p" + std::to_string(i);
+        auto item = cast<SPItem>(serial->getObjectById(id));
+        ASSERT_TRUE(item);
+        item_to_paths(item);
+
+        items.push_back(cast<SPItem>(concurrent->getObjectById(id)));
+        ASSERT_TRUE(items.back());
+    }
+    items_to_paths(items);
+
+    std::vector<std::string> serial_data, concurrent_data;
+    collect_path_data(serial->getReprRoot(), serial_data);
+    collect_path_data(concurrent->getReprRoot(), concurrent_data);
+    ASSERT_EQ(serial_data.size(), concurrent_data.size());
+    for (std::size_t i = 0; i < serial_data.size(); i++) {
+        EXPECT_EQ(serial_data[i], concurrent_data[i]) << "path " << i;
+    }
+
+    // The same again, so that the result does not depend on earlier outlines either.
+    auto again = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+    ASSERT_TRUE(again);
+    again->ensureUpToDate();
+    std::vector<SPItem *> again_items;
+    for (int i = 0; i < count; i++) {
+        again_items.push_back(cast<SPItem>(again->getObjectById("p" + std::to_string(i))));
+    }
+    items_to_paths(again_items);
+    std::vector<std::string> again_data;
+    collect_path_data(again->getReprRoot(), again_data);
+    EXPECT_EQ(again_data, concurrent_data);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
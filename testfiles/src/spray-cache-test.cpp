@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the colour sampling of the spray tool's per-stroke cache.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "document.h"
+#include "inkscape.h"
+#include "display/drawing.h"
+#include "object/sp-item.h"
+#include "object/sp-root.h"
+#include "ui/tools/spray-cache.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+using namespace Inkscape;
+using Inkscape::UI::Tools::SprayStrokeCache;
+
+namespace {
+
+struct Color
+{
+    double r, g, b, a;
+};
+
+/// Add a square to the document, as the spray tool does for each copy.
+void spray(SPDocument *doc, double x, double y, char const *fill)
+{
+    auto repr = doc->getReprDoc()->createElement("svg:rect");
+    repr->setAttributeSvgDouble("x", x);
+    repr->setAttributeSvgDouble("y", y);
+    repr->setAttribute("width", "10");
+    repr->setAttribute("height", "10");
+    repr->setAttribute("style", std::string("fill:") + fill);
+    doc->getReprRoot()->appendChild(repr);
+    Inkscape::GC::release(repr);
+    doc->ensureUpToDate();
+}
+
+class SprayCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Application::create(false);
+        std::string const svg = "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>"
+                                "<rect x='0' y='0' width='100' height='100' style='fill:#ffffff'/></svg>";
+        doc.reset(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), false));
+        ASSERT_TRUE(doc);
+        doc->ensureUpToDate();
+
+        dkey = SPItem::display_key_new(1);
+        drawing = std::make_unique<Drawing>();
+        drawing->setRoot(doc->getRoot()->invoke_show(*drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing->update();
+    }
+
+    void TearDown() override
+    {
+        cache.reset();
+        if (doc) {
+            doc->getRoot()->invoke_hide(dkey);
+        }
+        drawing.reset();
+    }
+
+    Color sample(Geom::IntRect const &area)
+    {
+        Color c;
+        cache.averageColor(*drawing, Geom::identity(), area, c.r, c.g, c.b, c.a);
+        return c;
+    }
+
+    std::unique_ptr<SPDocument> doc;
+    unsigned dkey = 0;
+    std::unique_ptr<Drawing> drawing;
+    SprayStrokeCache cache;
+};
+
+} // namespace
+
+TEST_F(SprayCacheTest, SprayedItemShowsInSampledArea)
+{
+    cache.setNeighbourhood(40);
+    Geom::IntRect const area(42, 42, 48, 48);
+
+    auto const before = sample(area);
+    EXPECT_NEAR(before.r, 1, 1e-3);
+    EXPECT_NEAR(before.g, 1, 1e-3);
+    EXPECT_NEAR(before.b, 1, 1e-3);
+
+    // The document creates the drawing item, but nothing updates the drawing in between.
+    spray(doc.get(), 40, 40, "#ff0000");
+    auto const red = sample(area);
+    EXPECT_NEAR(red.r, 1, 1e-3);
+    EXPECT_NEAR(red.g, 0, 1e-3);
+    EXPECT_NEAR(red.b, 0, 1e-3);
+    EXPECT_NEAR(red.a, 1, 1e-3);
+
+    // Later changes to the same, already re-rendered area are still picked up.
+    spray(doc.get(), 40, 40, "#0000ff");
+    auto const blue = sample(area);
+    EXPECT_NEAR(blue.r, 0, 1e-3);
+    EXPECT_NEAR(blue.b, 1, 1e-3);
+}
+
+TEST_F(SprayCacheTest, MatchesRenderingFromScratch)
+{
+    cache.setNeighbourhood(40);
+    sample(Geom::IntRect(30, 30, 40, 40));
+
+    spray(doc.get(), 25, 25, "#00ff00");
+    spray(doc.get(), 33, 28, "#ff00ff");
+
+    Geom::IntRect const area(28, 28, 38, 38);
+    auto const cached = sample(area);
+    Color fresh;
+    drawing->averageColor(area, fresh.r, fresh.g, fresh.b, fresh.a);
+    EXPECT_NEAR(cached.r, fresh.r, 1e-3);
+    EXPECT_NEAR(cached.g, fresh.g, 1e-3);
+    EXPECT_NEAR(cached.b, fresh.b, 1e-3);
+    EXPECT_NEAR(cached.a, fresh.a, 1e-3);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the pooled allocator of intermediate render surfaces.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "display/surface-pool.h"
+
+using namespace Inkscape;
+
+TEST(SurfacePoolTest, RecyclesBuffers)
+{
+    SurfacePool pool;
+
+    auto a = pool.create(CAIRO_FORMAT_ARGB32, 256, 256);
+    ASSERT_EQ(cairo_surface_status(a), CAIRO_STATUS_SUCCESS);
+    auto data = cairo_image_surface_get_data(a);
+    cairo_surface_destroy(a);
+
+    EXPECT_EQ(pool.stats().misses, 1u);
+    EXPECT_GT(pool.stats().idle_bytes, 0u);
+
+    // A slightly smaller surface of the same format fits in the same size class.
+    auto b = pool.create(CAIRO_FORMAT_ARGB32, 250, 256);
+    EXPECT_EQ(cairo_image_surface_get_data(b), data);
+    EXPECT_EQ(pool.stats().hits, 1u);
+    EXPECT_EQ(pool.stats().idle_bytes, 0u);
+
+    // Different formats do not share buffers.
+    auto c = pool.create(CAIRO_FORMAT_A8, 1024, 256);
+    EXPECT_EQ(pool.stats().misses, 2u);
+
+    cairo_surface_destroy(b);
+    cairo_surface_destroy(c);
+}
+
+TEST(SurfacePoolTest, RecycledSurfacesAreCleared)
+{
+    SurfacePool pool;
+
+    auto a = pool.create(CAIRO_FORMAT_ARGB32, 200, 100);
+    cairo_surface_flush(a);
+    std::memset(cairo_image_surface_get_data(a), 0xff, cairo_image_surface_get_stride(a) * 100);
+    cairo_surface_destroy(a);
+
+    auto b = pool.create(CAIRO_FORMAT_ARGB32, 200, 100);
+    ASSERT_EQ(pool.stats().hits, 1u);
+    auto data = cairo_image_surface_get_data(b);
+    int const size = cairo_image_surface_get_stride(b) * 100;
+    for (int i = 0; i < size; i++) {
+        ASSERT_EQ(data[i], 0);
+    }
+    cairo_surface_destroy(b);
+}
+
+TEST(SurfacePoolTest, SimilarKeepsDeviceScale)
+{
+    SurfacePool pool;
+
+    auto base = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 4, 4);
+    cairo_surface_set_device_scale(base, 2, 2);
+
+    auto s = pool.create_similar(base, CAIRO_CONTENT_ALPHA, 100, 80);
+    EXPECT_EQ(cairo_image_surface_get_format(s), CAIRO_FORMAT_A8);
+    EXPECT_EQ(cairo_image_surface_get_width(s), 200);
+    EXPECT_EQ(cairo_image_surface_get_height(s), 160);
+    double sx = 0, sy = 0;
+    cairo_surface_get_device_scale(s, &sx, &sy);
+    EXPECT_EQ(sx, 2);
+    EXPECT_EQ(sy, 2);
+
+    cairo_surface_destroy(s);
+    cairo_surface_destroy(base);
+}
+
+TEST(SurfacePoolTest, RespectsBudget)
+{
+    SurfacePool pool(1 << 20);
+
+    std::vector<cairo_surface_t *> surfaces;
+    for (int i = 0; i < 8; i++) {
+        surfaces.push_back(pool.create(CAIRO_FORMAT_ARGB32, 256, 256)); // 256 KiB each
+    }
+    for (auto s : surfaces) {
+        cairo_surface_destroy(s);
+    }
+
+    EXPECT_LE(pool.stats().idle_bytes, pool.budget());
+    EXPECT_EQ(pool.stats().discards, 4u);
+
+    pool.set_budget(0);
+    EXPECT_EQ(pool.stats().idle_bytes, 0u);
+}
+
+TEST(SurfacePoolTest, ReleaseFromOtherThreads)
+{
+    SurfacePool pool;
+
+    for (int round = 0; round < 4; round++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            auto s = pool.create(CAIRO_FORMAT_ARGB32, 128 + t, 128);
+            threads.emplace_back([s] { cairo_surface_destroy(s); });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 16u);
+    EXPECT_GT(stats.hits, 0u);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the concurrent layout of texts during the first update of a document.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-text.h"
+
+using namespace Inkscape;
+
+TEST(TextParallelLayoutTest, FirstUpdateMatchesSequentialLayout)
+{
+    Application::create(false);
+
+    // Enough texts to be spread over several threads, in a few styles and directions.
+    static char const *const styles[] = {
+        "font-family:sans-serif;font-size:12px",
+        "font-family:serif;font-size:9px;font-weight:bold",
+        "font-family:sans-serif;font-size:14px;direction:rtl",
+        "font-family:monospace;font-size:10px;writing-mode:vertical-rl",
+    };
+    static char const *const strings[] = {
+        "Label", "Another label", "\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d", "office affine", "Label",
+    };
+
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>";
+    int const count = 200;
+    for (int i = 0; i < count; i++) {
+        svg += "<text id='t" + std::to_string(i) + "' x='" + std::to_string(i % 20 * 50) + "' y='"
+             + std::to_string(i / 20 * 50) + "' style='" + styles[i % 4] + "'>" + strings[i % 5]
+             + "<tspan x='" + std::to_string(i % 20 * 50) + "' dy='12'>" + std::to_string(i) + "</tspan></text>";
+    }
+    svg += "</svg>";
+
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    ASSERT_TRUE(doc);
+    doc->ensureUpToDate();
+
+    std::vector<SPText *> texts;
+    std::vector<Glib::ustring> concurrent;
+    for (int i = 0; i < count; i++) {
+        auto text = cast<SPText>(doc->getObjectById("t" + std::to_string(i)));
+        ASSERT_TRUE(text);
+        texts.push_back(text);
+        concurrent.push_back(text->layout.dumpAsText());
+    }
+
+    for (int i = 0; i < count; i++) {
+        texts[i]->rebuildLayout();
+        EXPECT_EQ(texts[i]->layout.dumpAsText(), concurrent[i]) << "text " << i;
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for laying out flowed text again after editing one of its paragraphs.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-flowtext.h"
+#include "object/sp-text.h"
+#include "xml/node.h"
+
+using namespace Inkscape;
+
+namespace {
+
+std::vector<std::string> make_paragraphs()
+{
+    std::vector<std::string> paragraphs;
+    for (int i = 0; i < 30; i++) {
+        std::string text = "Paragraph " + std::to_string(i) + ":";
+        for (int j = 0; j <= i % 4; j++) {
+            text += " some words that need to be wrapped at the edge of the frame";
+        }
+        paragraphs.push_back(text);
+    }
+    return paragraphs;
+}
+
+std::string make_flowroot(std::vector<std::string> const &paragraphs)
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>"
+                      "<flowRoot id='flow' style='font-family:sans-serif;font-size:12px;line-height:1.25'>"
+                      "<flowRegion><path d='M 10,10 H 250 V 400 H 10 Z M 300,10 H 450 L 600,400 H 300 Z'/></flowRegion>";
+    for (std::size_t i = 0; i < paragraphs.size(); i++) {
+        svg += "<flowPara id='p" + std::to_string(i) + "'" + (i % 7 == 3 ? " style='font-size:16px'" : "") + ">"
+             + paragraphs[i] + "</flowPara>";
+    }
+    svg += "</flowRoot></svg>";
+    return svg;
+}
+
+std::string make_shape_inside(std::vector<std::string> const &paragraphs)
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>"
+                      "<rect id='frame' x='10' y='10' width='200' height='2000'/>"
+                      "<text id='flow' xml:space='preserve' "
+                      "style='font-family:sans-serif;font-size:12px;shape-inside:url(#frame);white-space:pre'>";
+    for (std::size_t i = 0; i < paragraphs.size(); i++) {
+        svg += std::string(i ? "\n" : "") + "<tspan id='p" + std::to_string(i) + "'>" + paragraphs[i] + "</tspan>";
+    }
+    svg += "</text></svg>";
+    return svg;
+}
+
+// The spacing added to meet the text length depends on the whole text, and is applied to every
+// paragraph on a second pass.
+std::string make_shape_inside_with_length(std::vector<std::string> const &paragraphs)
+{
+    auto svg = make_shape_inside(paragraphs);
+    // Somewhat longer than the text, so that letters get further apart and the lines wrap sooner.
+    svg.replace(svg.find("height='2000'"), 13, "height='4000'");
+    svg.replace(svg.find("<text id='flow'"), 15, "<text id='flow' textLength='36000'");
+    return svg;
+}
+
+template <typename T>
+Glib::ustring layout_of(SPDocument *doc)
+{
+    auto flow = cast<T>(doc->getObjectById("flow"));
+    return flow ? flow->layout.dumpAsText() : Glib::ustring();
+}
+
+/// Edit paragraphs of a text in place one after the other, and compare each time with the same
+/// text laid out from scratch.
+template <typename T>
+void check_edits(std::string (*make_svg)(std::vector<std::string> const &))
+{
+    auto paragraphs = make_paragraphs();
+    auto const svg = make_svg(paragraphs);
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+    ASSERT_TRUE(doc);
+    doc->ensureUpToDate();
+    ASSERT_FALSE(layout_of<T>(doc.get()).empty());
+
+    struct Edit
+    {
+        std::size_t paragraph;
+        std::string text;
+    };
+    std::vector<Edit> const edits = {
+        {15, paragraphs[15] + " and a few more words for another line or two"},
+        {15, paragraphs[15]},
+        {16, "Short"},
+        {0, paragraphs[0] + "!"},
+        {29, paragraphs[29] + "!"},
+        {10, paragraphs[10] + paragraphs[11] + paragraphs[12]},
+    };
+
+    for (auto const &edit : edits) {
+        paragraphs[edit.paragraph] = edit.text;
+        auto para = doc->getObjectById("p" + std::to_string(edit.paragraph));
+        ASSERT_TRUE(para);
+        auto child = para->getRepr()->firstChild();
+        ASSERT_TRUE(child);
+        child->setContent(edit.text.c_str());
+        doc->ensureUpToDate();
+
+        auto const fresh_svg = make_svg(paragraphs);
+        auto fresh = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(fresh_svg.c_str(), fresh_svg.size(), true));
+        ASSERT_TRUE(fresh);
+        fresh->ensureUpToDate();
+        EXPECT_EQ(layout_of<T>(doc.get()), layout_of<T>(fresh.get())) << "after editing paragraph " << edit.paragraph;
+    }
+}
+
+} // namespace
+
+TEST(TextReflowTest, EditedFlowRootMatchesFreshLayout)
+{
+    Application::create(false);
+    check_edits<SPFlowtext>(make_flowroot);
+}
+
+TEST(TextReflowTest, EditedShapeInsideMatchesFreshLayout)
+{
+    Application::create(false);
+    check_edits<SPText>(make_shape_inside);
+}
+
+TEST(TextReflowTest, EditedTextWithLengthMatchesFreshLayout)
+{
+    Application::create(false);
+    check_edits<SPText>(make_shape_inside_with_length);
+}
+
+TEST(TextReflowTest, TextLengthSpacesOutTheFirstParagraphToo)
+{
+    Application::create(false);
+    auto const paragraphs = make_paragraphs();
+
+    auto const anchor_x = [] (std::string const &svg) {
+        auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+        doc->ensureUpToDate();
+        auto const &layout = cast<SPText>(doc->getObjectById("flow"))->layout;
+        return layout.characterAnchorPoint(layout.charIndexToIterator(10))[Geom::X];
+    };
+    EXPECT_NE(anchor_x(make_shape_inside_with_length(paragraphs)), anchor_x(make_shape_inside(paragraphs)));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the cache of shaped runs used by the text layout.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "document.h"
+#include "inkscape.h"
+#include "libnrtype/shaping-cache.h"
+#include "object/sp-text.h"
+
+using namespace Inkscape;
+
+class TextShapingCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Application::create(false);
+
+        std::string const svg("\
+<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'>\
+  <text id='text1' x='10' y='20' style='font-family:sans-serif;font-size:12px'>Hello <tspan dx='3'>world</tspan></text>\
+  <text id='text2' x='10' y='50' style='font-family:sans-serif;font-size:12px;fill:red'>Hello <tspan dx='3'>world</tspan></text>\
+  <text id='text3' x='10' y='80' style='font-family:sans-serif;font-size:12px;direction:rtl'>\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d \xd7\xa2\xd7\x95\xd7\x9c\xd7\x9d abc</text>\
+  <text id='text4' x='10' y='110' style='font-family:serif;font-size:12px;font-feature-settings:\"liga\" 0'>office affine</text>\
+</svg>");
+        doc.reset(SPDocument::createNewDocFromMem(svg.c_str(), svg.size(), true));
+        ASSERT_TRUE(doc);
+        doc->ensureUpToDate();
+    }
+
+    SPText *text(char const *id) { return cast<SPText>(doc->getObjectById(id)); }
+
+    std::unique_ptr<SPDocument> doc;
+};
+
+TEST_F(TextShapingCacheTest, LayoutIsTheSameWithAndWithoutCache)
+{
+    for (auto id : {"text1", "text2", "text3", "text4"}) {
+        auto t = text(id);
+        ASSERT_TRUE(t);
+
+        Text::ShapingCache::get().clear();
+        t->rebuildLayout();
+        auto const uncached = t->layout.dumpAsText();
+
+        // Relayout from the runs just shaped.
+        t->rebuildLayout();
+        EXPECT_EQ(t->layout.dumpAsText(), uncached) << id;
+    }
+}
+
+TEST_F(TextShapingCacheTest, TextsDifferingInFillShareRuns)
+{
+    Text::ShapingCache::get().clear();
+    text("text2")->rebuildLayout();
+    auto const uncached = text("text2")->layout.dumpAsText();
+
+    Text::ShapingCache::get().clear();
+    text("text1")->rebuildLayout();
+    text("text2")->rebuildLayout();
+    EXPECT_EQ(text("text2")->layout.dumpAsText(), uncached);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Tests for the canvas content kept for recently visited zoom levels.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <cairomm/context.h>
+#include <2geom/transforms.h>
+
+#include "ui/widget/canvas/graphics.h"
+#include "ui/widget/canvas/tilecache.h"
+
+using namespace Inkscape::UI::Widget;
+
+namespace {
+
+constexpr int CELL = 256;
+constexpr std::size_t CELL_BYTES = 4 * CELL * CELL;
+
+constexpr std::uint32_t RED = 0xffff0000;
+constexpr std::uint32_t BLUE = 0xff0000ff;
+
+/// Keeps the tiles pasted by TileCache::restore() instead of drawing them.
+class RecordingGraphics : public Graphics
+{
+public:
+    void set_scale_factor(int) override {}
+    void set_outlines_enabled(bool) override {}
+    void set_background_in_stores(bool) override {}
+    void set_colours(uint32_t, uint32_t, uint32_t) override {}
+    void recreate_store(Geom::IntPoint const &) override {}
+    void shift_store(Fragment const &) override {}
+    void swap_stores() override {}
+    void fast_snapshot_combine() override {}
+    void snapshot_combine(Fragment const &) override {}
+    void invalidate_snapshot() override {}
+    bool is_opengl() const override { return false; }
+    void invalidated_glstate() override {}
+    void junk_tile_surface(Cairo::RefPtr<Cairo::ImageSurface>) override {}
+    void paint_widget(Fragment const &, PaintArgs const &, Cairo::RefPtr<Cairo::Context> const &) override {}
+
+    Cairo::RefPtr<Cairo::ImageSurface> request_tile_surface(Geom::IntRect const &rect, bool) override
+    {
+        return Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, rect.width(), rect.height());
+    }
+
+    void draw_tile(Fragment const &fragment, Cairo::RefPtr<Cairo::ImageSurface> surface,
+                   Cairo::RefPtr<Cairo::ImageSurface>) override
+    {
+        tiles.emplace_back(fragment, std::move(surface));
+    }
+
+    /// The pixel pasted at a point, or zero if none was.
+    std::uint32_t pixel(int x, int y) const
+    {
+        for (auto const &[fragment, surface] : tiles) {
+            auto const &r = fragment.rect;
+            if (x >= r.left() && x < r.right() && y >= r.top() && y < r.bottom()) {
+                surface->flush();
+                auto const row = surface->get_data() + (y - r.top()) * surface->get_stride();
+                return reinterpret_cast<std::uint32_t const *>(row)[x - r.left()];
+            }
+        }
+        return 0;
+    }
+
+    std::vector<std::pair<Fragment, Cairo::RefPtr<Cairo::ImageSurface>>> tiles;
+};
+
+Cairo::RefPtr<Cairo::ImageSurface> filled(Geom::IntRect const &rect, std::uint32_t colour)
+{
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, rect.width(), rect.height());
+    auto cr = Cairo::Context::create(surface);
+    cr->set_source_rgba(((colour >> 16) & 0xff) / 255.0, ((colour >> 8) & 0xff) / 255.0, (colour & 0xff) / 255.0,
+                        (colour >> 24) / 255.0);
+    cr->paint();
+    return surface;
+}
+
+void insert(TileCache &cache, Geom::Affine const &affine, Geom::IntRect const &rect, std::uint32_t colour)
+{
+    cache.insert(Fragment{affine, rect}, filled(rect, colour));
+}
+
+Geom::IntRect const everywhere(-4 * CELL, -4 * CELL, 4 * CELL, 4 * CELL);
+
+} // namespace
+
+TEST(TileCacheTest, RestoresUnchangedContent)
+{
+    TileCache cache;
+    cache.set_budget(16 * CELL_BYTES);
+
+    auto const rect = Geom::IntRect(-100, 50, 300, 200);
+    insert(cache, Geom::identity(), rect, RED);
+    EXPECT_EQ(cache.memory_usage(), 3 * CELL_BYTES);
+
+    RecordingGraphics graphics;
+    auto const store = Geom::IntRect(0, 0, 500, 500);
+    auto const restored = cache.restore(Fragment{Geom::identity(), store}, graphics);
+    EXPECT_EQ(restored->get_extents().x, 0);
+    EXPECT_EQ(restored->get_extents().y, 50);
+    EXPECT_EQ(restored->get_extents().width, 300);
+    EXPECT_EQ(restored->get_extents().height, 150);
+    EXPECT_EQ(graphics.pixel(0, 50), RED);
+    EXPECT_EQ(graphics.pixel(299, 199), RED);
+    EXPECT_EQ(graphics.pixel(300, 100), 0u);
+
+    // Later content replaces earlier content.
+    insert(cache, Geom::identity(), Geom::IntRect(200, 100, 250, 150), BLUE);
+    RecordingGraphics again;
+    cache.restore(Fragment{Geom::identity(), store}, again);
+    EXPECT_EQ(again.pixel(225, 125), BLUE);
+    EXPECT_EQ(again.pixel(100, 100), RED);
+
+    // Nothing was rendered at other zoom levels.
+    RecordingGraphics other;
+    EXPECT_TRUE(cache.restore(Fragment{Geom::Scale(2), store}, other)->empty());
+    EXPECT_TRUE(other.tiles.empty());
+}
+
+TEST(TileCacheTest, InvalidationDropsTouchedContent)
+{
+    TileCache cache;
+    cache.set_budget(16 * CELL_BYTES);
+    insert(cache, Geom::identity(), Geom::IntRect(0, 0, 2 * CELL, CELL), RED);
+    insert(cache, Geom::Scale(2), Geom::IntRect(0, 0, 2 * CELL, CELL), BLUE);
+
+    // At the same zoom level, exactly the damaged rectangle goes.
+    cache.invalidate(Geom::IntRect(10, 10, 20, 20), Geom::identity());
+    RecordingGraphics graphics;
+    auto restored = cache.restore(Fragment{Geom::identity(), everywhere}, graphics);
+    EXPECT_FALSE(restored->contains_point(10, 10));
+    EXPECT_FALSE(restored->contains_point(19, 19));
+    EXPECT_TRUE(restored->contains_point(9, 10));
+    EXPECT_TRUE(restored->contains_point(20, 19));
+    EXPECT_TRUE(restored->contains_point(2 * CELL - 1, 0));
+    EXPECT_EQ(graphics.pixel(20, 20), RED);
+
+    // At other zoom levels, the damage is mapped there with a margin for fixed size items.
+    RecordingGraphics zoomed;
+    restored = cache.restore(Fragment{Geom::Scale(2), everywhere}, zoomed);
+    EXPECT_FALSE(restored->contains_point(20, 20));
+    EXPECT_FALSE(restored->contains_point(39, 39));
+    EXPECT_TRUE(restored->contains_point(2 * CELL - 1, CELL - 1));
+    EXPECT_EQ(zoomed.pixel(2 * CELL - 1, CELL - 1), BLUE);
+
+    // Cells left without any valid content are freed.
+    cache.invalidate(Geom::IntRect(CELL, 0, 2 * CELL, CELL), Geom::identity());
+    EXPECT_EQ(cache.memory_usage(), 3 * CELL_BYTES);
+    RecordingGraphics after;
+    EXPECT_FALSE(cache.restore(Fragment{Geom::identity(), everywhere}, after)->contains_point(CELL, 0));
+}
+
+TEST(TileCacheTest, ContentDamagedWhileRenderingIsNotKept)
+{
+    TileCache cache;
+    cache.set_budget(16 * CELL_BYTES);
+
+    // The tile was rendered before the change reached the drawing.
+    cache.begin_redraw();
+    cache.invalidate(Geom::IntRect(50, 50, 60, 60), Geom::identity());
+    insert(cache, Geom::identity(), Geom::IntRect(0, 0, 100, 100), RED);
+
+    RecordingGraphics graphics;
+    auto restored = cache.restore(Fragment{Geom::identity(), everywhere}, graphics);
+    EXPECT_FALSE(restored->contains_point(55, 55));
+    EXPECT_TRUE(restored->contains_point(45, 45));
+
+    // A redraw started after the change renders it.
+    cache.begin_redraw();
+    insert(cache, Geom::identity(), Geom::IntRect(0, 0, 100, 100), BLUE);
+    RecordingGraphics redrawn;
+    restored = cache.restore(Fragment{Geom::identity(), everywhere}, redrawn);
+    EXPECT_TRUE(restored->contains_point(55, 55));
+    EXPECT_EQ(redrawn.pixel(55, 55), BLUE);
+}
+
+TEST(TileCacheTest, EvictsLeastRecentlyUsedLevelsAtBudget)
+{
+    TileCache cache;
+    cache.set_budget(2 * CELL_BYTES);
+
+    auto const rect = Geom::IntRect(0, 0, CELL, CELL);
+    insert(cache, Geom::identity(), rect, RED);
+    insert(cache, Geom::Scale(2), rect, RED);
+    EXPECT_EQ(cache.memory_usage(), 2 * CELL_BYTES);
+
+    // Returning to the first level makes the second the least recently used.
+    RecordingGraphics graphics;
+    EXPECT_FALSE(cache.restore(Fragment{Geom::identity(), rect}, graphics)->empty());
+    insert(cache, Geom::Scale(4), rect, BLUE);
+    EXPECT_EQ(cache.memory_usage(), 2 * CELL_BYTES);
+
+    RecordingGraphics first, second, third;
+    EXPECT_FALSE(cache.restore(Fragment{Geom::identity(), rect}, first)->empty());
+    EXPECT_TRUE(cache.restore(Fragment{Geom::Scale(2), rect}, second)->empty());
+    EXPECT_FALSE(cache.restore(Fragment{Geom::Scale(4), rect}, third)->empty());
+
+    // A level larger than the budget keeps what fits.
+    insert(cache, Geom::Scale(8), Geom::IntRect(0, 0, 3 * CELL, CELL), RED);
+    EXPECT_EQ(cache.memory_usage(), 2 * CELL_BYTES);
+
+    // Shrinking the budget evicts right away, and no budget disables the cache.
+    cache.set_budget(CELL_BYTES);
+    EXPECT_EQ(cache.memory_usage(), CELL_BYTES);
+    cache.set_budget(0);
+    EXPECT_EQ(cache.memory_usage(), 0u);
+    insert(cache, Geom::identity(), rect, RED);
+    EXPECT_EQ(cache.memory_usage(), 0u);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :